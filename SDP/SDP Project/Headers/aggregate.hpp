@@ -0,0 +1,62 @@
+#ifndef AGGREGATE_HPP
+#define AGGREGATE_HPP
+
+#include <sstream>
+#include <string>
+
+#include "field.hpp"
+
+//! Enum of all aggregate functions
+enum class AggregateType {
+    UNDEFINED = 0,
+    COUNT = 1,
+    SUM = 2,
+    MIN = 3,
+    MAX = 4,
+    AVG = 5,
+    COUNTAGGREGATETYPE
+};
+
+//! List of all aggregate function names
+const char AggregateTypeList[(int)(AggregateType::COUNTAGGREGATETYPE)][10] = {
+    "UNDEFINED",
+    "COUNT",
+    "SUM",
+    "MIN",
+    "MAX",
+    "AVG"};
+
+//! Parse an aggregate expression like SUM(column) into its function and column
+bool parseAggregate(const std::string& expression, AggregateType& aggregateType, std::string& columnName);
+
+//! A single output column of an aggregate query
+struct AggregateColumn {
+    AggregateType aggregateType;  //!< Aggregate function, UNDEFINED for a GROUPBY column
+    int columnIndex;              //!< Index of the aggregated column, -1 for COUNT(*)
+    int groupPosition;            //!< Position in the GROUPBY columns for a GROUPBY column
+
+    AggregateColumn(AggregateType aggregateType, int columnIndex, int groupPosition)
+        : aggregateType(aggregateType), columnIndex(columnIndex), groupPosition(groupPosition) {}
+};
+
+/** Running state of an aggregate
+ *  Holds everything needed for COUNT, SUM, MIN, MAX and AVG,
+ *  so a group is aggregated in a single pass over its records
+ */
+struct AggregateState {
+    long long count = 0;        //!< Number of aggregated values
+    long long sum = 0;          //!< Sum of the integer values
+    int minInt = 0;             //!< Minimal INT or DATE value
+    int maxInt = 0;             //!< Maximal INT or DATE value
+    std::string minString;      //!< Minimal STRING value
+    std::string maxString;      //!< Maximal STRING value
+    FieldType valueType = FieldType::UNDEFINED;
+
+    //! Add a value to the aggregate, nullptr is counted only
+    void add(DataField* value);
+
+    //! Get the aggregate result as a string
+    std::string result(AggregateType aggregateType) const;
+};
+
+#endif
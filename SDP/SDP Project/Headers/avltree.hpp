@@ -1,13 +1,17 @@
 #ifndef AVLTREE_HPP
 #define AVLTREE_HPP
 
+#include <algorithm>
+#include <iterator>
 #include <string>
+#include <vector>
 
 #include "field.hpp"
 #include "record.hpp"
+#include "recordindex.hpp"
 #include "utilityhelper.hpp"
 
-class AVLTree {
+class AVLTree : public RecordIndex {
    private:
     struct RecordNode {
         RecordNode* leftNode;
@@ -17,17 +21,19 @@ class AVLTree {
         int valueint;
 
         RecordNode() {}
-        RecordNode(Record* value) : heightOfSubtree(0), leftNode(nullptr), rightNode(nullptr) { records.push_back(value); }
+        RecordNode(Record* value) : leftNode(nullptr), rightNode(nullptr), heightOfSubtree(0) { records.push_back(value); }
     };
     RecordNode* avlRoot = nullptr;
+    size_t recordsCount = 0;
     int columnIndex = -1;
     FieldType dataType = FieldType::UNDEFINED;
 
    public:
     std::list<Record*> searchResult;
+    int searchLimit = -1;  //!< Maximal number of records in the search result, -1 for all
 
     AVLTree(int column, FieldType type) : columnIndex(column), dataType(type) {}
-    ~AVLTree() {
+    ~AVLTree() override {
         clearTree(avlRoot);
     }
 
@@ -37,6 +43,9 @@ class AVLTree {
     //! Compare a node and a record by column
     int compareTreeNodeAndRecord(RecordNode* value1, Record* value2);
 
+    //! Compare two records by column
+    int compareRecordKeys(Record* value1, Record* value2) const;
+
     //! Get node height
     int treeHeight(RecordNode* root) const;
 
@@ -53,7 +62,7 @@ class AVLTree {
     int balanceFactor(RecordNode* root) const;
 
     //! Insert node wrapper function
-    void insert(Record* value);
+    void insert(Record* value) override;
 
     //! Insert node under the root
     void insertNode(RecordNode*& root, Record* value);
@@ -61,20 +70,71 @@ class AVLTree {
     //! Get the minimal node from a tree
     RecordNode* getMinNode(RecordNode* root) const;
 
+    //! Get the record with the minimal key, nullptr for an empty tree
+    Record* getMinRecord() const override;
+
+    //! Get the record with the maximal key, nullptr for an empty tree
+    Record* getMaxRecord() const override;
+
+    //! Get the number of indexed records
+    int countRecords() const override;
+
+    //! Get all indexed records in key order
+    std::vector<Record*> orderedRecords() const override;
+
+    //! Get the memory used by the tree in bytes
+    size_t memoryBytes() const override;
+
+    //! Get the memory used by the nodes of a tree in bytes
+    size_t nodeBytes(RecordNode* root) const;
+
+    //! Insert records sorted by key, a large batch is merged and the tree is rebuilt balanced
+    void insertSorted(const std::vector<Record*>& sortedRecords) override;
+
+    //! Append the records of a tree in key order
+    void collectRecords(RecordNode* root, std::vector<Record*>& collectedRecords) const;
+
+    //! Build a balanced tree from nodes sorted by key
+    RecordNode* buildBalanced(const std::vector<RecordNode*>& sortedNodes, int first, int last);
+
     //! Remove node wrapper function
-    void removeData(Record* value);
+    void removeData(Record* value) override;
 
     //! Remove node from the root
     void deleteNode(RecordNode*& root, Record* value);
 
-    //! Search a node by value
-    std::list<Record*> searchNode(std::string value, OperatorType operatorCompare);
+    //! Unlink the minimal node from a tree and return it
+    RecordNode* detachMinNode(RecordNode*& root);
+
+    //! Recalculate the height of a node and restore its balance with rotations
+    void rebalanceNode(RecordNode*& root);
+
+    //! Search a node by value, stopping after maxRecords records if not negative
+    std::list<Record*> searchNode(std::string value, OperatorType operatorCompare, int maxRecords = -1) override;
+
+    //! Get the key of a node as an integer for INT and DATE
+    void nodeKey(RecordNode* root, int& key) const;
+
+    //! Get the key of a node as a string for STRING
+    void nodeKey(RecordNode* root, std::string& key) const;
+
+    //! Search by integer or string key with any comparison operator
+    template <typename KeyType>
+    void searchKey(const KeyType& value, OperatorType operatorCompare);
+
+    //! Search an equal node by integer or string key
+    template <typename KeyType>
+    RecordNode* searchEqualNode(RecordNode*& root, const KeyType& value);
+
+    //! Search nodes by integer or string key with comparison operators
+    template <typename KeyType>
+    void searchNodeCompare(RecordNode*& root, const KeyType& value, OperatorType operatorCompare);
 
-    //! Search an equal node by value
-    RecordNode* searchEqualNode(RecordNode*& root, std::string value);
+    //! Search the STRING keys matching a LIKE pattern, using the range of its prefix
+    void searchLike(const std::string& pattern);
 
-    //! Search a node by value wit comparison operators
-    RecordNode* searchNodeCompare(RecordNode*& root, std::string value, OperatorType operatorCompare);
+    //! Search nodes in key order with STRING keys in the range [low, high), an empty high has no upper bound
+    void searchStringRange(RecordNode* root, const std::string& low, const std::string& high);
 
     //! Helper function used under development
     // void printall() {
@@ -0,0 +1,126 @@
+#ifndef BPLUSTREE_HPP
+#define BPLUSTREE_HPP
+
+#include <algorithm>
+#include <iterator>
+#include <list>
+#include <string>
+#include <vector>
+
+#include "field.hpp"
+#include "record.hpp"
+#include "recordindex.hpp"
+#include "utilityhelper.hpp"
+
+const unsigned int BPTREE_NODE_KEYS = 64;  //!< Maximal number of keys in a node, a few cache lines of INT keys
+
+/** B+ tree index
+ *  The keys of a node are stored contiguously and searched with a binary search,
+ *  so a lookup touches a few wide nodes instead of one node per tree level.
+ *  Only the leaves hold records, a posting array of records for each key,
+ *  and the leaves are linked in key order for range scans.
+ *  Removed keys leave underfull leaves, VACUUM rebuilds the index.
+ *  KeyType is int for INT and DATE and std::string for STRING.
+ */
+template <typename KeyType>
+class BPlusTree : public RecordIndex {
+   private:
+    struct TreeNode {
+        bool isLeaf;
+        std::vector<KeyType> keys;
+        std::vector<TreeNode*> children;           //!< Children of an inner node, one more than the keys
+        std::vector<std::vector<Record*>> postings;  //!< Records of each key of a leaf
+        TreeNode* nextLeaf = nullptr;              //!< Next leaf in key order
+
+        TreeNode(bool isLeaf) : isLeaf(isLeaf) {}
+    };
+    TreeNode* treeRoot = nullptr;
+    TreeNode* firstLeaf = nullptr;
+    size_t recordsCount = 0;
+    int columnIndex = -1;
+    FieldType dataType = FieldType::UNDEFINED;
+
+    //! Get the key of a record
+    void recordKey(Record* value, int& key) const;
+    void recordKey(Record* value, std::string& key) const;
+
+    //! Parse a searched value as a key, false if it is not a valid key
+    bool parseKey(const std::string& value, int& key) const;
+    bool parseKey(const std::string& value, std::string& key) const;
+
+    //! Delete a subtree
+    void clearTree(TreeNode* root);
+
+    //! Find the leaf that should hold a key
+    TreeNode* findLeaf(const KeyType& key) const;
+
+    //! Insert a record under a node, return the new right sibling if the node was split
+    TreeNode* insertNode(TreeNode* root, const KeyType& key, Record* value, KeyType& separatorKey);
+
+    //! Build the tree from records sorted by key
+    void buildFromSorted(const std::vector<Record*>& sortedRecords);
+
+    //! Append the records of the leaves in key order
+    void collectRecords(std::vector<Record*>& collectedRecords) const;
+
+    //! Append the records of the leaves from a key position while the keys satisfy the comparison, stopping at the search limit
+    void scanLeaves(TreeNode* leaf, unsigned int position, OperatorType operatorCompare, const KeyType& value);
+
+    //! Get the record with the maximal key under a node
+    Record* maxRecord(TreeNode* root) const;
+
+    //! Get the memory used by a subtree in bytes
+    size_t nodeBytes(TreeNode* root) const;
+
+    //! Get the heap bytes of a key
+    size_t keyHeapBytes(int) const { return 0; }
+    size_t keyHeapBytes(const std::string& key) const { return textHeapBytes(key.size()); }
+
+    //! Get the range [lowKey, highKey) of the keys with the prefix of a LIKE pattern, false for other than STRING keys
+    bool likeRange(const std::string& pattern, int& lowKey, int& highKey, bool& hasHighKey) const;
+    bool likeRange(const std::string& pattern, std::string& lowKey, std::string& highKey, bool& hasHighKey) const;
+
+    //! Search the STRING keys matching a LIKE pattern, using the range of its prefix
+    void searchLike(const std::string& pattern);
+
+   public:
+    std::list<Record*> searchResult;
+    int searchLimit = -1;  //!< Maximal number of records in the search result, -1 for all
+
+    BPlusTree(int column, FieldType type) : columnIndex(column), dataType(type) {}
+    ~BPlusTree() override {
+        clearTree(treeRoot);
+    }
+
+    //! Insert a record
+    void insert(Record* value) override;
+
+    //! Insert records sorted by key, a large batch is merged and the tree is rebuilt with full leaves
+    void insertSorted(const std::vector<Record*>& sortedRecords) override;
+
+    //! Remove a record
+    void removeData(Record* value) override;
+
+    //! Search records by value, stopping after maxRecords records if not negative
+    std::list<Record*> searchNode(std::string value, OperatorType operatorCompare, int maxRecords = -1) override;
+
+    //! Get the record with the minimal key, nullptr for an empty tree
+    Record* getMinRecord() const override;
+
+    //! Get the record with the maximal key, nullptr for an empty tree
+    Record* getMaxRecord() const override;
+
+    //! Get the number of indexed records
+    int countRecords() const override;
+
+    //! Get all indexed records in key order
+    std::vector<Record*> orderedRecords() const override;
+
+    //! Get the memory used by the tree in bytes
+    size_t memoryBytes() const override;
+
+    //! Get the number of levels of the tree
+    int treeHeight() const;
+};
+
+#endif
@@ -1,16 +1,25 @@
 #ifndef COMMAND_HPP
 #define COMMAND_HPP
 
+#include <algorithm>
 #include <cstring>
 #include <fstream>
+#include <future>
 #include <iostream>
+#include <memory>
 #include <string>
+#include <unordered_map>
+#include <unordered_set>
 #include <vector>
 
 #include "database.hpp"
+#include "profiler.hpp"
+#include "querycache.hpp"
+#include "snapshot.hpp"
 #include "utilityhelper.hpp"
 
 const unsigned int SIZE_OPERATION = 12;  //!< Size of operation keyword
+const char SLOW_QUERY_LOG[] = "slowqueries.log";  //!< File with the slow commands
 
 //! Оperations with corresponding integers
 enum class OperationType {
@@ -29,6 +38,25 @@ enum class OperationType {
     INSERT = 9,
     REMOVE = 10,
     SELECT = 11,
+    VACUUM = 12,
+    UPDATE = 13,
+    ANALYZE = 14,
+
+    SET = 15,
+    CACHESTATS = 16,
+    EXPLAIN = 17,
+
+    SAVE = 18,
+    LOAD = 19,
+
+    CREATE = 20,
+    DROP = 21,
+    CHECKPOINT = 22,
+    SOURCE = 23,
+
+    BEGIN = 24,
+    COMMIT = 25,
+    ROLLBACK = 26,
 
     COUNTOPERATIONS  // Number of operations
 };
@@ -46,18 +74,78 @@ const char OperationList[(int)(OperationType::COUNTOPERATIONS)][SIZE_OPERATION]
     "TABLEINFO",
     "INSERT",
     "REMOVE",
-    "SELECT"};
+    "SELECT",
+    "VACUUM",
+    "UPDATE",
+    "ANALYZE",
+    "SET",
+    "CACHESTATS",
+    "EXPLAIN",
+    "SAVE",
+    "LOAD",
+    "CREATE",
+    "DROP",
+    "CHECKPOINT",
+    "SOURCE",
+    "BEGIN",
+    "COMMIT",
+    "ROLLBACK"};
+
+//! Command of a script with the line where it starts
+struct ScriptCommand {
+    int lineNumber;
+    std::string commandText;
+};
+
+//! Parts of a SELECT command
+struct SelectQuery {
+    std::vector<std::string> selectParameters;  //!< All words of the command
+    std::vector<std::string> selectedColumns;
+    std::vector<std::string> distinctColumns;
+    std::vector<std::string> orderByColumns;
+    std::string tableName;
+    std::vector<std::string> whereParameters;
+    std::vector<std::string> groupByColumns;
+    std::string joinTableName;
+    std::vector<std::string> joinParameters;
+    int limitRecords = -1;
+    int offsetRecords = 0;
+};
 
 class CommandLine {
    private:
+    //! Table written to its file by a background thread
+    struct PendingFlush {
+        std::future<void> flushDone;  //!< Ready when the file is written, gives the error of a failed write
+        Table* closedTable;           //!< Table of CLOSE, deleted after the write, nullptr for a checkpoint
+    };
+
     bool commandExit = false;      //!< Quit the program flag
     std::string commandLineInput;  //!< The input command
     Database database;             //!< The database data
+    QueryCache queryCache;         //!< Results of recent selections
+    QueryProfiler queryProfiler;   //!< Measurements of the last profiled command
+    QueryProfiler* activeProfiler = nullptr;  //!< Profiler of the running command, nullptr if not profiled
+    bool profilingEnabled = false;            //!< Log slow commands flag
+    double slowQueryMilliseconds = 100;       //!< Threshold of the slow commands
     bool loading = false;
+    unsigned long long memoryLimit = 0;     //!< Memory budget of the open tables in bytes, 0 for no limit
+    unsigned long long commandCounter = 0;  //!< Number of executed commands, the clock of the table uses
+    std::unordered_map<int, unsigned long long> tableLastUse;  //!< Command of the last use of each table by id
+    std::unordered_set<int> evictedTables;                     //!< Ids of the tables closed to keep the memory within the budget
+    std::unordered_map<int, PendingFlush> pendingFlushes;      //!< Writes of the tables by id still running in the background
+    unsigned long long checkpointInterval = 0;                 //!< Number of commands between checkpoints, 0 for no checkpoints
+    std::unordered_map<int, unsigned long long> checkpointVersions;  //!< Version of each table by id at its last checkpoint
+    std::unordered_set<std::string> runningScripts;                  //!< Files of the scripts being run, a script cannot run itself
+    bool inTransaction = false;                //!< Flag if the changes are kept in the undo logs of the tables
+    bool scriptTransaction = false;            //!< Flag if the transaction was started by a script, not by BEGIN
+    std::unordered_set<int> transactionTables;  //!< Ids of the tables with changes logged by the transaction
 
    public:
     CommandLine() {}
-    ~CommandLine() { database.~Database(); }
+    ~CommandLine() {
+        finishFlushes();
+    }
 
     //! Main commandline interface cycle
     void CommandLineInterface();
@@ -77,9 +165,18 @@ class CommandLine {
     //! Help information
     void helpInfo() const;
 
-    //! Get table by its name
+    //! Get table by its name, an evicted table is loaded again
     Table* getTableByName(std::string tableName);
 
+    //! Get a materialized view by its name, nullptr if there is no such view
+    MaterializedView* getViewByName(const std::string& viewName) const;
+
+    //! Get the stable id of a table by its name, -1 if there is no such table
+    int getTableId(const std::string& tableName) const;
+
+    //! Get table by its stable id, an evicted table is loaded again, nullptr for a dropped table
+    Table* getTableById(int tableId);
+
     //! Create table in the database command
     void createTable();
 
@@ -95,11 +192,38 @@ class CommandLine {
     //! Insert record/s in a table command
     void insertRecord();
 
+    //! Split the text of a SELECT command after the SELECT keyword into its parts
+    SelectQuery parseSelect(const std::string& selectText) const;
+
     //! Select records from the table command
     void selectRecords();
 
+    //! Display the rows of a materialized view, only LIMIT and OFFSET are applied
+    void selectView(MaterializedView* selectedView, const SelectQuery& selectQuery);
+
+    //! Create a materialized view of a selection command
+    void createView();
+
+    //! Remove a materialized view command
+    void dropView();
+
+    //! Join two tables for a selection
+    Table* joinTables(Table* selectedTable, std::string joinTableName, std::vector<std::string> joinParameters);
+
     //! Dizplay database records
-    void printDatabase(Table* selectedTable, std::list<Record*> selectedRecords, std::vector<std::string> selectedColumns);
+    void printDatabase(Table* selectedTable, const std::vector<unsigned int>& rowIds, std::vector<std::string> selectedColumns);
+
+    //! Convert the selected row ids to rows of values, only the selected columns are read, the first row is the header
+    std::vector<std::vector<std::string>> formatRows(Table* selectedTable, const std::vector<unsigned int>& rowIds, std::vector<std::string> selectedColumns);
+
+    //! Display rows of values, the first row is the header
+    void printRows(const std::vector<std::vector<std::string>>& printedRows);
+
+    //! Display rows of values as the last stage of a profiled selection
+    void printProfiledRows(const std::vector<std::vector<std::string>>& printedRows);
+
+    //! Keep only the rows of the LIMIT after the OFFSET, the first row is the header
+    void limitRows(std::vector<std::vector<std::string>>& rows, int limitRecords, int offsetRecords);
 
     //! Store information directly on the disk as a file command
     void closeInfile();
@@ -107,8 +231,92 @@ class CommandLine {
     //! Load information in the computer memory command
     void loadFromFile();
 
+    //! Start a transaction command
+    void beginTransaction();
+
+    //! Keep the changes of the transaction command
+    void commitCommand();
+
+    //! Undo the changes of the transaction command
+    void rollbackCommand();
+
+    //! Keep the logged changes of all tables, the transaction stays running
+    void commitTransaction();
+
+    //! Undo the logged changes of all tables, the transaction stays running
+    void rollbackTransaction();
+
+    //! Verify if an operation changes what an undo log cannot restore, so the transaction is committed before it
+    bool commitsTransaction(OperationType operationType) const;
+
+    //! Read the commands of a script, consecutive INSERT commands of the same table are joined in a single batch
+    std::vector<ScriptCommand> parseScript(std::istream& scriptInput) const;
+
+    //! Run the commands of a script file in a transaction, the first failed command stops the script and undoes it
+    void runScript(const std::string& fileName);
+
+    //! Run the commands of a script file command
+    void sourceScript();
+
+    //! Write a table in its file in the background and release its records, an empty table takes its place
+    void closeTable(int tableId);
+
+    //! Write an open table in its file in the background, the table stays open
+    void checkpointTable(int tableId);
+
+    //! Wait until the background write of a table is finished, a table of a failed CLOSE is restored and the error is thrown
+    void waitForFlush(int tableId);
+
+    //! Report the errors of the finished background writes
+    void collectFlushes();
+
+    //! Wait for all background writes, the errors are only displayed
+    void finishFlushes();
+
+    //! Write the open tables changed since their last checkpoint in the background
+    void checkpointChangedTables();
+
+    //! Write a table or all changed open tables in their files command
+    void checkpointTables();
+
+    //! Replace a closed table with the table in its file, return the loaded table
+    Table* openTable(int tableId);
+
+    //! Close the least recently used tables until the open tables fit in the memory budget
+    void enforceMemoryLimit();
+
     //! Remove selected records from the database command
     void removeRecords();
+
+    //! Update fields of selected records command
+    void updateRecords();
+
+    //! Rebuild the statistics of a table command
+    void analyzeTable();
+
+    //! Reclaim the space of removed records command
+    void vacuumTable();
+
+    //! Change a setting of the command line command
+    void setOption();
+
+    //! Display the counters of the query cache command
+    void cacheStats();
+
+    //! Run a selection and display the measurements of its stages command
+    void explainQuery();
+
+    //! Get the file name of a SAVE DATABASE or LOAD DATABASE command
+    std::string snapshotFileName();
+
+    //! Store all tables in a single snapshot file command
+    void saveDatabase();
+
+    //! Load all tables of a snapshot file command
+    void loadDatabase();
+
+    //! Append the last profiled command to the slow query log if over the threshold
+    void logSlowQuery(std::string commandText);
 };
 
 #endif
\ No newline at end of file
@@ -0,0 +1,86 @@
+#ifndef COMPRESSION_HPP
+#define COMPRESSION_HPP
+
+#include <algorithm>
+#include <climits>
+#include <string>
+#include <vector>
+
+#include "utilityhelper.hpp"
+
+//! Encodings of a block of INT or DATE values
+enum class CompressionType {
+    RAW = 0,    // Plain values
+    RLE = 1,    // Runs of equal values
+    FOR = 2,    // Bit-packed offsets from the minimal value
+    DELTA = 3,  // Bit-packed differences between neighbouring values
+    COUNTCOMPRESSIONTYPE
+};
+
+//! List of all encoding names
+const char CompressionTypeList[(int)(CompressionType::COUNTCOMPRESSIONTYPE)][6] = {
+    "RAW",
+    "RLE",
+    "FOR",
+    "DELTA"};
+
+/** Compressed block of INT or DATE values
+ *  Every encoding is tried and the smallest one is kept,
+ *  so repeated values become runs, dates become narrow offsets
+ *  and sorted keys become narrow differences.
+ */
+class CompressedBlock {
+   private:
+    CompressionType compressionType = CompressionType::RAW;
+    unsigned int valuesCount = 0;
+    int baseValue = 0;                          //!< FOR: minimal value, DELTA: first value
+    long long deltaBase = 0;                    //!< DELTA: minimal difference
+    unsigned int bitWidth = 0;                  //!< FOR and DELTA: bits of a packed value
+    unsigned int maxOffset = 0;                 //!< FOR: largest packed offset
+    std::vector<int> plainValues;               //!< RAW: values, RLE: value of each run
+    std::vector<unsigned int> runEnds;          //!< RLE: position after each run
+    std::vector<unsigned long long> packedWords;  //!< FOR and DELTA: packed values
+
+    //! Get the number of bits of a value
+    static unsigned int bitsNeeded(unsigned long long value);
+
+    //! Get the number of words needed for packed values
+    static unsigned int wordsNeeded(unsigned int packedCount, unsigned int width);
+
+    //! Pack the values with a fixed bit width
+    void packValues(const std::vector<unsigned long long>& values, unsigned int width);
+
+    //! Get a packed value by its position
+    unsigned long long packedValue(unsigned int position) const {
+        if (bitWidth == 0) return 0;
+        unsigned long long bitPosition = (unsigned long long)position * bitWidth;
+        unsigned int word = bitPosition / 64, shift = bitPosition % 64;
+        unsigned long long value = packedWords[word] >> shift;
+        if (shift + bitWidth > 64) value |= packedWords[word + 1] << (64 - shift);
+        return value & ((1ULL << bitWidth) - 1);
+    }
+
+   public:
+    //! Encode the values with the smallest encoding
+    void encode(const std::vector<int>& values);
+
+    //! Decode all values
+    void decode(std::vector<int>& values) const;
+
+    //! Get the encoding of the block
+    CompressionType getCompressionType() const { return compressionType; }
+
+    //! Get the number of values
+    unsigned int getValuesCount() const { return valuesCount; }
+
+    //! Get the size of the encoded values in bytes
+    unsigned int encodedBytes() const;
+
+    //! Append the block in binary form
+    void writeBlock(std::string& buffer) const;
+
+    //! Read the block from its binary form, false if it is damaged
+    bool readBlock(const char*& position, const char* end);
+};
+
+#endif
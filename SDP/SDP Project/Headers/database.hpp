@@ -3,24 +3,124 @@
 
 #include <list>
 #include <string>
+#include <unordered_map>
 #include <vector>
 
 #include "field.hpp"
 #include "record.hpp"
 #include "table.hpp"
+#include "view.hpp"
 
 /** The database
  *  The main database class containing all the tables,
  *  used as a simple container, completely controlled by the
  *  CommandLine interface
+ *  The catalog gives each table a stable id, the position of the table
+ *  in the storage. Ids are never reused, so a saved id is resolved
+ *  in constant time and a dropped table is recognised.
+ *  The materialized views are kept by name next to the tables.
  */
 class Database {
    private:
-    std::vector<Table *> tables;
+    std::vector<Table *> tables;                    //!< Tables by id, nullptr for dropped tables
+    std::unordered_map<std::string, int> tableIds;  //!< Catalog of the table ids by name
+    int tablesCount = 0;                            //!< Number of tables in the catalog
+    std::unordered_map<std::string, MaterializedView *> views;  //!< Materialized views by name
 
    public:
     Database() {}
-    ~Database() {}
+    ~Database() {
+        for (std::unordered_map<std::string, MaterializedView *>::iterator it = views.begin(); it != views.end(); ++it) delete it->second;
+        for (unsigned int i = 0; i < tables.size(); ++i) delete tables[i];
+    }
+
+    //! Add a table to the catalog and return its id
+    int addTable(Table *newTable) {
+        tables.push_back(newTable);
+        tableIds[newTable->getTableName()] = tables.size() - 1;
+        ++tablesCount;
+        return tables.size() - 1;
+    }
+
+    //! Get the id of a table by its name, -1 if there is no such table
+    int findTableId(const std::string &tableName) const {
+        std::unordered_map<std::string, int>::const_iterator it = tableIds.find(tableName);
+        return it == tableIds.end() ? -1 : it->second;
+    }
+
+    //! Get a table by its id, nullptr for a dropped or unknown id
+    Table *getTable(int tableId) const {
+        return (tableId < 0 || tableId >= (int)tables.size()) ? nullptr : tables[tableId];
+    }
+
+    //! Replace the table of an id with a table of the same name, the old table is deleted
+    void replaceTable(int tableId, Table *newTable) {
+        delete tables[tableId];
+        tables[tableId] = newTable;
+    }
+
+    //! Replace the table of an id with a table of the same name and return the old table without deleting it
+    Table *swapTable(int tableId, Table *newTable) {
+        Table *oldTable = tables[tableId];
+        tables[tableId] = newTable;
+        return oldTable;
+    }
+
+    //! Remove a table from the catalog and delete it, false if there is no such table
+    bool dropTable(const std::string &tableName) {
+        int tableId = findTableId(tableName);
+        if (tableId < 0) return false;
+        tableIds.erase(tableName);
+        delete tables[tableId];
+        tables[tableId] = nullptr;
+        --tablesCount;
+        return true;
+    }
+
+    //! Get the number of tables in the catalog
+    int countTables() const { return tablesCount; }
+
+    //! Get the number of ids given to tables, including the dropped ones
+    int countTableIds() const { return tables.size(); }
+
+    //! Get all tables in the order of their creation
+    std::vector<Table *> allTables() const {
+        std::vector<Table *> existingTables;
+        existingTables.reserve(tablesCount);
+        for (unsigned int i = 0; i < tables.size(); ++i) {
+            if (tables[i]) existingTables.push_back(tables[i]);
+        }
+        return existingTables;
+    }
+
+    //! Add a view to the catalog
+    void addView(MaterializedView *newView) {
+        views[newView->getViewName()] = newView;
+    }
+
+    //! Get a view by its name, nullptr if there is no such view
+    MaterializedView *getView(const std::string &viewName) const {
+        std::unordered_map<std::string, MaterializedView *>::const_iterator it = views.find(viewName);
+        return it == views.end() ? nullptr : it->second;
+    }
+
+    //! Remove a view from the catalog and delete it, false if there is no such view
+    bool dropView(const std::string &viewName) {
+        std::unordered_map<std::string, MaterializedView *>::iterator it = views.find(viewName);
+        if (it == views.end()) return false;
+        delete it->second;
+        views.erase(it);
+        return true;
+    }
+
+    //! Get all views of a table
+    std::vector<MaterializedView *> tableViews(const std::string &tableName) const {
+        std::vector<MaterializedView *> observingViews;
+        for (std::unordered_map<std::string, MaterializedView *>::const_iterator it = views.begin(); it != views.end(); ++it) {
+            if (it->second->getTableName() == tableName) observingViews.push_back(it->second);
+        }
+        return observingViews;
+    }
 
     friend class CommandLine;  //!< The database is considered a container and is completely controlled by the CLI
 };
@@ -3,6 +3,8 @@
 
 #include <string>
 
+#include "utilityhelper.hpp"
+
 //! Enum of all field types
 enum class FieldType {
     UNDEFINED = 0,
@@ -23,11 +25,15 @@ const char FieldTypeList[(int)(FieldType::COUNTFIELDTYPE)][10] = {
 class DataField {
    private:
    public:
+    virtual ~DataField() {}
+    virtual DataField* clone() { return new DataField(*this); }
     virtual FieldType getType() { return FieldType::UNDEFINED; }
     virtual int getValueInt() { return 0; }
     virtual std::string getValueString() { return ""; }
     virtual std::string getValueDate() { return ""; }
     virtual std::string getValueUniform() { return ""; }
+    virtual void setValueInt(int) {}
+    virtual void setValueString(const std::string&) {}
 };
 
 //! Field type INT
@@ -37,9 +43,11 @@ class DataFieldInt : public DataField {
 
    public:
     DataFieldInt(int intValue) : intValue(intValue) {}
+    DataField* clone() override { return new DataFieldInt(*this); }
     FieldType getType() override { return FieldType::INT; }
     int getValueInt() override { return intValue; }
     std::string getValueUniform() override { return std::to_string(intValue); }
+    void setValueInt(int intValue) override { this->intValue = intValue; }
 };
 
 //! Field type STRING
@@ -49,21 +57,27 @@ class DataFieldString : public DataField {
 
    public:
     DataFieldString(std::string stringValue) : stringValue(stringValue) {}
+    DataField* clone() override { return new DataFieldString(*this); }
     FieldType getType() override { return FieldType::STRING; }
     std::string getValueString() override { return stringValue; }
     std::string getValueUniform() override { return stringValue; }
+    void setValueString(const std::string& stringValue) override { this->stringValue = stringValue; }
 };
 
 //! Field type DATE
+//! The date is stored as a day number, so it is ordered as an integer
 class DataFieldDate : public DataField {
    private:
-    std::string stringValue;
+    int dateValue;
 
    public:
-    DataFieldDate(std::string stringValue) : stringValue(stringValue) {}
+    DataFieldDate(int dateValue) : dateValue(dateValue) {}
+    DataField* clone() override { return new DataFieldDate(*this); }
     FieldType getType() override { return FieldType::DATE; }
-    std::string getValueDate() override { return stringValue; }
-    std::string getValueUniform() override { return stringValue; }
+    int getValueInt() override { return dateValue; }
+    std::string getValueDate() override { return formatDate(dateValue); }
+    std::string getValueUniform() override { return formatDate(dateValue); }
+    void setValueInt(int dateValue) override { this->dateValue = dateValue; }
 };
 
 #endif
\ No newline at end of file
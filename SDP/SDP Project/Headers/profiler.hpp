@@ -0,0 +1,50 @@
+#ifndef PROFILER_HPP
+#define PROFILER_HPP
+
+#include <chrono>
+#include <string>
+#include <vector>
+
+/** Query profiler
+ *  Measures the wall time, the number of rows in and out,
+ *  the visited index nodes and the allocations of each stage
+ *  of a single query. Stages follow each other without nesting.
+ *  Only the allocations of the thread running a stage are counted.
+ */
+class QueryProfiler {
+   private:
+    //! Measurements of a single stage
+    struct ProfileStage {
+        std::string stageName;
+        double milliseconds;
+        long long rowsIn, rowsOut;
+        unsigned long long nodesVisited, allocations;
+    };
+
+    std::vector<ProfileStage> stages;                          //!< Finished stages in order
+    std::chrono::steady_clock::time_point queryStart, stageStart;  //!< Start times
+    std::string stageName;                                     //!< Name of the running stage
+    long long stageRowsIn = 0;                                 //!< Rows given to the running stage
+    unsigned long long stageNodes = 0;                         //!< Visited index nodes at the start of the running stage
+
+   public:
+    //! Drop the previous measurements and start the time of a query
+    void startQuery();
+
+    //! Start measuring a stage
+    void startStage(const std::string& name, long long rowsIn);
+
+    //! Add details to the name of the running stage
+    void describeStage(const std::string& detail);
+
+    //! Finish measuring the running stage
+    void endStage(long long rowsOut);
+
+    //! Get the wall time since the start of the query in milliseconds
+    double totalMilliseconds() const;
+
+    //! Return the measurements as rows of values, the first row is the header
+    std::vector<std::vector<std::string>> profileRows() const;
+};
+
+#endif
@@ -0,0 +1,59 @@
+#ifndef QUERYCACHE_HPP
+#define QUERYCACHE_HPP
+
+#include <list>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+const size_t QUERY_CACHE_BYTES = 4 * 1024 * 1024;  //!< Default memory limit of the query cache
+
+/** Query result cache
+ *  Keeps the displayed rows of recent selections with the least
+ *  recently used entries evicted first when over the memory limit.
+ *  The keys contain the versions of the selected tables,
+ *  so changed tables never match their old results.
+ */
+class QueryCache {
+   private:
+    //! Cached rows of a single query
+    struct CacheEntry {
+        std::string queryKey;
+        std::vector<std::vector<std::string>> resultRows;
+        size_t entryBytes;
+    };
+
+    bool cacheEnabled = false;                 //!< Flag if the results are cached
+    size_t capacityBytes = QUERY_CACHE_BYTES;  //!< Memory limit of all entries
+    size_t usedBytes = 0;                      //!< Memory used by all entries
+    unsigned long long cacheHits = 0, cacheMisses = 0, cacheEvictions = 0;
+    std::list<CacheEntry> entries;  //!< Entries from the most to the least recently used
+    std::unordered_map<std::string, std::list<CacheEntry>::iterator> entryByKey;
+
+    //! Remove the least recently used entries until the used memory fits the limit
+    void evict(size_t limitBytes);
+
+   public:
+    //! Turn the cache on or off, turning it off drops all entries
+    void setEnabled(bool enabled);
+
+    //! Return if the results are cached
+    bool isEnabled() const { return cacheEnabled; }
+
+    //! Set the memory limit in bytes
+    void setCapacity(size_t capacity);
+
+    //! Find the rows of a query, counting a hit or a miss
+    bool lookup(const std::string& queryKey, std::vector<std::vector<std::string>>& resultRows);
+
+    //! Store the rows of a query, results larger than the limit are not kept
+    void store(const std::string& queryKey, const std::vector<std::vector<std::string>>& resultRows);
+
+    //! Remove all entries
+    void clear();
+
+    //! Return the cache counters as a string
+    std::string cacheInfo() const;
+};
+
+#endif
@@ -14,6 +14,7 @@
 class Record {
    private:
     std::vector<DataField*> fields;
+    unsigned int rowId = 0;  //!< Position of the record in the table storage
 
    public:
     Record() {}
@@ -24,6 +25,9 @@ class Record {
     //! Get data from a record with selected index
     DataField* getData(int index) { return fields[index]; }
 
+    //! Get the position of the record in the table storage
+    unsigned int getRowId() const { return rowId; }
+
     friend class Table;  //!< The record is considered a container and is completely controlled by the table
 };
 
@@ -0,0 +1,66 @@
+#ifndef RECORDINDEX_HPP
+#define RECORDINDEX_HPP
+
+#include <atomic>
+#include <list>
+#include <string>
+#include <vector>
+
+#include "field.hpp"
+#include "record.hpp"
+#include "utilityhelper.hpp"
+
+//! Structures of an indexed field
+enum class IndexType {
+    AVL = 0,     // Balanced binary tree, one node per key
+    BPTREE = 1,  // B+ tree with wide nodes and linked leaves
+    COUNTINDEXTYPE
+};
+
+//! List of all index structure names
+const char IndexTypeList[(int)(IndexType::COUNTINDEXTYPE)][10] = {
+    "AVL",
+    "BPTREE"};
+
+/** Index of the records of a table by one column
+ *  Common interface of all index structures,
+ *  so the table does not depend on the structure of an index.
+ */
+class RecordIndex {
+   public:
+    static std::atomic<unsigned long long> nodesVisited;  //!< Number of nodes visited by all searches and inserts, tables load in parallel
+
+    virtual ~RecordIndex() {}
+
+    //! Insert a record
+    virtual void insert(Record* value) = 0;
+
+    //! Insert records sorted by key
+    virtual void insertSorted(const std::vector<Record*>& sortedRecords) = 0;
+
+    //! Remove a record
+    virtual void removeData(Record* value) = 0;
+
+    //! Search records by value, stopping after maxRecords records if not negative
+    virtual std::list<Record*> searchNode(std::string value, OperatorType operatorCompare, int maxRecords = -1) = 0;
+
+    //! Get the record with the minimal key, nullptr for an empty index
+    virtual Record* getMinRecord() const = 0;
+
+    //! Get the record with the maximal key, nullptr for an empty index
+    virtual Record* getMaxRecord() const = 0;
+
+    //! Get the number of indexed records
+    virtual int countRecords() const = 0;
+
+    //! Get all indexed records in key order
+    virtual std::vector<Record*> orderedRecords() const = 0;
+
+    //! Get the memory used by the index structure in bytes
+    virtual size_t memoryBytes() const = 0;
+};
+
+//! Create an empty index structure for a column
+RecordIndex* createRecordIndex(int columnIndex, FieldType type, IndexType indexType);
+
+#endif
@@ -0,0 +1,39 @@
+#ifndef SNAPSHOT_HPP
+#define SNAPSHOT_HPP
+
+#include <algorithm>
+#include <atomic>
+#include <cstdio>
+#include <cstring>
+#include <exception>
+#include <fstream>
+#include <functional>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "table.hpp"
+
+const char SNAPSHOT_MAGIC[] = "SDPSNAP";              //!< First bytes of a snapshot file
+const unsigned int SNAPSHOT_VERSION = 2;              //!< Version of the snapshot format
+const unsigned int SNAPSHOT_BUFFER_BYTES = 1 << 22;  //!< Size of the file buffer used to write a snapshot
+
+/** Snapshot of a whole database in one binary file
+ *  Header: magic, format version, number of tables.
+ *  Then a section for each table with its size in bytes first,
+ *  so the sections are encoded and decoded on separate threads.
+ *  A single table is streamed in buffers of a fixed size instead,
+ *  and the size of its section is filled in after it is written.
+ *  INT and DATE columns are stored as compressed blocks of rows.
+ *  The indexes are stored as their field definitions and rebuilt
+ *  with a sorted insert when the records are loaded.
+ */
+
+//! Write all tables to a file, the previous file is replaced only when the new one is complete
+void saveSnapshot(const std::string& fileName, const std::vector<Table*>& tables);
+
+//! Read all tables from a file
+std::vector<Table*> loadSnapshot(const std::string& fileName);
+
+#endif
@@ -0,0 +1,88 @@
+#ifndef STATISTICS_HPP
+#define STATISTICS_HPP
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "field.hpp"
+#include "utilityhelper.hpp"
+
+/** HyperLogLog sketch
+ *  Estimates the number of distinct values in a fixed
+ *  amount of memory, values can be added but not removed
+ */
+class HyperLogLog {
+   private:
+    static const unsigned int REGISTER_BITS = 10;                   //!< Bits of the hash selecting a register
+    static const unsigned int REGISTERS = 1u << REGISTER_BITS;      //!< Number of registers
+    std::vector<unsigned char> registers = std::vector<unsigned char>(REGISTERS, 0);
+
+   public:
+    //! Add a hashed value to the sketch
+    void add(uint64_t valueHash);
+
+    //! Estimate the number of distinct values
+    double estimate() const;
+
+    //! Remove all values from the sketch
+    void clear();
+};
+
+/** Statistics of a single column
+ *  Row count, null count, distinct values and min/max are kept
+ *  up to date on every change, the equi-depth histogram and the
+ *  exact bounds are refreshed by ANALYZE
+ */
+class ColumnStatistics {
+   private:
+    static const unsigned int HISTOGRAM_BUCKETS = 16;  //!< Number of buckets in the equi-depth histogram
+
+    FieldType columnType = FieldType::UNDEFINED;
+    int rowCount = 0;                   //!< Number of values
+    int nullCount = 0;                  //!< Number of empty values
+    HyperLogLog distinctValues;         //!< Sketch of the distinct values
+    bool hasBounds = false;             //!< Flag if min and max are set
+    int minInt = 0, maxInt = 0;         //!< Bounds of INT and DATE values
+    std::string minString, maxString;   //!< Bounds of STRING values
+    std::vector<int> histogramBounds;   //!< Upper bounds of equally filled buckets of INT and DATE values
+    int histogramRows = 0;              //!< Number of values when the histogram was built
+    int modifiedRows = 0;               //!< Number of changes after the last ANALYZE
+
+    //! Hash a field value for the distinct values sketch
+    uint64_t hashValue(DataField* value) const;
+
+    //! Estimate the fraction of values lower than or equal to a key
+    double fractionAtMost(double key) const;
+
+   public:
+    ColumnStatistics(FieldType columnType = FieldType::UNDEFINED) : columnType(columnType) {}
+
+    //! Account a new value
+    void add(DataField* value);
+
+    //! Account a removed value
+    void remove(DataField* value);
+
+    //! Rebuild all statistics from all values of the column
+    void analyze(const std::vector<DataField*>& values);
+
+    //! Reset to an empty column
+    void clear();
+
+    //! Get the number of values
+    int getRowCount() const { return rowCount; }
+
+    //! Estimate the number of distinct values
+    int getDistinctCount() const;
+
+    //! Estimate the fraction of values satisfying a comparison with an INT or DATE key
+    double selectivity(OperatorType operatorCompare, int key) const;
+
+    //! Return the statistics as a string
+    std::string statisticsInfo() const;
+};
+
+#endif
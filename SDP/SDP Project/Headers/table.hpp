@@ -1,21 +1,44 @@
 #ifndef TABLE_HPP
 #define TABLE_HPP
 
+#include <algorithm>
+#include <atomic>
+#include <climits>
+#include <cstdint>
+#include <functional>
 #include <iostream>
 #include <list>
 #include <queue>
 #include <stack>
 #include <string>
+#include <unordered_map>
+#include <unordered_set>
 #include <vector>
 
+#include "aggregate.hpp"
 #include "avltree.hpp"
+#include "bplustree.hpp"
+#include "compression.hpp"
 #include "field.hpp"
+#include "profiler.hpp"
 #include "record.hpp"
+#include "recordindex.hpp"
+#include "statistics.hpp"
+#include "tableobserver.hpp"
 #include "utilityhelper.hpp"
+#include "zonemap.hpp"
 
 /** Table class
- *  The table has a linked list of all records.
+ *  The table has an array of all records addressed by row id.
  *  Each record has pointers to the single data value.
+ *  Removed records stay as tombstones until the table is vacuumed.
+ *  The rows are split into blocks with a summary of each column.
+ *  The files store the INT and DATE values of each block compressed,
+ *  in memory the records keep a field for each value.
+ *  Selections pass row ids between their stages, the records are read
+ *  only by the conditions, the sort keys and the final selected columns.
+ *  During a transaction every change of the records is kept in an undo log,
+ *  committing only clears the log, a rollback undoes the changes in reverse order.
  */
 class Table {
    private:
@@ -26,46 +49,128 @@ class Table {
         bool fieldNotNull = false;      //!< Flag value if the data could be empty
         bool fieldIsIndex = false;      //!< Flag value if the field should be indexed
         std::string fieldDefault = "";  //!< Default value for the field
+        IndexType fieldIndexType = IndexType::AVL;  //!< Structure of the index of the field
 
-        TableFieldData(std::string fieldName, FieldType fieldType, bool fieldNotNull, bool fieldIsIndex, std::string fieldDefault)
-            : fieldName(fieldName), fieldType(fieldType), fieldNotNull(fieldNotNull), fieldIsIndex(fieldIsIndex), fieldDefault(fieldDefault) {}
+        TableFieldData(std::string fieldName, FieldType fieldType, bool fieldNotNull, bool fieldIsIndex, std::string fieldDefault, IndexType fieldIndexType)
+            : fieldName(fieldName), fieldType(fieldType), fieldNotNull(fieldNotNull), fieldIsIndex(fieldIsIndex), fieldDefault(fieldDefault), fieldIndexType(fieldIndexType) {}
     };
 
     //! Storage for indexed columns
     struct IndexedColumn {
-        int columnIndex;            //!< Index of the order in the table
-        AVLTree* indexedStructure;  //!< AVL Tree structure for indexing
+        int columnIndex;                //!< Index of the order in the table
+        RecordIndex* indexedStructure;  //!< AVL tree or B+ tree structure for indexing
 
-        IndexedColumn(int columnIndex, FieldType type)
+        IndexedColumn(int columnIndex, FieldType type, IndexType indexType)
             : columnIndex(columnIndex) {
-            indexedStructure = new AVLTree(columnIndex, type);
+            indexedStructure = createRecordIndex(columnIndex, type, indexType);
         }
 
         ~IndexedColumn() {
-            indexedStructure->~AVLTree();
+            delete indexedStructure;
         }
     };
 
+    //! Kind of a change kept in the undo log
+    enum class UndoType {
+        INSERTED,  //!< Records appended to the storage
+        REMOVED,   //!< Record left as a tombstone
+        UPDATED    //!< Fields changed in place
+    };
+
+    //! Change of the records kept in the undo log of a transaction
+    struct UndoEntry {
+        UndoType undoType;
+        unsigned int rowId;         //!< Row id of the changed record, the first one for appended records
+        unsigned int rowCount = 1;  //!< Number of consecutive appended records
+        std::vector<std::pair<int, DataField*>> oldValues;  //!< Changed columns with copies of their values before UPDATE
+    };
+
+    static const unsigned int JOIN_PARTITION_ROWS = 4096;  //!< Target number of build records in a join partition
+    static constexpr double INDEX_SELECTIVITY_LIMIT = 0.2;  //!< Maximal estimated selectivity of an index range scan
+    static constexpr double HASH_JOIN_COST = 3.0;           //!< Cost of hashing a record relative to an index step
+
     std::string tableName;                       //!< Name of the table
     std::vector<TableFieldData*> tableFields;    //!< Blueprint of the table
-    std::list<Record*> records;                  //!< Collection of all records
+    std::unordered_map<std::string, int> fieldIndexes;  //!< Order index of each field by name
+    std::vector<Record*> records;                //!< Collection of all records, addressed by row id
+    std::vector<bool> recordValid;               //!< Row validity bitmap, false for removed records
+    unsigned int removedRecords = 0;             //!< Number of removed records waiting for VACUUM
     std::vector<IndexedColumn*> indexedColumns;  //!< Collection of all indexed fields
+    std::vector<ColumnStatistics> columnStatistics;  //!< Statistics of each field
+    std::vector<std::vector<BlockSummary>> blockSummaries;  //!< Summary of each field for each block of rows
+    std::vector<TableObserver*> observers;       //!< Views notified of every change of the records
+    std::vector<UndoEntry> undoLog;              //!< Changes of the running transaction in their order
+    bool flagLogging = false;                    //!< Flag if the changes are kept in the undo log
     bool savedAsFile = false;                    //!< Flag if the table is now stored as file
+    unsigned long long tableVersion;             //!< Version of the data, changed on every modification
+    mutable unsigned long long memoryVersion = 0;  //!< Version of the data when the memory was measured
+    mutable size_t measuredMemory = 0;             //!< Memory of the whole table at the measured version
+    static std::atomic<unsigned long long> versionCounter;  //!< Last version given to any table, tables may be loaded in parallel
+
+    //! Give the table a new version
+    void changeVersion() { tableVersion = ++versionCounter; }
+
+    //! Take a valid record out of the indexes, the statistics and the views, leaving a tombstone
+    void removeRecord(Record* removedRecord);
+
+    //! Undo a single change of the undo log
+    void undoChange(UndoEntry& undoEntry);
+
+    //! Release the copied values of the undo log and clear it
+    void clearUndoLog();
+
+    //! Encode the valid values of an INT or DATE column in blocks of rows, each block is given to the sink
+    void encodeColumn(unsigned int columnIndex, const std::function<void(const CompressedBlock&)>& blockSink) const;
 
    public:
+    //! A comparison of a column with a literal, NOT of the previous result, or AND / OR of the two previous results
+    struct CompiledCondition {
+        OperatorType operatorType = OperatorType::UNDEF;  //!< Comparison, NOT, AND or OR
+        int columnIndex = -1;                             //!< Compared column, -1 for NOT, AND and OR
+        FieldType fieldType = FieldType::UNDEFINED;       //!< Type of the compared column
+        int intKey = 0;                                   //!< INT literal or day number of a DATE literal
+        std::string stringKey;                            //!< Literal as text, compared with STRING and negative INT values
+    };
+
     Table(std::string tableNameInput)
-        : tableName(tableNameInput) {}
+        : tableName(tableNameInput) { changeVersion(); }
 
     ~Table() {
+        std::vector<TableObserver*> notifiedObservers(observers);  // An observer may stop observing when notified
+        for (unsigned int i = 0; i < notifiedObservers.size(); ++i) notifiedObservers[i]->tableDeleted(this);
         clearTable();
     }
 
+    //! Notify an observer of every change of the records
+    void addObserver(TableObserver* observer);
+
+    //! Stop notifying an observer
+    void removeObserver(TableObserver* observer);
+
     //! Get field name
     std::string fieldName(int indexField);
 
+    //! Get field type
+    FieldType getFieldType(int indexField) const;
+
     //! Get tablesize data in bytes
     int tableSizeBytes() const;
 
+    //! Get the size of the INT and DATE values as compressed blocks of the file in bytes
+    int compressedSizeBytes() const;
+
+    //! Get the memory used by the records and their fields in bytes
+    size_t recordsMemoryBytes() const;
+
+    //! Get the memory used by the block summaries in bytes
+    size_t blocksMemoryBytes() const;
+
+    //! Get the memory used by the whole table in bytes, measured again only after a change
+    size_t memoryBytes() const;
+
+    //! Return the memory of the records, each index and the blocks as a string
+    std::string memoryInfo() const;
+
     //! Clear all data from the table
     void clearTable();
 
@@ -81,6 +186,12 @@ class Table {
     //! Get the number of records - rows
     int getTableNumberOfRecords() const;
 
+    //! Get the number of removed records waiting for VACUUM
+    int getTableRemovedRecords() const;
+
+    //! Get the version of the data, unique among all tables
+    unsigned long long getTableVersion() const;
+
     //! Set the table as "saved in a file"
     void setSaved();
 
@@ -93,6 +204,18 @@ class Table {
     //! Return the table info as a string
     std::string tableInfo() const;
 
+    //! Return the column statistics as a string
+    std::string statisticsInfo() const;
+
+    //! Rebuild the statistics of all columns
+    void analyzeTable();
+
+    //! Decide from the statistics if an index scan is cheaper than a full scan, STRING indexes serve equality, ranges and LIKE prefixes
+    bool useIndex(int columnIndex, OperatorType operatorCompare, const std::string& value) const;
+
+    //! Create an empty table with the same name and fields
+    Table* emptyCopy() const;
+
     //! Return the table structure as a command
     std::string tableDefinition() const;
 
@@ -100,18 +223,42 @@ class Table {
     std::string recordDefinition() const;
 
     //! Add field to the structure of the table
-    void addField(std::string const& fieldName, FieldType fieldType, bool fieldNotNull = false, bool fieldIsIndex = false, std::string fieldDefault = "") {
-        tableFields.push_back(new TableFieldData(fieldName, fieldType, fieldNotNull, fieldIsIndex, fieldDefault));
+    void addField(std::string const& fieldName, FieldType fieldType, bool fieldNotNull = false, bool fieldIsIndex = false, std::string fieldDefault = "", IndexType indexType = IndexType::AVL) {
+        tableFields.push_back(new TableFieldData(fieldName, fieldType, fieldNotNull, fieldIsIndex, fieldDefault, indexType));
+        fieldIndexes.emplace(fieldName, tableFields.size() - 1);  // A repeated name keeps the first field
+        columnStatistics.push_back(ColumnStatistics(fieldType));
+        changeVersion();
         if (fieldIsIndex) {  // Create an indexed structure
             int columnIndex = tableFields.size();
             indexedColumns.resize(columnIndex);
-            indexedColumns[columnIndex - 1] = new IndexedColumn((columnIndex - 1), fieldType);
+            indexedColumns[columnIndex - 1] = new IndexedColumn((columnIndex - 1), fieldType, indexType);
         }
     }
 
     //! Add record to the table
     void addRecord(std::vector<std::string> recordValuesInput);
 
+    //! Add a batch of records, either all records are added or none
+    void addRecords(const std::vector<std::vector<std::string>>& recordsValuesInput);
+
+    //! Append complete records and insert them in the indexes with a single sorted insert for each index
+    void appendRecords(const std::vector<Record*>& newRecords);
+
+    //! Append the structure and the valid records in binary form, column by column, a full buffer of flushBytes is given to flushBuffer
+    void writeSnapshot(std::string& buffer, const std::function<void(std::string&)>& flushBuffer = nullptr, size_t flushBytes = 0) const;
+
+    //! Create a table from its binary form, the position is moved after it
+    static Table* readSnapshot(const char*& position, const char* end);
+
+    //! Create a typed field for a column from an input value
+    DataField* createField(int columnIndex, const std::string& valueInput) const;
+
+    //! Verify if two fields of the same type have equal values
+    bool equalFields(DataField* field1, DataField* field2) const;
+
+    //! Append a record to the storage and give it a row id
+    void appendRecord(Record* newRecord);
+
     //! Get the order index of a field by its name
     int getFieldIndexByName(const std::string& selectedColumn) const;
 
@@ -124,28 +271,115 @@ class Table {
     //! Transform the conditions in reverse polish notation using sunting-yard algorithm
     std::queue<std::string> transformConditions(std::vector<std::string> whereConditions);
 
-    //! Select all records using WHERE conditions
-    std::list<Record*> selectRecordsWhere(std::vector<std::string> whereConditions);
+    //! Resolve the conditions in reverse polish notation once into column indexes and parsed literals, false if only isInSelection can evaluate them
+    bool compileConditions(std::queue<std::string> operands, std::vector<CompiledCondition>& compiledConditions) const;
+
+    //! Verify if a record satisfies compiled conditions, the results are a stack reused between records
+    bool matchesConditions(Record* currentRecord, const std::vector<CompiledCondition>& compiledConditions, std::vector<unsigned char>& results) const;
+
+    //! Get a record by its row id
+    Record* getRecord(unsigned int rowId) const { return records[rowId]; }
+
+    //! Select the row ids of all records using WHERE conditions, stopping after maxRecords records if not negative
+    std::vector<unsigned int> selectRowIdsWhere(const std::vector<std::string>& whereConditions, int maxRecords = -1, QueryProfiler* profiler = nullptr);
+
+    //! Select all records using WHERE conditions, stopping after maxRecords records if not negative
+    std::list<Record*> selectRecordsWhere(std::vector<std::string> whereConditions, int maxRecords = -1, QueryProfiler* profiler = nullptr);
 
-    //! Verify if a record is distinct
-    bool isDistinctSelection(Record* currentRecord, std::list<Record*> alreadySelected, std::vector<int> columnsIndex);
+    //! Parse a literal as an integer key of an INT or DATE column
+    bool parseKey(int columnIndex, const std::string& value, int& key) const;
 
-    //! Reduce only the distinct records based on selected columns
-    std::list<Record*> selectRecordsDistinct(std::list<Record*> selectedRecords, std::vector<std::string> distinctColumns);
+    //! Recognise a range condition over a single INT or DATE column
+    bool rangeCondition(const std::vector<std::string>& whereConditions, int& columnIndex, int& lowValue, int& highValue) const;
 
-    //! Selection - main function
+    //! Mark the blocks of rows that could contain records satisfying the WHERE conditions
+    std::vector<bool> candidateBlocks(const std::vector<std::string>& whereConditions) const;
+
+    //! Rebuild the block summaries of all rows
+    void rebuildBlockSummaries();
+
+    //! Select the row ids of all records with a key in the inclusive range, stopping after maxRecords records if not negative
+    std::vector<unsigned int> selectRowIdsRange(int columnIndex, int lowValue, int highValue, int maxRecords = -1);
+
+    //! Keep only the row ids of the distinct records based on selected columns, stopping after maxRecords records if not negative
+    void distinctRowIds(std::vector<unsigned int>& rowIds, const std::vector<std::string>& distinctColumns, int maxRecords = -1) const;
+
+    //! Keep limitRecords row ids after skipping offsetRecords, a negative limit keeps all
+    void limitSelection(std::vector<unsigned int>& rowIds, int limitRecords, int offsetRecords) const;
+
+    //! Selection - main function, the stages pass row ids and the profiler measures them if given
+    std::vector<unsigned int> selectRowIds(const std::vector<std::string>& distinctColumns,
+                                           const std::vector<std::string>& orderByColumns,
+                                           const std::vector<std::string>& whereParameters,
+                                           int limitRecords = -1,
+                                           int offsetRecords = 0,
+                                           QueryProfiler* profiler = nullptr);
+
+    //! Selection of the records of selectRowIds
     std::list<Record*> selectRecords(std::vector<std::string> distinctColumns,
                                      std::vector<std::string> orderByColumns,
-                                     std::vector<std::string> whereParameters);
+                                     std::vector<std::string> whereParameters,
+                                     int limitRecords = -1,
+                                     int offsetRecords = 0,
+                                     QueryProfiler* profiler = nullptr);
+
+    //! Build a hash key from the values of the selected columns
+    std::string recordKey(Record* currentRecord, const std::vector<int>& columnsIndex) const;
 
-    //! Remove selected records
+    //! Answer MIN, MAX and COUNT directly from the indexes, false if not possible
+    bool aggregateFromIndex(const std::vector<AggregateColumn>& aggregateColumns, std::vector<std::string>& resultRow);
+
+    //! Aggregation - main function, the first row is the header
+    std::vector<std::vector<std::string>> aggregateRecords(std::vector<std::string> selectedColumns,
+                                                           std::vector<std::string> groupByColumns,
+                                                           std::vector<std::string> whereParameters);
+
+    //! Join with another table on equal column values into a new table with qualified field names
+    Table* joinTables(Table* otherTable, int columnIndex, int otherColumnIndex);
+
+    //! Hash join with radix partitioning of large build sides
+    void hashJoin(const std::list<Record*>& buildRecords, int buildColumn,
+                  const std::list<Record*>& probeRecords, int probeColumn,
+                  bool buildIsLeft, Table* joinedTable) const;
+
+    //! Add a record made of copies of the fields of two joined records
+    void addJoinedRecord(Record* leftRecord, Record* rightRecord);
+
+    //! Remove selected records, leaving tombstones
     void removeRecords(std::vector<std::string> whereParameters);
 
+    //! Update fields of the selected records in place, return the number of updated records
+    int updateRecords(std::vector<std::string> setColumns, std::vector<std::string> setValues, std::vector<std::string> whereParameters);
+
+    //! Compact the storage by dropping the tombstones and rebuild the indexes, not allowed while the changes are logged
+    void vacuumTable();
+
+    //! Keep every change of the records in the undo log until commitLog or rollbackLog
+    void beginLogging();
+
+    //! Return if the changes are kept in the undo log
+    bool getLogging() const;
+
+    //! Keep the logged changes and stop logging, the tombstones are compacted if they are the most records
+    void commitLog();
+
+    //! Undo the logged changes in reverse order and stop logging, appended records are dropped from the storage
+    void rollbackLog();
+
     //! Record comparator
     bool compareRecords(Record* record1, Record* record2, int columnIndex);
 
-    //! Sort list of records
-    std::list<Record*> sortRecordsWhere(std::list<Record*>& selectedRecords, int columnIndex);
+    //! Get the order indexes of the known ORDERBY columns
+    std::vector<int> orderColumnsIndex(const std::vector<std::string>& orderByColumns) const;
+
+    //! Sort row ids in ORDERBY order, equal records keep their order, the keys of a single column are read once
+    void sortRowIds(std::vector<unsigned int>& rowIds, const std::vector<int>& columnsIndex);
+
+    //! Record comparator for ORDERBY, the last column is the primary one as after consecutive sorts
+    bool compareRecordsOrder(Record* record1, Record* record2, const std::vector<int>& columnsIndex);
+
+    //! Keep the row ids of the first countRecords records in ORDERBY order with a bounded heap
+    void topRowIds(std::vector<unsigned int>& rowIds, const std::vector<int>& columnsIndex, int countRecords);
 };
 
 #endif
\ No newline at end of file
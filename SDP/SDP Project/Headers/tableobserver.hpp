@@ -0,0 +1,30 @@
+#ifndef TABLEOBSERVER_HPP
+#define TABLEOBSERVER_HPP
+
+#include "record.hpp"
+
+class Table;
+
+/** Observer of the changes of a table
+ *  The table reports every added and removed record,
+ *  so structures derived from its records are kept up to date
+ *  without scanning the table again.
+ */
+class TableObserver {
+   public:
+    virtual ~TableObserver() {}
+
+    //! A record was added, or changed by UPDATE after its old values were removed
+    virtual void recordAdded(Table* observedTable, Record* addedRecord) = 0;
+
+    //! A record is about to be removed, or changed by UPDATE, its values are still the old ones
+    virtual void recordRemoved(Table* observedTable, Record* removedRecord) = 0;
+
+    //! The records got new row ids after VACUUM
+    virtual void recordsRenumbered(Table* observedTable) = 0;
+
+    //! The table is deleted and no longer observed
+    virtual void tableDeleted(Table* observedTable) = 0;
+};
+
+#endif
@@ -2,6 +2,8 @@
 #ifndef UTILITYHELPER_HPP
 #define UTILITYHELPER_HPP
 
+#include <algorithm>
+#include <cstddef>
 #include <string>
 
 //! Enum of all operators
@@ -14,20 +16,21 @@ enum class OperatorType {
     LT = 4,
     GE = 5,
     LE = 6,
+    LIKE = 7,
     // Priority level 2
-    NOT = 7,
+    NOT = 8,
     // Priority level 3
-    AND = 8,
+    AND = 9,
     // Priority level 4
-    OR = 9,
+    OR = 10,
     COUNTOPERATORTYPE
 };
 
 //! List of all operators and their names
-const char OperatorTypeList[(int)(OperatorType::COUNTOPERATORTYPE)][6] = {"UNDEF", "=", "!=", ">", "<", ">=", "<=", "NOT", "AND", "OR"};
+const char OperatorTypeList[(int)(OperatorType::COUNTOPERATORTYPE)][6] = {"UNDEF", "=", "!=", ">", "<", ">=", "<=", "LIKE", "NOT", "AND", "OR"};
 
 //! List of all operators and their priority
-const int OperatorTypePriorityList[(int)(OperatorType::COUNTOPERATORTYPE)] = {0, 1, 1, 1, 1, 1, 1, 2, 3, 4};
+const int OperatorTypePriorityList[(int)(OperatorType::COUNTOPERATORTYPE)] = {0, 1, 1, 1, 1, 1, 1, 1, 2, 3, 4};
 
 //! Get operator by its name
 int getOperator(const std::string& singleOperator);
@@ -44,6 +47,27 @@ bool isString(const std::string& strStr);
 //! Verify if a string is a date value
 bool isDate(const std::string& datStr);
 
+//! Parse a date string DD/MM/YYYY into a day number since 01/01/1970
+bool parseDate(const std::string& datStr, int& dayNumber);
+
+//! Format a day number since 01/01/1970 as a date string DD/MM/YYYY
+std::string formatDate(int dayNumber);
+
+//! Compare two integer values with a comparison operator
+bool compareIntegers(int value1, int value2, OperatorType operatorCompare);
+
+//! Get the comparison operator that gives the same result with the operands swapped
+OperatorType mirrorOperator(OperatorType operatorCompare);
+
+//! Compare two strings with a comparison operator
+bool compareStrings(const std::string& value1, const std::string& value2, OperatorType operatorCompare);
+
+//! Match a value with a LIKE pattern, % matches any characters and _ a single character
+bool matchLike(const std::string& value, const std::string& pattern);
+
+//! Get the characters of a LIKE pattern before its first wildcard
+std::string likePrefix(const std::string& pattern);
+
 //! Verify if a string is a boolean starting with #
 bool isTrueOrFalse(const std::string& boolStr);
 
@@ -59,4 +83,22 @@ bool datumPiece(char c);
 //! Make string uppercase
 std::string toUpperString(std::string lowerCaseString);
 
+//! Append an unsigned number as little-endian bytes
+void writeBinary(std::string& buffer, unsigned long long value, unsigned int bytes);
+
+//! Append a string with its length
+void writeBinaryText(std::string& buffer, const std::string& text);
+
+//! Read an unsigned number of little-endian bytes, false if the data ends first
+bool readBinary(const char*& position, const char* end, unsigned long long& value, unsigned int bytes);
+
+//! Read a string with its length, false if the data ends first
+bool readBinaryText(const char*& position, const char* end, std::string& text);
+
+//! Get the bytes of a heap allocation, with the bookkeeping and rounding of the allocator
+size_t allocationBytes(size_t size);
+
+//! Get the heap bytes of a string of a length, short strings are stored inside the object
+size_t textHeapBytes(size_t length);
+
 #endif
\ No newline at end of file
@@ -0,0 +1,117 @@
+#ifndef VIEW_HPP
+#define VIEW_HPP
+
+#include <map>
+#include <queue>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "aggregate.hpp"
+#include "record.hpp"
+#include "table.hpp"
+#include "tableobserver.hpp"
+
+/** Materialized view over a single table
+ *  The result of a selection is stored and updated from every
+ *  added and removed record of its table, so reading the view
+ *  takes the time of its result instead of a scan of the table.
+ *  A filtered view keeps the selected values of each matching record by row id.
+ *  An aggregated view keeps the running aggregates of each group,
+ *  MIN and MAX count every value, so a removed extreme is replaced.
+ *  The groups keep the order of their creation.
+ */
+class MaterializedView : public TableObserver {
+   private:
+    //! Running aggregate of a single column of a group
+    struct GroupAggregate {
+        long long sum = 0;                        //!< Sum of the INT values, SUM and AVG only
+        std::map<int, int> intCounts;             //!< Number of records of each INT or DATE value, MIN and MAX only
+        std::map<std::string, int> stringCounts;  //!< Number of records of each STRING value, MIN and MAX only
+    };
+
+    //! Running aggregates of the records of a group
+    struct ViewGroup {
+        std::string groupKey;                    //!< Key of the GROUPBY values
+        std::vector<std::string> groupValues;    //!< Values of the GROUPBY columns, empty for aggregates
+        long long recordsCount = 0;              //!< Number of records in the group, 0 for a removed group
+        std::vector<GroupAggregate> aggregates;  //!< Aggregate of each selected column
+    };
+
+    std::string viewName;                         //!< Name of the view
+    std::string tableName;                        //!< Name of the observed table
+    Table* baseTable = nullptr;                   //!< Observed table, nullptr while it is replaced
+    std::vector<std::string> headerRow;           //!< Names of the columns of the view
+    std::vector<std::string> whereParameters;     //!< WHERE conditions of the definition
+    std::queue<std::string> whereOperands;        //!< WHERE conditions in reverse polish notation
+    std::vector<Table::CompiledCondition> compiledConditions;  //!< WHERE conditions resolved in the observed table
+    bool flagCompiled = false;                    //!< Flag if the compiled conditions are used
+    std::vector<unsigned char> conditionResults;  //!< Stack of the compiled conditions, reused between records
+    bool flagAggregate = false;                   //!< Flag if the view has aggregates or GROUPBY
+
+    std::vector<int> columnsIndex;  //!< Selected columns of a filtered view
+    std::map<unsigned int, std::vector<std::string>> filteredRows;  //!< Selected values of each matching record by row id
+
+    std::vector<int> groupColumnsIndex;                     //!< GROUPBY columns of an aggregated view
+    std::vector<AggregateColumn> aggregateColumns;          //!< Selected columns of an aggregated view
+    std::vector<FieldType> aggregateTypes;                  //!< Type of the aggregated column of each selected column
+    std::vector<ViewGroup> groups;                          //!< Groups in the order of their creation
+    std::unordered_map<std::string, unsigned int> groupsByKey;  //!< Position of each group with records
+    unsigned int removedGroups = 0;                         //!< Number of groups left without records
+
+    //! Verify if a record satisfies the WHERE conditions
+    bool isInView(Record* currentRecord);
+
+    //! Add a record satisfying the conditions to the result
+    void addToView(Record* currentRecord);
+
+    //! Remove a record satisfying the conditions from the result
+    void removeFromView(Record* currentRecord);
+
+    //! Drop the groups without records, the other groups keep their order
+    void compactGroups();
+
+    //! Build the result again from all records of the table
+    void refreshView();
+
+   public:
+    //! Define a view of SELECT <selectedColumns> FROM <table> WHERE <whereParameters> GROUPBY <groupByColumns> and fill it
+    MaterializedView(std::string viewName, Table* observedTable, std::vector<std::string> selectedColumns,
+                     std::vector<std::string> groupByColumns, std::vector<std::string> whereParameters);
+
+    ~MaterializedView() override {
+        detachTable();
+    }
+
+    //! Observe a table and build the result from its records
+    void attachTable(Table* observedTable);
+
+    //! Stop observing the table
+    void detachTable();
+
+    //! Get the name of the view
+    std::string getViewName() const { return viewName; }
+
+    //! Get the name of the observed table
+    std::string getTableName() const { return tableName; }
+
+    //! Get the number of rows of the view
+    int countRows() const;
+
+    //! Get the rows of the view, the first row is the header
+    std::vector<std::vector<std::string>> viewRows() const;
+
+    //! Add a new or updated record to the result if it satisfies the conditions
+    void recordAdded(Table* observedTable, Record* addedRecord) override;
+
+    //! Remove a record from the result if it satisfied the conditions
+    void recordRemoved(Table* observedTable, Record* removedRecord) override;
+
+    //! Build the result again, the filtered rows are addressed by row id
+    void recordsRenumbered(Table* observedTable) override;
+
+    //! Keep the result until the view observes the table that replaces the deleted one
+    void tableDeleted(Table* observedTable) override;
+};
+
+#endif
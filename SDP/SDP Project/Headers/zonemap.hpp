@@ -0,0 +1,37 @@
+#ifndef ZONEMAP_HPP
+#define ZONEMAP_HPP
+
+#include <string>
+
+#include "field.hpp"
+#include "utilityhelper.hpp"
+
+const unsigned int BLOCK_ROWS = 1024;  //!< Number of rows in a storage block
+
+/** Summary of a column in a block of rows
+ *  Keeps the bounds and the number of empty values,
+ *  so a scan can skip blocks that cannot match a condition.
+ *  The bounds only grow, removed values keep them wider.
+ */
+class BlockSummary {
+   private:
+    bool hasValues = false;            //!< Flag if any value was added
+    int minInt = 0, maxInt = 0;        //!< Bounds of INT and DATE values
+    std::string minString, maxString;  //!< Bounds of STRING values
+    int nullCount = 0;                 //!< Number of empty values
+
+   public:
+    //! Widen the bounds with a value
+    void add(DataField* value);
+
+    //! Get the number of empty values
+    int getNullCount() const { return nullCount; }
+
+    //! Verify if an INT or DATE value in the block could satisfy the comparison
+    bool maySatisfy(OperatorType operatorCompare, int key) const;
+
+    //! Verify if a STRING value in the block could satisfy the comparison
+    bool maySatisfy(OperatorType operatorCompare, const std::string& key) const;
+};
+
+#endif
@@ -0,0 +1,56 @@
+#include "../Headers/aggregate.hpp"
+
+bool parseAggregate(const std::string& expression, AggregateType& aggregateType, std::string& columnName) {
+    size_t openBracket = expression.find('(');
+    if (openBracket == std::string::npos || expression.back() != ')') return false;
+
+    std::string functionName = toUpperString(expression.substr(0, openBracket));
+    for (unsigned int i = 1; i < (int)(AggregateType::COUNTAGGREGATETYPE); ++i) {
+        if (functionName == AggregateTypeList[i]) {
+            aggregateType = (AggregateType)i;
+            columnName = expression.substr(openBracket + 1, expression.size() - openBracket - 2);
+            return !columnName.empty();
+        }
+    }
+    return false;
+}
+
+void AggregateState::add(DataField* value) {
+    ++count;
+    if (value == nullptr) return;
+
+    valueType = value->getType();
+    if (valueType == FieldType::STRING) {
+        std::string currentValue = value->getValueString();
+        if (count == 1 || currentValue < minString) minString = currentValue;
+        if (count == 1 || currentValue > maxString) maxString = currentValue;
+    } else {
+        int currentValue = value->getValueInt();
+        sum += currentValue;
+        if (count == 1 || currentValue < minInt) minInt = currentValue;
+        if (count == 1 || currentValue > maxInt) maxInt = currentValue;
+    }
+}
+
+std::string AggregateState::result(AggregateType aggregateType) const {
+    if (aggregateType == AggregateType::COUNT) return std::to_string(count);
+    if (count == 0) return "";  // No values to aggregate
+
+    switch (aggregateType) {
+        case AggregateType::SUM:
+            return std::to_string(sum);
+        case AggregateType::AVG: {
+            std::ostringstream average;
+            average << (double)sum / count;
+            return average.str();
+        }
+        case AggregateType::MIN:
+            if (valueType == FieldType::STRING) return minString;
+            return (valueType == FieldType::DATE) ? formatDate(minInt) : std::to_string(minInt);
+        case AggregateType::MAX:
+            if (valueType == FieldType::STRING) return maxString;
+            return (valueType == FieldType::DATE) ? formatDate(maxInt) : std::to_string(maxInt);
+        default:
+            return "";
+    }
+}
@@ -9,31 +9,19 @@ void AVLTree::clearTree(RecordNode* root) {
 }
 
 int AVLTree::compareTreeNodeAndRecord(RecordNode* value1, Record* value2) {
-    if (dataType == FieldType::INT) {
-        int value1int = 0, value2int = 0;
-        value1int = stoi(value1->records.front()->getData(columnIndex)->getValueUniform());
-        value2int = stoi(value2->getData(columnIndex)->getValueUniform());
-        if (value1int == value2int) {
-            return 0;
-        } else {
-            if (value1int < value2int)
-                return -1;
-            else
-                return 1;
-        }
+    return compareRecordKeys(value1->records.front(), value2);
+}
+
+int AVLTree::compareRecordKeys(Record* value1, Record* value2) const {
+    if (dataType == FieldType::INT || dataType == FieldType::DATE) {  // Dates are ordered by their day numbers
+        int value1int = value1->getData(columnIndex)->getValueInt();
+        int value2int = value2->getData(columnIndex)->getValueInt();
+        if (value1int == value2int) return 0;
+        return (value1int < value2int) ? -1 : 1;
     } else {
-        std::string value1int, value2int;
-        value1int = value1->records.front()->getData(columnIndex)->getValueUniform();
-        value2int = value2->getData(columnIndex)->getValueUniform();
-        (value1int.compare(value2int) > 1);
-        if (value1int.compare(value2int) == 0) {
-            return 0;
-        } else {
-            if (value1int.compare(value2int) > 0)
-                return -1;
-            else
-                return 1;
-        }
+        int compareResult = value1->getData(columnIndex)->getValueUniform().compare(value2->getData(columnIndex)->getValueUniform());
+        if (compareResult == 0) return 0;
+        return (compareResult < 0) ? -1 : 1;
     }
 }
 
@@ -86,39 +74,23 @@ int AVLTree::balanceFactor(RecordNode* root) const {
 
 void AVLTree::insert(Record* value) {
     insertNode(avlRoot, value);
+    ++recordsCount;
 }
 
 void AVLTree::insertNode(RecordNode*& root, Record* value) {
     if (root == nullptr) {
         root = new RecordNode(value);
     } else {
-        if (compareTreeNodeAndRecord(root, value) == 1) insertNode(root->leftNode, value);
-        if (compareTreeNodeAndRecord(root, value) == -1) insertNode(root->rightNode, value);
-        if (compareTreeNodeAndRecord(root, value) == 0) root->records.push_back(value);
-        // (compareTreeNodeAndRecord(root, value) ==  1)  (root->value > value)
-        // (compareTreeNodeAndRecord(root, value) == -1)  (root->value < value)
-    }
-
-    root->heightOfSubtree = recalculateHeight(root);
-
-    if (balanceFactor(root) < -1) {
-        if (root->leftNode != nullptr && (compareTreeNodeAndRecord(root->leftNode, value) == 1)) {
-            rotateRight(root);
-        }
-        if (root->leftNode != nullptr && (compareTreeNodeAndRecord(root->leftNode, value) == -1)) {
-            rotateLeft(root->leftNode);
-            rotateRight(root);
-        }
-    }
-    if (balanceFactor(root) > 1) {
-        if (root->rightNode != nullptr && (compareTreeNodeAndRecord(root->rightNode, value) == -1)) {
-            rotateLeft(root);
-        }
-        if (root->rightNode != nullptr && (compareTreeNodeAndRecord(root->rightNode, value) == 1)) {
-            rotateRight(root->rightNode);
-            rotateLeft(root);
+        int compareResult = compareTreeNodeAndRecord(root, value);
+        if (compareResult == 1) insertNode(root->leftNode, value);    // (root->value > value)
+        if (compareResult == -1) insertNode(root->rightNode, value);  // (root->value < value)
+        if (compareResult == 0) {
+            root->records.push_back(value);
+            return;  // Same key, the structure of the tree is not changed
         }
     }
+
+    rebalanceNode(root);
 }
 
 AVLTree::RecordNode* AVLTree::getMinNode(RecordNode* root) const {
@@ -128,137 +100,280 @@ AVLTree::RecordNode* AVLTree::getMinNode(RecordNode* root) const {
     return newRoot;
 }
 
-void AVLTree::removeData(Record* value) {
-    deleteNode(avlRoot, value);
+Record* AVLTree::getMinRecord() const {
+    if (avlRoot == nullptr) return nullptr;
+    return getMinNode(avlRoot)->records.front();
 }
 
-void AVLTree::deleteNode(RecordNode*& root, Record* value) {
-    if (!root) return;
+Record* AVLTree::getMaxRecord() const {
+    if (avlRoot == nullptr) return nullptr;
+    RecordNode* maxNode = avlRoot;
+    while (maxNode->rightNode != nullptr) maxNode = maxNode->rightNode;
+    return maxNode->records.front();
+}
 
-    if (compareTreeNodeAndRecord(root, value) == 0) {
-        RecordNode* nodeToDelete = root;
-        if (root->records.size() > 1) {
-            root->records.remove(value);
+int AVLTree::countRecords() const {
+    return recordsCount;
+}
+
+size_t AVLTree::memoryBytes() const {
+    return sizeof(AVLTree) + nodeBytes(avlRoot);
+}
+
+size_t AVLTree::nodeBytes(RecordNode* root) const {
+    if (root == nullptr) return 0;
+    size_t listNodeBytes = allocationBytes(2 * sizeof(void*) + sizeof(Record*));  // Links and value of a list node
+    return allocationBytes(sizeof(RecordNode)) + root->records.size() * listNodeBytes + nodeBytes(root->leftNode) + nodeBytes(root->rightNode);
+}
+
+void AVLTree::insertSorted(const std::vector<Record*>& sortedRecords) {
+    if (sortedRecords.size() * 4 < recordsCount) {  // Small batch, the sorted order keeps the insert paths in cache
+        for (unsigned int i = 0; i < sortedRecords.size(); ++i) insert(sortedRecords[i]);
+        return;
+    }
+
+    // Large batch, merge with the indexed records, equal keys keep the old records first
+    std::vector<Record*> indexedRecords, mergedRecords;
+    indexedRecords.reserve(recordsCount);
+    collectRecords(avlRoot, indexedRecords);
+    mergedRecords.reserve(indexedRecords.size() + sortedRecords.size());
+    std::merge(indexedRecords.begin(), indexedRecords.end(), sortedRecords.begin(), sortedRecords.end(), std::back_inserter(mergedRecords),
+               [this](Record* value1, Record* value2) { return compareRecordKeys(value1, value2) < 0; });
+
+    std::vector<RecordNode*> sortedNodes;
+    for (unsigned int i = 0; i < mergedRecords.size(); ++i) {
+        if (!sortedNodes.empty() && compareTreeNodeAndRecord(sortedNodes.back(), mergedRecords[i]) == 0) {
+            sortedNodes.back()->records.push_back(mergedRecords[i]);
         } else {
-            if (root->leftNode == nullptr && root->rightNode != nullptr) {
-                root = root->rightNode;
-            }
-            if (root->leftNode != nullptr && root->rightNode == nullptr) {
-                root = root->leftNode;
-            }
-            if (root->leftNode != nullptr && root->rightNode != nullptr) {
-                RecordNode* minNodeFromRight = getMinNode(root->rightNode);
-                minNodeFromRight->leftNode = root->leftNode;
-                minNodeFromRight->rightNode = root->rightNode;
-                root = minNodeFromRight;
-            }
-            if (root->leftNode == nullptr && root->rightNode == nullptr) {
-                root = nullptr;
-            }
-            delete nodeToDelete;
+            sortedNodes.push_back(new RecordNode(mergedRecords[i]));
         }
-        return;
-    } else {
-        if (compareTreeNodeAndRecord(root, value) == 1) deleteNode(root->leftNode, value);
-        if (compareTreeNodeAndRecord(root, value) == -1) deleteNode(root->rightNode, value);
     }
+    clearTree(avlRoot);
+    avlRoot = buildBalanced(sortedNodes, 0, (int)sortedNodes.size() - 1);
+    recordsCount = mergedRecords.size();
+}
 
-    if (!root) return;
+std::vector<Record*> AVLTree::orderedRecords() const {
+    std::vector<Record*> indexedRecords;
+    indexedRecords.reserve(recordsCount);
+    collectRecords(avlRoot, indexedRecords);
+    return indexedRecords;
+}
 
+void AVLTree::collectRecords(RecordNode* root, std::vector<Record*>& collectedRecords) const {
+    if (root == nullptr) return;
+    collectRecords(root->leftNode, collectedRecords);
+    collectedRecords.insert(collectedRecords.end(), root->records.begin(), root->records.end());
+    collectRecords(root->rightNode, collectedRecords);
+}
+
+AVLTree::RecordNode* AVLTree::buildBalanced(const std::vector<RecordNode*>& sortedNodes, int first, int last) {
+    if (first > last) return nullptr;
+    int middle = first + (last - first) / 2;
+    RecordNode* root = sortedNodes[middle];
+    root->leftNode = buildBalanced(sortedNodes, first, middle - 1);
+    root->rightNode = buildBalanced(sortedNodes, middle + 1, last);
+    root->heightOfSubtree = recalculateHeight(root);
+    return root;
+}
+
+void AVLTree::removeData(Record* value) {
+    deleteNode(avlRoot, value);
+}
+
+AVLTree::RecordNode* AVLTree::detachMinNode(RecordNode*& root) {
+    if (root->leftNode == nullptr) {
+        RecordNode* minNode = root;
+        root = root->rightNode;
+        return minNode;
+    }
+    RecordNode* minNode = detachMinNode(root->leftNode);
+    rebalanceNode(root);
+    return minNode;
+}
+
+void AVLTree::rebalanceNode(RecordNode*& root) {
     root->heightOfSubtree = recalculateHeight(root);
 
     if (balanceFactor(root) < -1) {
-        if (root->leftNode) {
-            if (balanceFactor(root->leftNode) >= 0) {
-                rotateRight(root);
-            } else {
-                rotateLeft(root->leftNode);
-                rotateRight(root);
-            }
+        if (balanceFactor(root->leftNode) <= 0) {
+            rotateRight(root);
+        } else {
+            rotateLeft(root->leftNode);
+            rotateRight(root);
+        }
+    } else if (balanceFactor(root) > 1) {
+        if (balanceFactor(root->rightNode) >= 0) {
+            rotateLeft(root);
+        } else {
+            rotateRight(root->rightNode);
+            rotateLeft(root);
         }
     }
-    if (balanceFactor(root) > 1) {
-        if (root->rightNode) {
-            if (balanceFactor(root->rightNode) >= 0) {
-                rotateLeft(root);
-            } else {
-                rotateRight(root->rightNode);
-                rotateLeft(root);
-            }
+}
+
+void AVLTree::deleteNode(RecordNode*& root, Record* value) {
+    if (!root) return;
+
+    int compareResult = compareTreeNodeAndRecord(root, value);
+    if (compareResult == 0) {
+        size_t nodeRecords = root->records.size();
+        root->records.remove(value);
+        recordsCount -= nodeRecords - root->records.size();
+        if (!root->records.empty()) return;  // Other records still have the key
+
+        RecordNode* nodeToDelete = root;
+        if (root->leftNode == nullptr) {
+            root = root->rightNode;
+        } else if (root->rightNode == nullptr) {
+            root = root->leftNode;
+        } else {  // The minimal node of the right subtree takes the place of the deleted node
+            RecordNode* minNodeFromRight = detachMinNode(root->rightNode);
+            minNodeFromRight->leftNode = root->leftNode;
+            minNodeFromRight->rightNode = root->rightNode;
+            root = minNodeFromRight;
         }
+        delete nodeToDelete;
+    } else if (compareResult == 1) {
+        deleteNode(root->leftNode, value);
+    } else {
+        deleteNode(root->rightNode, value);
     }
+
+    if (root) rebalanceNode(root);
 }
 
-std::list<Record*> AVLTree::searchNode(std::string value, OperatorType operatorCompare) {
+std::list<Record*> AVLTree::searchNode(std::string value, OperatorType operatorCompare, int maxRecords) {
     searchResult.clear();
+    searchLimit = maxRecords;
+    if (dataType == FieldType::INT) {
+        if (value.empty() || !isNumber(value)) return searchResult;
+        searchKey(stoi(value), operatorCompare);
+    } else if (dataType == FieldType::DATE) {
+        int searchingValue = 0;
+        if (!parseDate(value, searchingValue)) return searchResult;
+        searchKey(searchingValue, operatorCompare);
+    } else {
+        if (value.empty() || !isString(value)) return searchResult;
+        if (operatorCompare == OperatorType::LIKE) {
+            searchLike(value);
+        } else {
+            searchKey(value, operatorCompare);
+        }
+    }
+    if (maxRecords >= 0 && searchResult.size() > (size_t)maxRecords) searchResult.resize(maxRecords);
+    return searchResult;
+}
+
+void AVLTree::nodeKey(RecordNode* root, int& key) const {
+    key = root->records.front()->getData(columnIndex)->getValueInt();
+}
+
+void AVLTree::nodeKey(RecordNode* root, std::string& key) const {
+    key = root->records.front()->getData(columnIndex)->getValueUniform();
+}
+
+template <typename KeyType>
+void AVLTree::searchKey(const KeyType& value, OperatorType operatorCompare) {
     if (operatorCompare == OperatorType::EQ) {
         RecordNode* searchEqual = searchEqualNode(avlRoot, value);
-        return searchEqual->records;
+        if (searchEqual != nullptr) searchResult = searchEqual->records;
     } else {
         searchNodeCompare(avlRoot, value, operatorCompare);
     }
-    return searchResult;
 }
 
-AVLTree::RecordNode* AVLTree::searchEqualNode(RecordNode*& root, std::string value) {
-    if (root != nullptr) {
-        if (dataType == FieldType::INT) {
-            int currentValue = 0;
-            currentValue = stoi(root->records.front()->getData(columnIndex)->getValueUniform());  // IS NUMBER?
-            int searchingValueToInt = stoi(value);
-            if (currentValue == searchingValueToInt) {
-                return root;
-            } else if (currentValue < searchingValueToInt) {
-                return searchEqualNode(root->leftNode, value);
-            } else {
-                return searchEqualNode(root->rightNode, value);
-            }
-        }
+template <typename KeyType>
+AVLTree::RecordNode* AVLTree::searchEqualNode(RecordNode*& root, const KeyType& value) {
+    if (root == nullptr) return nullptr;
+    nodesVisited.fetch_add(1, std::memory_order_relaxed);
+    KeyType currentValue;
+    nodeKey(root, currentValue);
+    if (currentValue == value) {
+        return root;
+    } else if (currentValue < value) {
+        return searchEqualNode(root->rightNode, value);
     } else {
-        return nullptr;
+        return searchEqualNode(root->leftNode, value);
     }
 }
 
-AVLTree::RecordNode* AVLTree::searchNodeCompare(RecordNode*& root, std::string value, OperatorType operatorCompare) {
-    if (root != nullptr) {
-        if (dataType == FieldType::INT) {
-            int currentValue = 0;
-            currentValue = stoi(root->records.front()->getData(columnIndex)->getValueUniform());  // IS NUMBER?
-            int searchingValueToInt = stoi(value);
-            switch (operatorCompare) {
-                case OperatorType::GT:
-                    if (currentValue > searchingValueToInt && currentValue != searchingValueToInt) {
-                        searchResult.insert(searchResult.end(), root->records.begin(), root->records.end());
-                        searchNodeCompare(root->leftNode, value, operatorCompare);
-                    }
-                    searchNodeCompare(root->rightNode, value, operatorCompare);
-                    break;
-                case OperatorType::LT:
-                    if (currentValue < searchingValueToInt && currentValue != searchingValueToInt) {
-                        searchResult.insert(searchResult.end(), root->records.begin(), root->records.end());
-                        searchNodeCompare(root->rightNode, value, operatorCompare);
-                    }
-                    searchNodeCompare(root->leftNode, value, operatorCompare);
-                    break;
-                case OperatorType::GE:
-                    if (currentValue >= searchingValueToInt) {
-                        searchResult.insert(searchResult.end(), root->records.begin(), root->records.end());
-                        if (currentValue != searchingValueToInt) searchNodeCompare(root->leftNode, value, operatorCompare);
-                    }
-                    searchNodeCompare(root->rightNode, value, operatorCompare);
-                    break;
-                case OperatorType::LE:
-                    if (currentValue <= searchingValueToInt) {
-                        searchResult.insert(searchResult.end(), root->records.begin(), root->records.end());
-                        if (currentValue != searchingValueToInt) searchNodeCompare(root->rightNode, value, operatorCompare);
-                    }
-                    searchNodeCompare(root->leftNode, value, operatorCompare);
-                    break;
-                default:
-                    break;
+template <typename KeyType>
+void AVLTree::searchNodeCompare(RecordNode*& root, const KeyType& value, OperatorType operatorCompare) {
+    if (root == nullptr || (searchLimit >= 0 && searchResult.size() >= (size_t)searchLimit)) return;
+    nodesVisited.fetch_add(1, std::memory_order_relaxed);
+    KeyType currentValue;
+    nodeKey(root, currentValue);
+    switch (operatorCompare) {
+        case OperatorType::GT:
+            if (currentValue > value) {
+                searchResult.insert(searchResult.end(), root->records.begin(), root->records.end());
+                searchNodeCompare(root->leftNode, value, operatorCompare);
+            }
+            searchNodeCompare(root->rightNode, value, operatorCompare);
+            break;
+        case OperatorType::LT:
+            if (currentValue < value) {
+                searchResult.insert(searchResult.end(), root->records.begin(), root->records.end());
+                searchNodeCompare(root->rightNode, value, operatorCompare);
+            }
+            searchNodeCompare(root->leftNode, value, operatorCompare);
+            break;
+        case OperatorType::GE:
+            if (currentValue >= value) {
+                searchResult.insert(searchResult.end(), root->records.begin(), root->records.end());
+                if (currentValue != value) searchNodeCompare(root->leftNode, value, operatorCompare);
             }
+            searchNodeCompare(root->rightNode, value, operatorCompare);
+            break;
+        case OperatorType::LE:
+            if (currentValue <= value) {
+                searchResult.insert(searchResult.end(), root->records.begin(), root->records.end());
+                if (currentValue != value) searchNodeCompare(root->rightNode, value, operatorCompare);
+            }
+            searchNodeCompare(root->leftNode, value, operatorCompare);
+            break;
+        case OperatorType::NE:
+            if (currentValue != value) searchResult.insert(searchResult.end(), root->records.begin(), root->records.end());
+            searchNodeCompare(root->leftNode, value, operatorCompare);
+            searchNodeCompare(root->rightNode, value, operatorCompare);
+            break;
+        default:
+            break;
+    }
+}
+
+void AVLTree::searchLike(const std::string& pattern) {
+    // Every key with the prefix of the pattern is in the range [prefix, prefix with its last character increased)
+    std::string lowKey = likePrefix(pattern), highKey = lowKey;
+    while (!highKey.empty() && (unsigned char)highKey.back() == 0xFF) highKey.pop_back();
+    if (!highKey.empty()) ++highKey.back();
+
+    // Keys in the range of "abc%" always match, other patterns are checked after the search
+    bool flagPrefixOnly = (pattern.size() == lowKey.size() + 2 && pattern.compare(lowKey.size(), 2, "%\"") == 0);
+    int maxRecords = searchLimit;
+    if (!flagPrefixOnly) searchLimit = -1;
+    searchStringRange(avlRoot, lowKey, highKey);
+    searchLimit = maxRecords;
+    if (flagPrefixOnly) return;
+
+    for (std::list<Record*>::iterator it = searchResult.begin(); it != searchResult.end();) {
+        if (matchLike((*it)->getData(columnIndex)->getValueString(), pattern)) {
+            ++it;
         } else {
-            return nullptr;
+            it = searchResult.erase(it);
         }
     }
 }
+
+void AVLTree::searchStringRange(RecordNode* root, const std::string& low, const std::string& high) {
+    if (root == nullptr || (searchLimit >= 0 && searchResult.size() >= (size_t)searchLimit)) return;
+    nodesVisited.fetch_add(1, std::memory_order_relaxed);
+    std::string currentValue;
+    nodeKey(root, currentValue);
+    if (currentValue >= low) searchStringRange(root->leftNode, low, high);
+    if (currentValue >= low && (high.empty() || currentValue < high)) {
+        searchResult.insert(searchResult.end(), root->records.begin(), root->records.end());
+    }
+    if (high.empty() || currentValue < high) searchStringRange(root->rightNode, low, high);
+}
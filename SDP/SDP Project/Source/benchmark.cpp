@@ -0,0 +1,303 @@
+/**
+ * SDP database engine benchmarks
+ * Synthetic tables with controllable value distributions,
+ * the results are written as CSV lines: Test, Time in nanoseconds
+ */
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <iostream>
+#include <random>
+#include <sstream>
+
+#include "../Headers/command.hpp"
+#include "../Headers/table.hpp"
+
+const unsigned int BENCHMARK_SEED = 2022;  //!< Seed of the generated values, fixed to compare releases
+
+//! Distributions of the generated keys
+enum class Distribution {
+    SEQUENTIAL = 0,    // 0, 1, 2, ...
+    UNIFORM = 1,       // Uniform in [0, rows)
+    SKEWED = 2,        // Most values are small
+    FEWDISTINCT = 3,   // 100 distinct values
+    COUNTDISTRIBUTIONS // Number of distributions
+};
+
+const char DistributionList[(int)(Distribution::COUNTDISTRIBUTIONS)][12] = {
+    "sequential",
+    "uniform",
+    "skewed",
+    "fewdistinct"};
+
+//! Generate the keys of a table
+std::vector<int> generateKeys(int numberOfRows, Distribution distribution) {
+    std::mt19937 generator(BENCHMARK_SEED);
+    std::uniform_int_distribution<int> uniform(0, numberOfRows - 1);
+    std::uniform_real_distribution<double> unit(0.0, 1.0);
+    std::vector<int> keys(numberOfRows);
+    for (int i = 0; i < numberOfRows; ++i) {
+        switch (distribution) {
+            case Distribution::SEQUENTIAL:
+                keys[i] = i;
+                break;
+            case Distribution::UNIFORM:
+                keys[i] = uniform(generator);
+                break;
+            case Distribution::SKEWED:
+                keys[i] = (int)(numberOfRows * std::pow(unit(generator), 4));
+                break;
+            default:
+                keys[i] = uniform(generator) % 100;
+                break;
+        }
+    }
+    return keys;
+}
+
+//! Build the input values of a record: ID INDEX, Value (same key without index), Name, Date
+std::vector<std::string> generateRecord(int key) {
+    std::vector<std::string> recordValues;
+    recordValues.push_back(std::to_string(key));
+    recordValues.push_back(std::to_string(key));
+    recordValues.push_back("\"Name" + std::to_string(key % 1000) + "\"");
+    recordValues.push_back(formatDate(key % 3650));
+    return recordValues;
+}
+
+//! Create the structure of a benchmark table
+void createStructure(Table& table) {
+    table.addField("ID", FieldType::INT, false, true, "");
+    table.addField("Value", FieldType::INT, false, false, "");
+    table.addField("Name", FieldType::STRING, false, false, "");
+    table.addField("Date", FieldType::DATE, false, false, "");
+}
+
+//! Print a single result line
+void printResult(const std::string& testName, std::chrono::steady_clock::time_point start, std::chrono::steady_clock::time_point end, int repetitions = 1) {
+    std::chrono::duration<long long, std::nano> timer = end - start;
+    std::cout << testName << ", " << timer.count() / repetitions << '\n';
+}
+
+//! Test: Insert the records of a table
+void insertRecords(Table& table, const std::vector<int>& keys, const std::string& testSuffix) {
+    std::vector<std::vector<std::string>> recordValues;
+    recordValues.reserve(keys.size());
+    for (unsigned int i = 0; i < keys.size(); ++i) recordValues.push_back(generateRecord(keys[i]));
+
+    auto start = std::chrono::steady_clock::now();  //!< Timer start
+    for (unsigned int i = 0; i < recordValues.size(); ++i) table.addRecord(recordValues[i]);
+    auto end = std::chrono::steady_clock::now();  //!< Timer end
+
+    printResult("Insert " + testSuffix, start, end);
+}
+
+//! Test: Insert the records of a table in batches of 1000 records
+void insertBatches(const std::vector<int>& keys, const std::string& testSuffix) {
+    const unsigned int batchRecords = 1000;
+    std::vector<std::vector<std::vector<std::string>>> recordsBatches;
+    for (unsigned int i = 0; i < keys.size(); ++i) {
+        if (i % batchRecords == 0) recordsBatches.push_back(std::vector<std::vector<std::string>>());
+        recordsBatches.back().push_back(generateRecord(keys[i]));
+    }
+    Table table("BenchmarkTable");
+    createStructure(table);
+
+    auto start = std::chrono::steady_clock::now();  //!< Timer start
+    for (unsigned int i = 0; i < recordsBatches.size(); ++i) table.addRecords(recordsBatches[i]);
+    auto end = std::chrono::steady_clock::now();  //!< Timer end
+
+    printResult("Insert batches of 1000 " + testSuffix, start, end);
+}
+
+//! Test: Select single keys with and without the index, time per query
+void selectEqualRecords(Table& table, const std::vector<int>& keys, const std::string& testSuffix) {
+    std::vector<std::string> noColumns;
+    std::mt19937 generator(BENCHMARK_SEED);
+    std::uniform_int_distribution<int> position(0, keys.size() - 1);
+    const int indexedQueries = 1000, scannedQueries = 10;
+
+    auto start = std::chrono::steady_clock::now();  //!< Timer start
+    for (int i = 0; i < indexedQueries; ++i) {
+        std::vector<std::string> whereParameters = {"ID", "=", std::to_string(keys[position(generator)])};
+        table.selectRecords(noColumns, noColumns, whereParameters);
+    }
+    auto end = std::chrono::steady_clock::now();  //!< Timer end
+    printResult("Select indexed ID = <key> per query " + testSuffix, start, end, indexedQueries);
+
+    start = std::chrono::steady_clock::now();
+    for (int i = 0; i < scannedQueries; ++i) {
+        std::vector<std::string> whereParameters = {"Value", "=", std::to_string(keys[position(generator)])};
+        table.selectRecords(noColumns, noColumns, whereParameters);
+    }
+    end = std::chrono::steady_clock::now();
+    printResult("Select unindexed Value = <key> per query " + testSuffix, start, end, scannedQueries);
+}
+
+//! Test: Select a range of about a tenth of the key space without the index
+void selectRangeRecords(Table& table, int numberOfRows, const std::string& testSuffix) {
+    std::vector<std::string> noColumns;
+    std::vector<std::string> whereParameters = {"Value", ">=", std::to_string(numberOfRows / 2), "AND", "Value", "<", std::to_string(numberOfRows / 2 + numberOfRows / 10)};
+
+    auto start = std::chrono::steady_clock::now();  //!< Timer start
+    table.selectRecords(noColumns, noColumns, whereParameters);
+    auto end = std::chrono::steady_clock::now();  //!< Timer end
+
+    printResult("Select unindexed Value range " + testSuffix, start, end);
+}
+
+//! Test: Select distinct names
+void selectDistinctRecords(Table& table, const std::string& testSuffix) {
+    std::vector<std::string> noColumns;
+    std::vector<std::string> distinctColumns = {"Name"};
+
+    auto start = std::chrono::steady_clock::now();  //!< Timer start
+    table.selectRecords(distinctColumns, noColumns, noColumns);
+    auto end = std::chrono::steady_clock::now();  //!< Timer end
+
+    printResult("Select DISTINCT Name " + testSuffix, start, end);
+}
+
+//! Test: Order all records and the first 100 records
+void selectOrderedRecords(Table& table, const std::string& testSuffix) {
+    std::vector<std::string> noColumns;
+    std::vector<std::string> orderByColumns = {"Value"};
+
+    auto start = std::chrono::steady_clock::now();  //!< Timer start
+    table.selectRecords(noColumns, orderByColumns, noColumns);
+    auto end = std::chrono::steady_clock::now();  //!< Timer end
+    printResult("Select ORDERBY Value " + testSuffix, start, end);
+
+    start = std::chrono::steady_clock::now();
+    table.selectRecords(noColumns, orderByColumns, noColumns, 100);
+    end = std::chrono::steady_clock::now();
+    printResult("Select ORDERBY Value LIMIT 100 " + testSuffix, start, end);
+}
+
+//! Test: Remove about a tenth of the records, the ones with the lowest keys
+void removeRecords(Table& table, std::vector<int> keys, const std::string& testSuffix) {
+    std::nth_element(keys.begin(), keys.begin() + keys.size() / 10, keys.end());
+    std::vector<std::string> whereParameters = {"Value", "<", std::to_string(keys[keys.size() / 10])};
+
+    auto start = std::chrono::steady_clock::now();  //!< Timer start
+    table.removeRecords(whereParameters);
+    auto end = std::chrono::steady_clock::now();  //!< Timer end
+
+    printResult("Remove lowest tenth of Value " + testSuffix, start, end);
+}
+
+//! Test: The same inserts, lookups and range searches with an AVL tree and a B+ tree index on ID
+void compareIndexStructures(const std::vector<int>& keys, const std::string& testSuffix) {
+    std::vector<int> sortedKeys(keys);
+    std::sort(sortedKeys.begin(), sortedKeys.end());
+    std::mt19937 generator(BENCHMARK_SEED);
+    std::uniform_int_distribution<int> position(0, keys.size() - 1);
+    const int equalQueries = 1000, rangeQueries = 100;
+
+    for (int i = 0; i < (int)(IndexType::COUNTINDEXTYPE); ++i) {
+        std::string testName = std::string(" ") + IndexTypeList[i] + " " + testSuffix;
+        Table table("BenchmarkTable");
+        table.addField("ID", FieldType::INT, false, true, "", (IndexType)i);
+        table.addField("Value", FieldType::INT, false, false, "");
+
+        auto start = std::chrono::steady_clock::now();  //!< Timer start
+        for (unsigned int j = 0; j < keys.size(); ++j) table.addRecord({std::to_string(keys[j]), std::to_string(keys[j])});
+        auto end = std::chrono::steady_clock::now();  //!< Timer end
+        printResult("Index insert" + testName, start, end);
+
+        start = std::chrono::steady_clock::now();
+        for (int j = 0; j < equalQueries; ++j) {
+            std::vector<std::string> whereParameters = {"ID", "=", std::to_string(keys[position(generator)])};
+            table.selectRecordsWhere(whereParameters);
+        }
+        end = std::chrono::steady_clock::now();
+        printResult("Index ID = <key> per query" + testName, start, end, equalQueries);
+
+        start = std::chrono::steady_clock::now();  // About 1% of the records from a random key
+        for (int j = 0; j < rangeQueries; ++j) {
+            unsigned int first = position(generator) % (sortedKeys.size() - sortedKeys.size() / 100);
+            std::vector<std::string> whereParameters = {"ID", ">=", std::to_string(sortedKeys[first])};
+            table.selectRecordsWhere(whereParameters, sortedKeys.size() / 100);
+        }
+        end = std::chrono::steady_clock::now();
+        printResult("Index ID >= <key> LIMIT 1% per query" + testName, start, end, rangeQueries);
+    }
+}
+
+//! Test: Insert through the commands, then CLOSE and OPEN the table
+void closeOpenRoundTrip(const std::vector<int>& keys, const std::string& testSuffix) {
+    const unsigned int batchRecords = 1000;
+    std::ostringstream discardedOutput;
+    std::streambuf* consoleOutput = std::cout.rdbuf();
+    CommandLine commandLine;
+
+    std::vector<std::string> insertCommands;
+    for (unsigned int i = 0; i < keys.size(); i += batchRecords) {
+        std::string insertCommand = "INSERT BenchmarkTable";
+        for (unsigned int j = i; j < keys.size() && j < i + batchRecords; ++j) {
+            std::vector<std::string> recordValues = generateRecord(keys[j]);
+            insertCommand += " (" + recordValues[0] + ", " + recordValues[1] + ", " + recordValues[2] + ", " + recordValues[3] + ")";
+        }
+        insertCommands.push_back(insertCommand);
+    }
+
+    std::cout.rdbuf(discardedOutput.rdbuf());  // The command messages are not part of the results
+    commandLine.CommandLineDirectInput("CREATETABLE BenchmarkTable (ID:INT INDEX, Value:INT, Name:STRING, Date:DATE)");
+    auto start = std::chrono::steady_clock::now();  //!< Timer start
+    for (unsigned int i = 0; i < insertCommands.size(); ++i) commandLine.CommandLineDirectInput(insertCommands[i].c_str());
+    auto inserted = std::chrono::steady_clock::now();
+    commandLine.CommandLineDirectInput("CLOSE BenchmarkTable");
+    auto closed = std::chrono::steady_clock::now();
+    commandLine.CommandLineDirectInput("OPEN BenchmarkTable");
+    auto opened = std::chrono::steady_clock::now();
+    commandLine.CommandLineDirectInput("SAVE DATABASE 'BenchmarkSnapshot.sdp'");
+    auto saved = std::chrono::steady_clock::now();
+    CommandLine restartedCommandLine;
+    restartedCommandLine.CommandLineDirectInput("LOAD DATABASE 'BenchmarkSnapshot.sdp'");
+    auto end = std::chrono::steady_clock::now();  //!< Timer end
+    std::cout.rdbuf(consoleOutput);
+
+    printResult("INSERT commands " + testSuffix, start, inserted);
+    printResult("CLOSE " + testSuffix, inserted, closed);
+    printResult("OPEN " + testSuffix, closed, opened);
+    printResult("SAVE DATABASE " + testSuffix, opened, saved);
+    printResult("LOAD DATABASE " + testSuffix, saved, end);
+    std::remove("BenchmarkTable.sdp");
+    std::remove("BenchmarkSnapshot.sdp");
+}
+
+//! Run all tests on a table size and distribution
+void benchmarkTable(int numberOfRows, Distribution distribution) {
+    std::string testSuffix = std::to_string(numberOfRows) + " " + DistributionList[(int)distribution] + " records";
+    std::vector<int> keys = generateKeys(numberOfRows, distribution);
+
+    Table table("BenchmarkTable");
+    createStructure(table);
+    insertRecords(table, keys, testSuffix);
+    insertBatches(keys, testSuffix);
+    selectEqualRecords(table, keys, testSuffix);
+    selectRangeRecords(table, numberOfRows, testSuffix);
+    selectDistinctRecords(table, testSuffix);
+    selectOrderedRecords(table, testSuffix);
+    removeRecords(table, keys, testSuffix);
+    compareIndexStructures(keys, testSuffix);
+    if (distribution == Distribution::UNIFORM) closeOpenRoundTrip(keys, testSuffix);
+}
+
+int main(int argc, char* argv[]) {
+    int maximalRows = 1000000;  // Larger tables with: SDPBenchmark <rows>
+    if (argc > 1) maximalRows = std::atoi(argv[1]);
+
+    std::cout << "SDP Database\n";
+    std::cout << "Test, Time in nanoseconds\n";
+    for (int numberOfRows = 10000; numberOfRows <= maximalRows && numberOfRows <= 10000000; numberOfRows *= 10) {
+        for (int i = 0; i < (int)(Distribution::COUNTDISTRIBUTIONS); ++i) {
+            benchmarkTable(numberOfRows, (Distribution)i);
+        }
+    }
+
+    return 0;
+}
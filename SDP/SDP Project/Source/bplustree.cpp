@@ -0,0 +1,367 @@
+#include "../Headers/bplustree.hpp"
+
+template <typename KeyType>
+void BPlusTree<KeyType>::recordKey(Record* value, int& key) const {
+    key = value->getData(columnIndex)->getValueInt();
+}
+
+template <typename KeyType>
+void BPlusTree<KeyType>::recordKey(Record* value, std::string& key) const {
+    key = value->getData(columnIndex)->getValueUniform();
+}
+
+template <typename KeyType>
+bool BPlusTree<KeyType>::parseKey(const std::string& value, int& key) const {
+    if (dataType == FieldType::DATE) return parseDate(value, key);
+    if (value.empty() || !isNumber(value)) return false;
+    key = stoi(value);
+    return true;
+}
+
+template <typename KeyType>
+bool BPlusTree<KeyType>::parseKey(const std::string& value, std::string& key) const {
+    if (value.empty() || !isString(value)) return false;
+    key = value;
+    return true;
+}
+
+template <typename KeyType>
+void BPlusTree<KeyType>::clearTree(TreeNode* root) {
+    if (root == nullptr) return;
+    for (unsigned int i = 0; i < root->children.size(); ++i) clearTree(root->children[i]);
+    delete root;
+}
+
+template <typename KeyType>
+typename BPlusTree<KeyType>::TreeNode* BPlusTree<KeyType>::findLeaf(const KeyType& key) const {
+    TreeNode* currentNode = treeRoot;
+    while (!currentNode->isLeaf) {  // Equal keys are in the right subtree of a separator
+        nodesVisited.fetch_add(1, std::memory_order_relaxed);
+        currentNode = currentNode->children[std::upper_bound(currentNode->keys.begin(), currentNode->keys.end(), key) - currentNode->keys.begin()];
+    }
+    nodesVisited.fetch_add(1, std::memory_order_relaxed);
+    return currentNode;
+}
+
+template <typename KeyType>
+typename BPlusTree<KeyType>::TreeNode* BPlusTree<KeyType>::insertNode(TreeNode* root, const KeyType& key, Record* value, KeyType& separatorKey) {
+    if (root->isLeaf) {
+        unsigned int position = std::lower_bound(root->keys.begin(), root->keys.end(), key) - root->keys.begin();
+        if (position < root->keys.size() && root->keys[position] == key) {
+            root->postings[position].push_back(value);
+            return nullptr;
+        }
+        root->keys.insert(root->keys.begin() + position, key);
+        root->postings.insert(root->postings.begin() + position, std::vector<Record*>(1, value));
+    } else {
+        unsigned int position = std::upper_bound(root->keys.begin(), root->keys.end(), key) - root->keys.begin();
+        KeyType childSeparator;
+        TreeNode* childSibling = insertNode(root->children[position], key, value, childSeparator);
+        if (childSibling == nullptr) return nullptr;
+        root->keys.insert(root->keys.begin() + position, childSeparator);
+        root->children.insert(root->children.begin() + position + 1, childSibling);
+    }
+    if (root->keys.size() <= BPTREE_NODE_KEYS) return nullptr;
+
+    // Split a full node in halves, the right half becomes a new sibling
+    unsigned int middle = root->keys.size() / 2;
+    TreeNode* sibling = new TreeNode(root->isLeaf);
+    if (root->isLeaf) {
+        sibling->keys.assign(root->keys.begin() + middle, root->keys.end());
+        sibling->postings.assign(std::make_move_iterator(root->postings.begin() + middle), std::make_move_iterator(root->postings.end()));
+        root->keys.resize(middle);
+        root->postings.resize(middle);
+        sibling->nextLeaf = root->nextLeaf;
+        root->nextLeaf = sibling;
+        separatorKey = sibling->keys.front();
+    } else {  // The middle key moves up to the parent
+        separatorKey = root->keys[middle];
+        sibling->keys.assign(root->keys.begin() + middle + 1, root->keys.end());
+        sibling->children.assign(root->children.begin() + middle + 1, root->children.end());
+        root->keys.resize(middle);
+        root->children.resize(middle + 1);
+    }
+    return sibling;
+}
+
+template <typename KeyType>
+void BPlusTree<KeyType>::insert(Record* value) {
+    KeyType key;
+    recordKey(value, key);
+    if (treeRoot == nullptr) treeRoot = firstLeaf = new TreeNode(true);
+
+    KeyType separatorKey;
+    TreeNode* sibling = insertNode(treeRoot, key, value, separatorKey);
+    if (sibling != nullptr) {  // The root was split, the tree grows by a level
+        TreeNode* newRoot = new TreeNode(false);
+        newRoot->keys.push_back(separatorKey);
+        newRoot->children.push_back(treeRoot);
+        newRoot->children.push_back(sibling);
+        treeRoot = newRoot;
+    }
+    ++recordsCount;
+}
+
+template <typename KeyType>
+void BPlusTree<KeyType>::buildFromSorted(const std::vector<Record*>& sortedRecords) {
+    clearTree(treeRoot);
+    treeRoot = firstLeaf = nullptr;
+    recordsCount = sortedRecords.size();
+
+    // Fill the leaves in key order, records with equal keys share a posting array
+    std::vector<TreeNode*> levelNodes;
+    std::vector<KeyType> levelKeys;  //!< Minimal key under each node of the level
+    TreeNode* currentLeaf = nullptr;
+    KeyType key;
+    for (unsigned int i = 0; i < sortedRecords.size(); ++i) {
+        recordKey(sortedRecords[i], key);
+        if (currentLeaf != nullptr && currentLeaf->keys.back() == key) {
+            currentLeaf->postings.back().push_back(sortedRecords[i]);
+            continue;
+        }
+        if (currentLeaf == nullptr || currentLeaf->keys.size() >= BPTREE_NODE_KEYS) {
+            TreeNode* newLeaf = new TreeNode(true);
+            if (currentLeaf != nullptr) currentLeaf->nextLeaf = newLeaf;
+            currentLeaf = newLeaf;
+            levelNodes.push_back(newLeaf);
+            levelKeys.push_back(key);
+        }
+        currentLeaf->keys.push_back(key);
+        currentLeaf->postings.push_back(std::vector<Record*>(1, sortedRecords[i]));
+    }
+    if (levelNodes.empty()) return;
+    firstLeaf = levelNodes.front();
+
+    // Group the nodes of each level under parents until a single root is left
+    while (levelNodes.size() > 1) {
+        std::vector<TreeNode*> parentNodes;
+        std::vector<KeyType> parentKeys;
+        for (unsigned int i = 0; i < levelNodes.size(); i += BPTREE_NODE_KEYS + 1) {
+            TreeNode* parent = new TreeNode(false);
+            for (unsigned int j = i; j < levelNodes.size() && j < i + BPTREE_NODE_KEYS + 1; ++j) {
+                if (j > i) parent->keys.push_back(levelKeys[j]);
+                parent->children.push_back(levelNodes[j]);
+            }
+            parentNodes.push_back(parent);
+            parentKeys.push_back(levelKeys[i]);
+        }
+        levelNodes.swap(parentNodes);
+        levelKeys.swap(parentKeys);
+    }
+    treeRoot = levelNodes.front();
+}
+
+template <typename KeyType>
+void BPlusTree<KeyType>::collectRecords(std::vector<Record*>& collectedRecords) const {
+    collectedRecords.reserve(collectedRecords.size() + recordsCount);
+    for (TreeNode* leaf = firstLeaf; leaf != nullptr; leaf = leaf->nextLeaf) {
+        for (unsigned int i = 0; i < leaf->postings.size(); ++i) {
+            collectedRecords.insert(collectedRecords.end(), leaf->postings[i].begin(), leaf->postings[i].end());
+        }
+    }
+}
+
+template <typename KeyType>
+void BPlusTree<KeyType>::insertSorted(const std::vector<Record*>& sortedRecords) {
+    if (sortedRecords.empty()) return;
+    if (sortedRecords.size() * 4 < recordsCount) {  // A small batch is cheaper to insert one by one
+        for (unsigned int i = 0; i < sortedRecords.size(); ++i) insert(sortedRecords[i]);
+        return;
+    }
+
+    std::vector<Record*> currentRecords, mergedRecords;
+    collectRecords(currentRecords);
+    mergedRecords.reserve(currentRecords.size() + sortedRecords.size());
+    std::merge(currentRecords.begin(), currentRecords.end(), sortedRecords.begin(), sortedRecords.end(), std::back_inserter(mergedRecords),
+               [this](Record* value1, Record* value2) {
+                   KeyType key1, key2;
+                   recordKey(value1, key1);
+                   recordKey(value2, key2);
+                   return key1 < key2;
+               });
+    buildFromSorted(mergedRecords);
+}
+
+template <typename KeyType>
+void BPlusTree<KeyType>::removeData(Record* value) {
+    if (treeRoot == nullptr) return;
+    KeyType key;
+    recordKey(value, key);
+    TreeNode* leaf = findLeaf(key);
+    unsigned int position = std::lower_bound(leaf->keys.begin(), leaf->keys.end(), key) - leaf->keys.begin();
+    if (position >= leaf->keys.size() || !(leaf->keys[position] == key)) return;
+
+    std::vector<Record*>& posting = leaf->postings[position];
+    std::vector<Record*>::iterator it = std::find(posting.begin(), posting.end(), value);
+    if (it == posting.end()) return;
+    posting.erase(it);
+    --recordsCount;
+    if (posting.empty()) {  // The separators above stay valid without the key
+        leaf->keys.erase(leaf->keys.begin() + position);
+        leaf->postings.erase(leaf->postings.begin() + position);
+    }
+}
+
+template <typename KeyType>
+void BPlusTree<KeyType>::scanLeaves(TreeNode* leaf, unsigned int position, OperatorType operatorCompare, const KeyType& value) {
+    for (; leaf != nullptr; leaf = leaf->nextLeaf, position = 0) {
+        nodesVisited.fetch_add(1, std::memory_order_relaxed);
+        for (; position < leaf->keys.size(); ++position) {
+            if (searchLimit >= 0 && searchResult.size() >= (size_t)searchLimit) return;
+            const KeyType& currentValue = leaf->keys[position];
+            if (operatorCompare == OperatorType::LT && !(currentValue < value)) return;
+            if (operatorCompare == OperatorType::LE && value < currentValue) return;
+            if (operatorCompare == OperatorType::NE && currentValue == value) continue;
+            searchResult.insert(searchResult.end(), leaf->postings[position].begin(), leaf->postings[position].end());
+        }
+    }
+}
+
+template <typename KeyType>
+std::list<Record*> BPlusTree<KeyType>::searchNode(std::string value, OperatorType operatorCompare, int maxRecords) {
+    searchResult.clear();
+    searchLimit = maxRecords;
+    if (treeRoot == nullptr) return searchResult;
+
+    KeyType key;
+    if (operatorCompare == OperatorType::LIKE) {
+        if (dataType == FieldType::STRING && !value.empty() && isString(value)) searchLike(value);
+    } else if (parseKey(value, key)) {
+        TreeNode* leaf = nullptr;
+        unsigned int position = 0;
+        switch (operatorCompare) {
+            case OperatorType::EQ:
+                leaf = findLeaf(key);
+                position = std::lower_bound(leaf->keys.begin(), leaf->keys.end(), key) - leaf->keys.begin();
+                if (position < leaf->keys.size() && leaf->keys[position] == key) {
+                    searchResult.assign(leaf->postings[position].begin(), leaf->postings[position].end());
+                }
+                break;
+            case OperatorType::GT:
+                leaf = findLeaf(key);
+                scanLeaves(leaf, std::upper_bound(leaf->keys.begin(), leaf->keys.end(), key) - leaf->keys.begin(), operatorCompare, key);
+                break;
+            case OperatorType::GE:
+                leaf = findLeaf(key);
+                scanLeaves(leaf, std::lower_bound(leaf->keys.begin(), leaf->keys.end(), key) - leaf->keys.begin(), operatorCompare, key);
+                break;
+            case OperatorType::LT:
+            case OperatorType::LE:
+            case OperatorType::NE:
+                scanLeaves(firstLeaf, 0, operatorCompare, key);
+                break;
+            default:
+                break;
+        }
+    }
+    if (maxRecords >= 0 && searchResult.size() > (size_t)maxRecords) searchResult.resize(maxRecords);
+    return searchResult;
+}
+
+template <typename KeyType>
+bool BPlusTree<KeyType>::likeRange(const std::string&, int&, int&, bool&) const {
+    return false;
+}
+
+template <typename KeyType>
+bool BPlusTree<KeyType>::likeRange(const std::string& pattern, std::string& lowKey, std::string& highKey, bool& hasHighKey) const {
+    // Every key with the prefix of the pattern is in the range [prefix, prefix with its last character increased)
+    lowKey = likePrefix(pattern);
+    highKey = lowKey;
+    while (!highKey.empty() && (unsigned char)highKey.back() == 0xFF) highKey.pop_back();
+    if (!highKey.empty()) ++highKey.back();
+    hasHighKey = !highKey.empty();
+    return true;
+}
+
+template <typename KeyType>
+void BPlusTree<KeyType>::searchLike(const std::string& pattern) {
+    KeyType lowKey, highKey;
+    bool hasHighKey = false;
+    if (!likeRange(pattern, lowKey, highKey, hasHighKey)) return;
+
+    // Keys in the range of "abc%" always match, other patterns are checked after the search
+    std::string prefix = likePrefix(pattern);
+    bool flagPrefixOnly = (pattern.size() == prefix.size() + 2 && pattern.compare(prefix.size(), 2, "%\"") == 0);
+    int maxRecords = searchLimit;
+    if (!flagPrefixOnly) searchLimit = -1;
+    TreeNode* leaf = findLeaf(lowKey);
+    unsigned int position = std::lower_bound(leaf->keys.begin(), leaf->keys.end(), lowKey) - leaf->keys.begin();
+    scanLeaves(leaf, position, hasHighKey ? OperatorType::LT : OperatorType::GE, hasHighKey ? highKey : lowKey);
+    searchLimit = maxRecords;
+    if (flagPrefixOnly) return;
+
+    for (std::list<Record*>::iterator it = searchResult.begin(); it != searchResult.end();) {
+        if (matchLike((*it)->getData(columnIndex)->getValueString(), pattern)) {
+            ++it;
+        } else {
+            it = searchResult.erase(it);
+        }
+    }
+}
+
+template <typename KeyType>
+Record* BPlusTree<KeyType>::getMinRecord() const {
+    for (TreeNode* leaf = firstLeaf; leaf != nullptr; leaf = leaf->nextLeaf) {  // Leaves emptied by removals are skipped
+        if (!leaf->postings.empty()) return leaf->postings.front().front();
+    }
+    return nullptr;
+}
+
+template <typename KeyType>
+Record* BPlusTree<KeyType>::maxRecord(TreeNode* root) const {
+    if (root->isLeaf) return root->postings.empty() ? nullptr : root->postings.back().back();
+    for (int i = root->children.size() - 1; i >= 0; --i) {
+        Record* maximalRecord = maxRecord(root->children[i]);
+        if (maximalRecord != nullptr) return maximalRecord;
+    }
+    return nullptr;
+}
+
+template <typename KeyType>
+Record* BPlusTree<KeyType>::getMaxRecord() const {
+    if (treeRoot == nullptr) return nullptr;
+    return maxRecord(treeRoot);
+}
+
+template <typename KeyType>
+int BPlusTree<KeyType>::countRecords() const {
+    return recordsCount;
+}
+
+template <typename KeyType>
+std::vector<Record*> BPlusTree<KeyType>::orderedRecords() const {
+    std::vector<Record*> indexedRecords;
+    collectRecords(indexedRecords);
+    return indexedRecords;
+}
+
+template <typename KeyType>
+size_t BPlusTree<KeyType>::memoryBytes() const {
+    return sizeof(BPlusTree<KeyType>) + nodeBytes(treeRoot);
+}
+
+template <typename KeyType>
+size_t BPlusTree<KeyType>::nodeBytes(TreeNode* root) const {
+    if (root == nullptr) return 0;
+    size_t sizeBytes = allocationBytes(sizeof(TreeNode));
+    if (root->keys.capacity() > 0) sizeBytes += allocationBytes(root->keys.capacity() * sizeof(KeyType));
+    for (unsigned int i = 0; i < root->keys.size(); ++i) sizeBytes += keyHeapBytes(root->keys[i]);
+    if (root->children.capacity() > 0) sizeBytes += allocationBytes(root->children.capacity() * sizeof(TreeNode*));
+    for (unsigned int i = 0; i < root->children.size(); ++i) sizeBytes += nodeBytes(root->children[i]);
+    if (root->postings.capacity() > 0) sizeBytes += allocationBytes(root->postings.capacity() * sizeof(std::vector<Record*>));
+    for (unsigned int i = 0; i < root->postings.size(); ++i) {
+        if (root->postings[i].capacity() > 0) sizeBytes += allocationBytes(root->postings[i].capacity() * sizeof(Record*));
+    }
+    return sizeBytes;
+}
+
+template <typename KeyType>
+int BPlusTree<KeyType>::treeHeight() const {
+    int height = 0;
+    for (TreeNode* currentNode = treeRoot; currentNode != nullptr; currentNode = currentNode->isLeaf ? nullptr : currentNode->children.front()) ++height;
+    return height;
+}
+
+template class BPlusTree<int>;
+template class BPlusTree<std::string>;
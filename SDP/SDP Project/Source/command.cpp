@@ -67,6 +67,18 @@ void CommandLine::CommandLineExecute() {
         commandLineInput.erase(commandLineInput.begin(), 1 + commandLineInput.begin() + strlen(OperationList[(int)operationType]));
     }
 
+    if (inTransaction && commitsTransaction(operationType)) commitTransaction();  // The changes before it are kept
+
+    ++commandCounter;
+    std::string commandText = operationName + " " + commandLineInput;
+    bool flagProfiled = profilingEnabled && operationType != OperationType::UNDEFINED &&
+                        operationType != OperationType::EXPLAIN && operationType != OperationType::SET;
+    activeProfiler = nullptr;
+    if (flagProfiled) {
+        queryProfiler.startQuery();
+        activeProfiler = &queryProfiler;
+    }
+
     switch (operationType) {
         case OperationType::QUIT:
             commandExit = true;
@@ -101,9 +113,62 @@ void CommandLine::CommandLineExecute() {
         case OperationType::SELECT:
             selectRecords();
             break;
+        case OperationType::UPDATE:
+            updateRecords();
+            break;
+        case OperationType::ANALYZE:
+            analyzeTable();
+            break;
+        case OperationType::VACUUM:
+            vacuumTable();
+            break;
+        case OperationType::SET:
+            setOption();
+            break;
+        case OperationType::CACHESTATS:
+            cacheStats();
+            break;
+        case OperationType::EXPLAIN:
+            explainQuery();
+            break;
+        case OperationType::SAVE:
+            saveDatabase();
+            break;
+        case OperationType::LOAD:
+            loadDatabase();
+            break;
+        case OperationType::CREATE:
+            createView();
+            break;
+        case OperationType::DROP:
+            dropView();
+            break;
+        case OperationType::CHECKPOINT:
+            checkpointTables();
+            break;
+        case OperationType::SOURCE:
+            sourceScript();
+            break;
+        case OperationType::BEGIN:
+            beginTransaction();
+            break;
+        case OperationType::COMMIT:
+            commitCommand();
+            break;
+        case OperationType::ROLLBACK:
+            rollbackCommand();
+            break;
         default:
             break;
     }
+
+    if (flagProfiled) {
+        activeProfiler = nullptr;
+        logSlowQuery(commandText);
+    }
+    if (memoryLimit > 0) enforceMemoryLimit();
+    if (checkpointInterval > 0 && commandCounter % checkpointInterval == 0) checkpointChangedTables();
+    collectFlushes();
 }
 
 void CommandLine::splashScreen() {
@@ -138,6 +203,9 @@ void CommandLine::helpInfo() const {
               << "     A field type that must have a value\n"
               << " --> INDEX\n"
               << "     Indexed field for faster search options\n"
+              << " --> INDEX BPTREE\n"
+              << "     Indexed field in a B+ tree, faster for\n"
+              << "     large tables and range searches\n"
               << " --> DEFAULT <value>\n"
               << "     Default value for a field\n"
               << " --> DISTINCT\n"
@@ -157,17 +225,89 @@ void CommandLine::helpInfo() const {
               << " --> WHERE <condition>\n"
               << "     Display selected records based on the\n"
               << "     condition\n"
+              << " --> <field> LIKE \"<pattern>\"\n"
+              << "     Match a STRING field, % is any text and _\n"
+              << "     is any single character\n"
               << " --> ORDERBY <fields>\n"
               << "     Order selected records by field\n"
+              << " --> LIMIT <number> OFFSET <number>\n"
+              << "     Display at most the selected number of\n"
+              << "     records after skipping the offset\n"
+              << " > SELECT <fields> FROM <name> JOIN <name>\n"
+              << "   ON <name>.<field> = <name>.<field>\n"
+              << "   Display the records of two tables with equal\n"
+              << "   field values, fields are named <name>.<field>\n"
+              << " > SELECT <aggregates> FROM <name>\n"
+              << "   Display COUNT(*), COUNT(<field>), SUM(<field>),\n"
+              << "   MIN(<field>), MAX(<field>) and AVG(<field>)\n"
+              << " --> GROUPBY <fields>\n"
+              << "     Aggregate separately for each group of\n"
+              << "     equal field values\n"
+              << " > CREATE VIEW <name> AS SELECT <fields> FROM\n"
+              << "   <name> WHERE <condition> GROUPBY <fields>\n"
+              << "   Keep the result of a selection up to date on\n"
+              << "   every change of its table, read the view with\n"
+              << "   SELECT * FROM <name> LIMIT <number> OFFSET <number>\n"
+              << " > DROP VIEW <name>\n"
+              << "   Remove a view with selected name\n"
               << " > REMOVE FROM <name> WHERE <condition>\n"
               << "   Remove selected columns from a table\n"
+              << " > UPDATE <name> SET <field> = <value>, ...\n"
+              << "   WHERE <condition>\n"
+              << "   Change fields of the selected records\n"
+              << " > ANALYZE <name>\n"
+              << "   Rebuild the statistics of a table used to\n"
+              << "   choose between index and full scans\n"
+              << " > VACUUM <name>\n"
+              << "   Reclaim the space of removed records and\n"
+              << "   rebuild the indexes of a table\n"
+              << " > SET CACHE ON [<bytes>] | OFF\n"
+              << "   Keep the results of repeated selections until\n"
+              << "   their tables change, within the memory limit\n"
+              << " > SET PROFILING ON [<milliseconds>] | OFF\n"
+              << "   Log the commands slower than the threshold\n"
+              << "   with their stages in the slow query log\n"
+              << " > EXPLAIN ANALYZE SELECT ...\n"
+              << "   Run a selection and display the time, the rows,\n"
+              << "   the index nodes and the allocations of each stage\n"
+              << " > SET MEMORYLIMIT <bytes> | OFF\n"
+              << "   Evict the least recently used tables to their\n"
+              << "   files when the open tables use more memory,\n"
+              << "   an evicted table is loaded on its next use\n"
+              << " > CHECKPOINT [<name>]\n"
+              << "   Write a table, or all changed open tables, in\n"
+              << "   their files in the background, the tables stay\n"
+              << "   open and CLOSE also writes in the background\n"
+              << " > SET CHECKPOINT <commands> | OFF\n"
+              << "   CHECKPOINT the changed tables after every\n"
+              << "   selected number of commands\n"
+              << " > CACHESTATS\n"
+              << "   Display the hits and misses of the query cache\n"
               << " > INSERT <name> (<records>)\n"
               << "   Insert a single or multiple records in the\n"
-              << "   database\n"
+              << "   database, all records are inserted or none\n"
               << " > OPEN <name>\n"
               << "   Load a table from its file\n"
               << " > CLOSE <name>\n"
               << "   Save a table in its file\n"
+              << " > SAVE DATABASE '<file>'\n"
+              << "   Save all tables with their structure in a\n"
+              << "   single binary snapshot file\n"
+              << " > LOAD DATABASE '<file>'\n"
+              << "   Load all tables of a snapshot file\n"
+              << " > SOURCE '<file>'\n"
+              << "   Run the commands of a script file, one per\n"
+              << "   line, consecutive INSERT commands of a table\n"
+              << "   are inserted as a single batch, a script is\n"
+              << "   undone if a command fails\n"
+              << " > BEGIN\n"
+              << "   Start a transaction, the changes of INSERT,\n"
+              << "   REMOVE and UPDATE are kept in an undo log\n"
+              << " > COMMIT | ROLLBACK\n"
+              << "   Keep or undo the changes of the transaction,\n"
+              << "   OPEN, CLOSE, CREATETABLE, DROPTABLE, VACUUM,\n"
+              << "   SAVE, LOAD, CREATE, DROP and CHECKPOINT keep\n"
+              << "   the changes before them\n"
               << " #  MESSAGES\n"
               << "(V) Information message\n"
               << "    Successfully performed an operation\n"
@@ -182,10 +322,28 @@ void CommandLine::helpInfo() const {
 }
 
 Table* CommandLine::getTableByName(std::string tableName) {
-    for (std::vector<Table*>::iterator it = database.tables.begin(); it != database.tables.end(); ++it) {
-        if ((*it)->getTableName() == tableName) return (*it);
+    return getTableById(database.findTableId(tableName));
+}
+
+MaterializedView* CommandLine::getViewByName(const std::string& viewName) const {
+    return database.getView(viewName);
+}
+
+int CommandLine::getTableId(const std::string& tableName) const {
+    return database.findTableId(tableName);
+}
+
+Table* CommandLine::getTableById(int tableId) {
+    if (!database.getTable(tableId)) return nullptr;
+    waitForFlush(tableId);  // The table is used only after its background write
+    Table* selectedTable = database.getTable(tableId);
+    tableLastUse[tableId] = commandCounter;
+    if (evictedTables.erase(tableId) > 0) selectedTable = openTable(tableId);  // Loaded again on the first use after the eviction
+    if (inTransaction && !selectedTable->getLogging()) {  // The changes of the transaction can be undone
+        selectedTable->beginLogging();
+        transactionTables.insert(tableId);
     }
-    return nullptr;
+    return selectedTable;
 }
 
 void CommandLine::createTable() {
@@ -193,10 +351,11 @@ void CommandLine::createTable() {
     for (unsigned int i = 0; !isEmptySpace(commandLineInput[i]) && i < commandLineInput.size(); ++i)
         tableName.push_back(commandLineInput[i]);
 
+    if (database.getView(tableName)) throw std::invalid_argument("[!] A view with the same name exists!");
     Table* selectedTable = getTableByName(tableName);
     if (!selectedTable) {
-        database.tables.push_back(new Table(tableName));
-        selectedTable = database.tables.back();
+        selectedTable = new Table(tableName);
+        tableLastUse[database.addTable(selectedTable)] = commandCounter;
     }
 
     std::string fieldName;
@@ -224,6 +383,7 @@ void CommandLine::createTable() {
             bool fieldNotNull = false;
             bool fieldIsIndex = false;
             std::string fieldDefault = "";
+            IndexType fieldIndexType = IndexType::AVL;
 
             for (unsigned int j = 0; j < (int)(FieldType::COUNTFIELDTYPE); ++j) {
                 if (toUpperString(fieldParameters[0]) == FieldTypeList[j]) fieldType = j;
@@ -232,10 +392,14 @@ void CommandLine::createTable() {
             for (unsigned int j = 0; j < fieldParameters.size(); ++j) {
                 if (toUpperString(fieldParameters[j]) == "NOTNULL") fieldNotNull = true;
                 if (toUpperString(fieldParameters[j]) == "INDEX") fieldIsIndex = true;
+                if (toUpperString(fieldParameters[j]) == "BPTREE") {
+                    fieldIsIndex = true;
+                    fieldIndexType = IndexType::BPTREE;
+                }
                 if (toUpperString(fieldParameters[j]) == "DEFAULT" && j + 1 < fieldParameters.size()) fieldDefault = fieldParameters[j + 1];
             }
 
-            selectedTable->addField(fieldName, (FieldType)fieldType, fieldNotNull, fieldIsIndex, fieldDefault);
+            selectedTable->addField(fieldName, (FieldType)fieldType, fieldNotNull, fieldIsIndex, fieldDefault, fieldIndexType);
 
             fieldName.clear();
             datum.clear();
@@ -264,25 +428,36 @@ void CommandLine::dropTable() {
     for (unsigned int i = 0; !isEmptySpace(commandLineInput[i]) && i < commandLineInput.size(); ++i)
         tableName.push_back(commandLineInput[i]);
 
-    bool flagDeleted = false;
-    for (unsigned int i = 0; i < database.tables.size(); ++i) {
-        if (database.tables[i]->getTableName() == tableName) {
-            database.tables.erase(database.tables.begin() + i);
-            flagDeleted = true;
-            break;
-        }
-    }
-
-    if (!flagDeleted) throw std::invalid_argument("[!] Unable to delete the table!");
+    int tableId = database.findTableId(tableName);
+    if (!database.tableViews(tableName).empty()) throw std::invalid_argument("[!] Unable to delete the table! DROP VIEW its views first!");
+    waitForFlush(tableId);
+    if (!database.dropTable(tableName)) throw std::invalid_argument("[!] Unable to delete the table!");
+    tableLastUse.erase(tableId);
+    evictedTables.erase(tableId);
+    checkpointVersions.erase(tableId);
 
     std::cout << "(V) A table is removed from the database!" << std::endl;
 }
 
 void CommandLine::listTables() {
-    std::cout << "Number of tables in the database: " << database.tables.size() << std::endl;
-    for (unsigned int i = 0; i < database.tables.size(); ++i) {
-        std::cout << "  " << database.tables[i]->getTableName() << std::endl;
+    std::cout << "Number of tables in the database: " << database.countTables() << std::endl;
+    size_t usedMemory = 0;
+    for (int tableId = 0; tableId < database.countTableIds(); ++tableId) {
+        Table* currentTable = database.getTable(tableId);
+        if (!currentTable) continue;
+        std::cout << "  " << currentTable->getTableName();
+        if (evictedTables.count(tableId) > 0) {
+            std::cout << " (evicted)" << std::endl;
+        } else if (currentTable->getSaved()) {
+            std::cout << " (closed)" << std::endl;
+        } else {
+            usedMemory += currentTable->memoryBytes();
+            std::cout << " " << currentTable->memoryBytes() << "bytes" << std::endl;
+        }
     }
+    std::cout << "Memory of the open tables: " << usedMemory << "bytes";
+    if (memoryLimit > 0) std::cout << " of " << memoryLimit << "bytes";
+    std::cout << std::endl;
 }
 
 void CommandLine::tableInfo() {
@@ -300,6 +475,7 @@ void CommandLine::insertRecord() {
     std::string tableName;
     std::string datum;
     std::vector<std::string> recordData;
+    std::vector<std::vector<std::string>> recordsData;
     bool flagQuotes = false;
 
     for (unsigned int i = 0; !isEmptySpace(commandLineInput[i]) && i < commandLineInput.size(); ++i)
@@ -321,34 +497,32 @@ void CommandLine::insertRecord() {
         }
         if (commandLineInput[i] == ')') {
             if (!datum.empty()) recordData.push_back(datum);
-            if (!recordData.empty()) selectedTable->addRecord(recordData);
+            if (!recordData.empty()) recordsData.push_back(recordData);
             recordData.clear();
             datum.clear();
             continue;
         }
         if (!isEmptySpace(commandLineInput[i])) datum.push_back(commandLineInput[i]);
     }
+    selectedTable->addRecords(recordsData);
 
     if (!loading) std::cout << "(V) Inserted record in the database!" << std::endl;
 }
 
-void CommandLine::selectRecords() {
+SelectQuery CommandLine::parseSelect(const std::string& selectText) const {
     std::string datum;
-    std::vector<std::string> selectParameters;
-    std::vector<std::string> selectedColumns;  // 0
-    std::vector<std::string> distinctColumns;  // 1
-    std::vector<std::string> orderByColumns;   // 2
-    std::string tableName;
-    std::vector<std::string> whereParameters;  // 3
+    SelectQuery selectQuery;
+    std::vector<std::string>& selectParameters = selectQuery.selectParameters;
 
-    for (unsigned int i = 0; i < commandLineInput.size(); ++i) {
-        if (commandLineInput[i] == ',' || commandLineInput[i] == ' ' || commandLineInput[i] == '\n') {
+    for (unsigned int i = 0; i < selectText.size(); ++i) {
+        if (selectText[i] == ',' || selectText[i] == ' ' || selectText[i] == '\n') {
             if (!datum.empty()) selectParameters.push_back(datum);
             datum.clear();
             continue;
         }
-        if (!isEmptySpace(commandLineInput[i])) datum.push_back(commandLineInput[i]);
+        if (!isEmptySpace(selectText[i])) datum.push_back(selectText[i]);
     }
+    if (!datum.empty()) selectParameters.push_back(datum);
 
     int flagColumns = 0;
     for (unsigned int i = 0; i < selectParameters.size(); ++i) {
@@ -361,32 +535,230 @@ void CommandLine::selectRecords() {
             continue;
         }
         if (toUpperString(selectParameters[i]) == "FROM") {
-            tableName = selectParameters[++i];
+            if (i + 1 < selectParameters.size()) selectQuery.tableName = selectParameters[++i];
             continue;
         }
         if (toUpperString(selectParameters[i]) == "WHERE") {
             flagColumns = 3;
             continue;
         }
+        if (toUpperString(selectParameters[i]) == "GROUPBY") {
+            flagColumns = 4;
+            continue;
+        }
+        if (toUpperString(selectParameters[i]) == "JOIN" && i + 1 < selectParameters.size()) {
+            selectQuery.joinTableName = selectParameters[++i];
+            continue;
+        }
+        if (toUpperString(selectParameters[i]) == "ON") {
+            flagColumns = 5;
+            continue;
+        }
+        if (toUpperString(selectParameters[i]) == "LIMIT" || toUpperString(selectParameters[i]) == "OFFSET") {
+            if (i + 1 >= selectParameters.size() || selectParameters[i + 1].empty() || !isNumber(selectParameters[i + 1])) {
+                throw std::invalid_argument("[!] Invalid selection structure! LIMIT and OFFSET require a number!");
+            }
+            if (toUpperString(selectParameters[i]) == "LIMIT") {
+                selectQuery.limitRecords = stoi(selectParameters[++i]);
+            } else {
+                selectQuery.offsetRecords = stoi(selectParameters[++i]);
+            }
+            continue;
+        }
 
-        if (flagColumns == 0) selectedColumns.push_back(selectParameters[i]);
-        if (flagColumns == 1) distinctColumns.push_back(selectParameters[i]);
-        if (flagColumns == 2) orderByColumns.push_back(selectParameters[i]);
-        if (flagColumns == 3) whereParameters.push_back(selectParameters[i]);
+        if (flagColumns == 0) selectQuery.selectedColumns.push_back(selectParameters[i]);
+        if (flagColumns == 1) selectQuery.distinctColumns.push_back(selectParameters[i]);
+        if (flagColumns == 2) selectQuery.orderByColumns.push_back(selectParameters[i]);
+        if (flagColumns == 3) selectQuery.whereParameters.push_back(selectParameters[i]);
+        if (flagColumns == 4) selectQuery.groupByColumns.push_back(selectParameters[i]);
+        if (flagColumns == 5) selectQuery.joinParameters.push_back(selectParameters[i]);
     }
+    return selectQuery;
+}
 
-    Table* selectedTable = getTableByName(tableName);
+void CommandLine::selectRecords() {
+    QueryProfiler* profiler = activeProfiler;
+
+    if (profiler) profiler->startStage("Parse", -1);
+    SelectQuery selectQuery = parseSelect(commandLineInput);
+    const std::vector<std::string>& selectParameters = selectQuery.selectParameters;
+    const std::vector<std::string>& selectedColumns = selectQuery.selectedColumns;
+    const std::vector<std::string>& distinctColumns = selectQuery.distinctColumns;
+    const std::vector<std::string>& orderByColumns = selectQuery.orderByColumns;
+    const std::vector<std::string>& whereParameters = selectQuery.whereParameters;
+    const std::vector<std::string>& groupByColumns = selectQuery.groupByColumns;
+    int limitRecords = selectQuery.limitRecords;
+    int offsetRecords = selectQuery.offsetRecords;
+
+    MaterializedView* selectedView = database.getView(selectQuery.tableName);
+    if (selectedView) {
+        if (profiler) profiler->endStage(-1);
+        selectView(selectedView, selectQuery);
+        return;
+    }
+    Table* selectedTable = getTableByName(selectQuery.tableName);
     if (!selectedTable) throw std::invalid_argument("[!] Unable to find selected table!");
+    if (profiler) profiler->endStage(-1);
+
+    std::string queryKey;  // Normalized query with the versions of its tables
+    if (queryCache.isEnabled()) {
+        const std::vector<std::string> keywords = {"DISTINCT", "ORDERBY", "FROM", "WHERE", "GROUPBY", "JOIN", "ON", "LIMIT", "OFFSET", "AND", "OR", "NOT"};
+        for (unsigned int i = 0; i < selectParameters.size(); ++i) {
+            std::string keyword = toUpperString(selectParameters[i]);
+            bool isKeyword = std::find(keywords.begin(), keywords.end(), keyword) != keywords.end();
+            queryKey += (isKeyword ? keyword : selectParameters[i]) + " ";
+        }
+        queryKey += "#" + std::to_string(selectedTable->getTableVersion());
+        Table* joinTable = getTableByName(selectQuery.joinTableName);
+        if (joinTable) queryKey += "#" + std::to_string(joinTable->getTableVersion());
+
+        std::vector<std::vector<std::string>> cachedRows;
+        if (profiler) profiler->startStage("Cache lookup", -1);
+        bool flagCached = queryCache.lookup(queryKey, cachedRows);
+        if (profiler) profiler->endStage(flagCached ? cachedRows.size() - 1 : 0);
+        if (flagCached) {
+            printProfiledRows(cachedRows);
+            return;
+        }
+    }
 
-    std::list<Record*> selectedRecords = selectedTable->selectRecords(distinctColumns, orderByColumns, whereParameters);
-    if (distinctColumns.empty()) {
-        printDatabase(selectedTable, selectedRecords, selectedColumns);
-    } else {
-        printDatabase(selectedTable, selectedRecords, distinctColumns);
+    std::unique_ptr<Table> joinedTable;
+    if (!selectQuery.joinTableName.empty()) {
+        if (profiler) profiler->startStage("Join", selectedTable->getTableNumberOfRecords());
+        joinedTable.reset(joinTables(selectedTable, selectQuery.joinTableName, selectQuery.joinParameters));
+        selectedTable = joinedTable.get();
+        if (profiler) profiler->endStage(selectedTable->getTableNumberOfRecords());
     }
+
+    bool flagAggregate = !groupByColumns.empty();
+    for (unsigned int i = 0; i < selectedColumns.size(); ++i) {
+        AggregateType aggregateType = AggregateType::UNDEFINED;
+        std::string columnName;
+        if (parseAggregate(selectedColumns[i], aggregateType, columnName)) flagAggregate = true;
+    }
+    if (flagAggregate) {
+        if (profiler) profiler->startStage("Aggregate", selectedTable->getTableNumberOfRecords());
+        std::vector<std::vector<std::string>> aggregatedRows = selectedTable->aggregateRecords(selectedColumns, groupByColumns, whereParameters);
+        limitRows(aggregatedRows, limitRecords, offsetRecords);
+        if (profiler) profiler->endStage(aggregatedRows.size() - 1);
+        queryCache.store(queryKey, aggregatedRows);
+        printProfiledRows(aggregatedRows);
+        return;
+    }
+
+    std::vector<unsigned int> rowIds = selectedTable->selectRowIds(distinctColumns, orderByColumns, whereParameters, limitRecords, offsetRecords, profiler);
+    if (profiler) profiler->startStage("Format", rowIds.size());
+    std::vector<std::vector<std::string>> selectedRows = formatRows(selectedTable, rowIds, distinctColumns.empty() ? selectedColumns : distinctColumns);
+    if (profiler) profiler->endStage(selectedRows.size() - 1);
+    queryCache.store(queryKey, selectedRows);
+    printProfiledRows(selectedRows);
 }
 
-void CommandLine::printDatabase(Table* selectedTable, std::list<Record*> selectedRecords, std::vector<std::string> selectedColumns) {
+void CommandLine::selectView(MaterializedView* selectedView, const SelectQuery& selectQuery) {
+    if (selectQuery.selectedColumns.size() != 1 || selectQuery.selectedColumns[0] != "*" || !selectQuery.distinctColumns.empty() ||
+        !selectQuery.orderByColumns.empty() || !selectQuery.whereParameters.empty() || !selectQuery.groupByColumns.empty() ||
+        !selectQuery.joinTableName.empty()) {
+        throw std::invalid_argument("[!] Invalid selection structure! Use SELECT * FROM <view> [LIMIT <number>] [OFFSET <number>]!");
+    }
+    if (activeProfiler) activeProfiler->startStage("View " + selectedView->getViewName(), selectedView->countRows());
+    std::vector<std::vector<std::string>> viewRows = selectedView->viewRows();  // The stored result, the table is not scanned
+    limitRows(viewRows, selectQuery.limitRecords, selectQuery.offsetRecords);
+    if (activeProfiler) activeProfiler->endStage(viewRows.size() - 1);
+    printProfiledRows(viewRows);
+}
+
+void CommandLine::createView() {
+    std::string datum;
+    std::vector<std::string> viewParameters;
+    unsigned int position = 0;
+    for (; position < commandLineInput.size() && viewParameters.size() < 4; ++position) {  // VIEW <name> AS SELECT
+        if (isEmptySpace(commandLineInput[position])) {
+            if (!datum.empty()) viewParameters.push_back(datum);
+            datum.clear();
+            continue;
+        }
+        datum.push_back(commandLineInput[position]);
+    }
+    if (viewParameters.size() != 4 || toUpperString(viewParameters[0]) != "VIEW" || toUpperString(viewParameters[2]) != "AS" ||
+        toUpperString(viewParameters[3]) != "SELECT") {
+        throw std::invalid_argument("[!] Invalid view! Use CREATE VIEW <name> AS SELECT <fields> FROM <name> [WHERE <condition>] [GROUPBY <fields>]!");
+    }
+    std::string viewName = viewParameters[1];
+    if (database.getView(viewName) || getTableId(viewName) >= 0) throw std::invalid_argument("[!] A table or a view with the same name exists!");
+
+    SelectQuery selectQuery = parseSelect(commandLineInput.substr(std::min((size_t)position, commandLineInput.size())));
+    if (!selectQuery.distinctColumns.empty() || !selectQuery.orderByColumns.empty() || !selectQuery.joinTableName.empty() ||
+        selectQuery.limitRecords >= 0 || selectQuery.offsetRecords > 0) {
+        throw std::invalid_argument("[!] Invalid view! DISTINCT, ORDERBY, JOIN, LIMIT and OFFSET are not supported in a view!");
+    }
+    Table* selectedTable = getTableByName(selectQuery.tableName);
+    if (!selectedTable) throw std::invalid_argument("[!] Unable to find selected table!");
+
+    database.addView(new MaterializedView(viewName, selectedTable, selectQuery.selectedColumns, selectQuery.groupByColumns, selectQuery.whereParameters));
+    std::cout << "(V) New view created!" << std::endl;
+}
+
+void CommandLine::dropView() {
+    std::string datum;
+    std::vector<std::string> viewParameters;
+    for (unsigned int i = 0; i < commandLineInput.size(); ++i) {
+        if (isEmptySpace(commandLineInput[i])) {
+            if (!datum.empty()) viewParameters.push_back(datum);
+            datum.clear();
+            continue;
+        }
+        datum.push_back(commandLineInput[i]);
+    }
+    if (!datum.empty()) viewParameters.push_back(datum);
+    if (viewParameters.size() != 2 || toUpperString(viewParameters[0]) != "VIEW") throw std::invalid_argument("[!] Invalid command! Use DROP VIEW <name>!");
+    if (!database.dropView(viewParameters[1])) throw std::invalid_argument("[!] Unable to find selected view!");
+
+    std::cout << "(V) A view is removed from the database!" << std::endl;
+}
+
+void CommandLine::printProfiledRows(const std::vector<std::vector<std::string>>& printedRows) {
+    if (activeProfiler) activeProfiler->startStage("Print", printedRows.size() - 1);
+    printRows(printedRows);
+    if (activeProfiler) activeProfiler->endStage(printedRows.size() - 1);
+}
+
+void CommandLine::limitRows(std::vector<std::vector<std::string>>& rows, int limitRecords, int offsetRecords) {
+    size_t skippedRows = (offsetRecords > 0) ? std::min((size_t)offsetRecords, rows.size() - 1) : 0;
+    rows.erase(rows.begin() + 1, rows.begin() + 1 + skippedRows);
+    if (limitRecords < 0) return;
+    size_t keptRows = (size_t)limitRecords + 1;  // The header and the records of the LIMIT
+    if (keptRows < rows.size()) rows.resize(keptRows);
+}
+
+Table* CommandLine::joinTables(Table* selectedTable, std::string joinTableName, std::vector<std::string> joinParameters) {
+    Table* joinTable = getTableByName(joinTableName);
+    if (!joinTable) throw std::invalid_argument("[!] Unable to find selected table!");
+    if (joinParameters.size() != 3 || joinParameters[1] != "=") {
+        throw std::invalid_argument("[!] Invalid join! Use JOIN <name> ON <name>.<field> = <name>.<field>!");
+    }
+
+    int columnIndex = -1, joinColumnIndex = -1;
+    for (unsigned int i = 0; i < 3; i += 2) {  // Qualified field names <table>.<field>
+        size_t separator = joinParameters[i].find('.');
+        if (separator == std::string::npos) throw std::invalid_argument("[!] Invalid join! The fields should be qualified with their table names!");
+        std::string qualifier = joinParameters[i].substr(0, separator);
+        std::string fieldName = joinParameters[i].substr(separator + 1);
+        if (qualifier == selectedTable->getTableName() && columnIndex < 0) {
+            columnIndex = selectedTable->getFieldIndexByName(fieldName);
+        } else if (qualifier == joinTable->getTableName()) {
+            joinColumnIndex = joinTable->getFieldIndexByName(fieldName);
+        }
+    }
+    if (columnIndex < 0 || joinColumnIndex < 0) throw std::invalid_argument("[!] Invalid join! Unable to find the joined fields!");
+
+    return selectedTable->joinTables(joinTable, columnIndex, joinColumnIndex);
+}
+
+void CommandLine::printDatabase(Table* selectedTable, const std::vector<unsigned int>& rowIds, std::vector<std::string> selectedColumns) {
+    printRows(formatRows(selectedTable, rowIds, selectedColumns));
+}
+
+std::vector<std::vector<std::string>> CommandLine::formatRows(Table* selectedTable, const std::vector<unsigned int>& rowIds, std::vector<std::string> selectedColumns) {
     std::vector<int> columnsIndex;
     int colIndex = 0;
 
@@ -401,26 +773,43 @@ void CommandLine::printDatabase(Table* selectedTable, std::list<Record*> selecte
         }
     }
 
+    std::vector<std::vector<std::string>> printedRows(1);
+    for (unsigned int i = 0; i < columnsIndex.size(); ++i) {
+        printedRows[0].push_back(selectedTable->fieldName(columnsIndex[i]));
+    }
+    printedRows.reserve(rowIds.size() + 1);
+    for (unsigned int row = 0; row < rowIds.size(); ++row) {  // The records are read only for the selected columns of the final rows
+        Record* selectedRecord = selectedTable->getRecord(rowIds[row]);
+        printedRows.push_back(std::vector<std::string>());
+        printedRows.back().reserve(columnsIndex.size());
+        for (unsigned int i = 0; i < columnsIndex.size(); ++i) {
+            printedRows.back().push_back(selectedRecord->getData(columnsIndex[i])->getValueUniform());
+        }
+    }
+    return printedRows;
+}
+
+void CommandLine::printRows(const std::vector<std::vector<std::string>>& printedRows) {
     std::vector<int> printSizes;
     int fullSize = 0;
 
-    for (unsigned int i = 0; i < columnsIndex.size(); ++i) {
-        printSizes.push_back(selectedTable->fieldName(columnsIndex[i]).size());
+    for (unsigned int i = 0; i < printedRows[0].size(); ++i) {
+        printSizes.push_back(printedRows[0][i].size());
     }
 
-    for (std::list<Record*>::iterator it = selectedRecords.begin(); it != selectedRecords.end(); ++it) {
-        for (unsigned int i = 0; i < columnsIndex.size(); ++i) {
-            int strSize = (*it)->getData(columnsIndex[i])->getValueUniform().size();
+    for (unsigned int row = 1; row < printedRows.size(); ++row) {
+        for (unsigned int i = 0; i < printSizes.size(); ++i) {
+            int strSize = printedRows[row][i].size();
             if (printSizes[i] < strSize) {
                 printSizes[i] = strSize;
             }
         }
     }
 
-    for (unsigned int i = 0; i < columnsIndex.size(); ++i) {
+    for (unsigned int i = 0; i < printSizes.size(); ++i) {
         std::cout << "|";
         std::cout.width(printSizes[i]);
-        std::cout << selectedTable->fieldName(columnsIndex[i]);
+        std::cout << printedRows[0][i];
         fullSize += printSizes[i];
     }
     std::cout << "|\n";
@@ -430,11 +819,11 @@ void CommandLine::printDatabase(Table* selectedTable, std::list<Record*> selecte
     for (unsigned int i = 0; i < fullSize; ++i) std::cout << "-";
     std::cout << std::endl;
 
-    for (std::list<Record*>::iterator it = selectedRecords.begin(); it != selectedRecords.end(); ++it) {
-        for (unsigned int i = 0; i < columnsIndex.size(); ++i) {
+    for (unsigned int row = 1; row < printedRows.size(); ++row) {
+        for (unsigned int i = 0; i < printSizes.size(); ++i) {
             std::cout << "|";
             std::cout.width(printSizes[i]);
-            std::cout << (*it)->getData(columnsIndex[i])->getValueUniform();
+            std::cout << printedRows[row][i];
         }
         std::cout << "|" << std::endl;
     }
@@ -445,20 +834,13 @@ void CommandLine::closeInfile() {
     for (unsigned int i = 0; !isEmptySpace(commandLineInput[i]) && i < commandLineInput.size(); ++i)
         tableName.push_back(commandLineInput[i]);
 
+    if (evictedTables.erase(getTableId(tableName)) > 0) {  // Already in its file
+        std::cout << "(V) Table colsed!" << std::endl;
+        return;
+    }
     Table* selectedTable = getTableByName(tableName);
     if (!selectedTable) throw std::invalid_argument("[!] Unable to find selected table!");
-
-    std::string fileName = tableName + ".txt";
-    std::ofstream fileOutput;
-    fileOutput.open(fileName, std::ios::out);
-    if (!fileOutput.is_open()) {
-        throw std::invalid_argument("[!] Unable to open the file!");
-    }
-    fileOutput << selectedTable->tableDefinition();
-    fileOutput << selectedTable->recordDefinition();
-    fileOutput.close();
-    selectedTable->cleanTable();
-    selectedTable->setSaved();
+    if (!selectedTable->getSaved()) closeTable(getTableId(tableName));  // A closed table keeps its file
 
     std::cout << "(V) Table colsed!" << std::endl;
 }
@@ -468,29 +850,372 @@ void CommandLine::loadFromFile() {
     for (unsigned int i = 0; !isEmptySpace(commandLineInput[i]) && i < commandLineInput.size(); ++i)
         tableName.push_back(commandLineInput[i]);
 
-    Table* selectedTable = getTableByName(tableName);
+    bool flagEvicted = evictedTables.count(getTableId(tableName)) > 0;
+    Table* selectedTable = getTableByName(tableName);  // An evicted table is loaded by the search
     if (!selectedTable) throw std::invalid_argument("[!] Unable to find selected table!");
-    std::string fileName = tableName + ".txt";
+
+    std::ifstream binaryInput(tableName + ".sdp", std::ios::in | std::ios::binary);
+    if (flagEvicted || binaryInput.is_open()) {
+        binaryInput.close();
+        if (!flagEvicted && !selectedTable->getSaved() && selectedTable->getTableNumberOfRecords() > 0)  // The file is older than the records
+            throw std::invalid_argument("[!] The table is already open! CLOSE it before loading its file!");
+        if (!flagEvicted) openTable(getTableId(tableName));
+        std::cout << "(V) Table loaded!" << std::endl;
+        return;
+    }
+
+    std::string fileName = tableName + ".txt";  // Tables closed before the binary form
     std::ifstream fileInput;
     fileInput.open(fileName, std::ios::in);
     if (!fileInput.is_open()) {
         throw std::invalid_argument("[!] Unable to open the file!");
     }
 
+    std::vector<MaterializedView*> tableViews = database.tableViews(tableName);
+    for (unsigned int i = 0; i < tableViews.size(); ++i) tableViews[i]->detachTable();  // The replayed records are not added twice
+
     loading = true;
-    std::string singleCommand;
-    std::getline(fileInput, singleCommand, '\n');
-    while (!fileInput.eof()) {
-        std::getline(fileInput, singleCommand, '\n');
-        CommandLineDirectInput(singleCommand.c_str());
+    std::vector<ScriptCommand> scriptCommands = parseScript(fileInput);  // The records of the file are inserted in batches
+    fileInput.close();
+    for (unsigned int i = 0; i < scriptCommands.size(); ++i) {
+        if (scriptCommands[i].lineNumber > 1) CommandLineDirectInput(scriptCommands[i].commandText.c_str());  // The table is already created
     }
+    if (selectedTable->getLogging()) selectedTable->commitLog();  // The loaded records are not undone by a transaction
 
-    fileInput.close();
     selectedTable->setLoaded();
     loading = false;
+    for (unsigned int i = 0; i < tableViews.size(); ++i) tableViews[i]->attachTable(selectedTable);
     std::cout << "(V) Table loaded!" << std::endl;
 }
 
+std::vector<ScriptCommand> CommandLine::parseScript(std::istream& scriptInput) const {
+    std::vector<ScriptCommand> scriptCommands;
+    std::string batchTable;  // Table of the last command if it is an INSERT
+    std::string singleCommand;
+    for (int lineNumber = 1; std::getline(scriptInput, singleCommand, '\n'); ++lineNumber) {
+        unsigned int begin = 0, end = singleCommand.size();
+        while (begin < end && isEmptySpace(singleCommand[begin])) ++begin;
+        while (end > begin && (isEmptySpace(singleCommand[end - 1]) || singleCommand[end - 1] == '\r' || singleCommand[end - 1] == ';')) --end;
+        if (begin == end || singleCommand.compare(begin, 2, "--") == 0) continue;  // Empty lines and comments
+        singleCommand = singleCommand.substr(begin, end - begin);
+
+        unsigned int nameBegin = 0;
+        while (nameBegin < singleCommand.size() && !isEmptySpace(singleCommand[nameBegin])) ++nameBegin;
+        std::string operationName = toUpperString(singleCommand.substr(0, nameBegin));
+        while (nameBegin < singleCommand.size() && isEmptySpace(singleCommand[nameBegin])) ++nameBegin;
+        unsigned int nameEnd = nameBegin;
+        while (nameEnd < singleCommand.size() && !isEmptySpace(singleCommand[nameEnd]) && singleCommand[nameEnd] != '(') ++nameEnd;
+        std::string tableName = singleCommand.substr(nameBegin, nameEnd - nameBegin);
+
+        if (operationName != "INSERT" || tableName.empty()) {
+            batchTable.clear();
+            scriptCommands.push_back({lineNumber, singleCommand});
+            continue;
+        }
+        if (tableName == batchTable) {  // The records are added to the batch of the previous INSERT
+            scriptCommands.back().commandText += " " + singleCommand.substr(nameEnd);
+            continue;
+        }
+        batchTable = tableName;
+        scriptCommands.push_back({lineNumber, singleCommand});
+    }
+    return scriptCommands;
+}
+
+void CommandLine::runScript(const std::string& fileName) {
+    std::ifstream scriptInput(fileName, std::ios::in);
+    if (!scriptInput.is_open()) throw std::invalid_argument("[!] Unable to open the script file!");
+    std::vector<ScriptCommand> scriptCommands = parseScript(scriptInput);
+    scriptInput.close();
+    if (!runningScripts.insert(fileName).second) throw std::invalid_argument("[!] The script " + fileName + " is already running!");
+
+    bool flagOwnTransaction = !inTransaction;  // A script outside of a transaction is committed as a whole
+    try {
+        for (unsigned int i = 0; i < scriptCommands.size() && !commandExit; ++i) {
+            if (flagOwnTransaction && !inTransaction) {  // Started again after a COMMIT or ROLLBACK of the script
+                inTransaction = true;
+                scriptTransaction = true;
+            }
+            try {
+                CommandLineDirectInput(scriptCommands[i].commandText.c_str());
+            } catch (const std::invalid_argument& e) {  // The line of the failed command is added to the error
+                throw std::invalid_argument(std::string(e.what()) + " (" + fileName + ", line " + std::to_string(scriptCommands[i].lineNumber) + ")");
+            } catch (const std::runtime_error& e) {
+                throw std::runtime_error(std::string(e.what()) + " (" + fileName + ", line " + std::to_string(scriptCommands[i].lineNumber) + ")");
+            }
+        }
+    } catch (...) {
+        runningScripts.erase(fileName);
+        if (flagOwnTransaction && scriptTransaction) {
+            rollbackTransaction();
+            inTransaction = scriptTransaction = false;
+        }
+        throw;
+    }
+    runningScripts.erase(fileName);
+    if (flagOwnTransaction && scriptTransaction) {
+        commitTransaction();
+        inTransaction = scriptTransaction = false;
+    }
+}
+
+void CommandLine::sourceScript() {
+    std::string fileName = commandLineInput;
+    while (!fileName.empty() && isEmptySpace(fileName.back())) fileName.pop_back();
+    while (!fileName.empty() && isEmptySpace(fileName.front())) fileName.erase(fileName.begin());
+    if (fileName.size() >= 2 && (fileName.front() == '\'' || fileName.front() == '\"') && fileName.back() == fileName.front()) {
+        fileName = fileName.substr(1, fileName.size() - 2);
+    }
+    if (fileName.empty()) throw std::invalid_argument("[!] Invalid script command! Use SOURCE '<file>'!");
+
+    runScript(fileName);
+    std::cout << "(V) Script executed!" << std::endl;
+}
+
+void CommandLine::beginTransaction() {
+    if (inTransaction && !scriptTransaction) throw std::invalid_argument("[!] A transaction is already running!");
+    if (scriptTransaction) commitTransaction();  // The commands of the script before BEGIN are kept
+    inTransaction = true;
+    scriptTransaction = false;
+    std::cout << "(V) Transaction started!" << std::endl;
+}
+
+void CommandLine::commitCommand() {
+    if (!inTransaction) throw std::invalid_argument("[!] There is no running transaction!");
+    commitTransaction();
+    inTransaction = scriptTransaction = false;
+    std::cout << "(V) Transaction committed!" << std::endl;
+}
+
+void CommandLine::rollbackCommand() {
+    if (!inTransaction) throw std::invalid_argument("[!] There is no running transaction!");
+    rollbackTransaction();
+    inTransaction = scriptTransaction = false;
+    std::cout << "(V) Transaction rolled back!" << std::endl;
+}
+
+void CommandLine::commitTransaction() {
+    for (std::unordered_set<int>::iterator it = transactionTables.begin(); it != transactionTables.end(); ++it) {
+        Table* currentTable = database.getTable(*it);
+        if (currentTable && currentTable->getLogging()) currentTable->commitLog();
+    }
+    transactionTables.clear();
+}
+
+void CommandLine::rollbackTransaction() {
+    for (std::unordered_set<int>::iterator it = transactionTables.begin(); it != transactionTables.end(); ++it) {
+        Table* currentTable = database.getTable(*it);
+        if (currentTable && currentTable->getLogging()) currentTable->rollbackLog();  // The views are updated by the undone changes
+    }
+    transactionTables.clear();
+}
+
+bool CommandLine::commitsTransaction(OperationType operationType) const {
+    switch (operationType) {
+        case OperationType::OPEN:
+        case OperationType::CLOSE:
+        case OperationType::CREATETABLE:
+        case OperationType::DROPTABLE:
+        case OperationType::VACUUM:
+        case OperationType::SAVE:
+        case OperationType::LOAD:
+        case OperationType::CREATE:
+        case OperationType::DROP:
+        case OperationType::CHECKPOINT:
+            return true;
+        default:
+            return false;
+    }
+}
+
+void CommandLine::closeTable(int tableId) {
+    waitForFlush(tableId);
+    Table* closedTable = database.getTable(tableId);
+    std::vector<MaterializedView*> tableViews = database.tableViews(closedTable->getTableName());
+    for (unsigned int i = 0; i < tableViews.size(); ++i) tableViews[i]->detachTable();  // The views keep their rows until the table is opened
+
+    // The records go to the writing thread, so the next commands do not wait for the file
+    Table* emptyTable = closedTable->emptyCopy();
+    emptyTable->setSaved();
+    database.swapTable(tableId, emptyTable);
+    std::string fileName = closedTable->getTableName() + ".sdp";
+    PendingFlush& pendingFlush = pendingFlushes[tableId];
+    pendingFlush.closedTable = closedTable;
+    pendingFlush.flushDone = std::async(std::launch::async, [closedTable, fileName]() {
+        saveSnapshot(fileName, {closedTable});  // The binary form with compressed INT and DATE columns
+        delete closedTable;                     // The memory is released once the file is complete
+    });
+}
+
+void CommandLine::checkpointTable(int tableId) {
+    waitForFlush(tableId);
+    Table* checkpointedTable = database.getTable(tableId);
+    checkpointVersions[tableId] = checkpointedTable->getTableVersion();
+    std::string fileName = checkpointedTable->getTableName() + ".sdp";
+    PendingFlush& pendingFlush = pendingFlushes[tableId];
+    pendingFlush.closedTable = nullptr;
+    pendingFlush.flushDone = std::async(std::launch::async, [checkpointedTable, fileName]() {
+        saveSnapshot(fileName, {checkpointedTable});  // Commands using the table wait, so the written records stay consistent
+    });
+}
+
+void CommandLine::waitForFlush(int tableId) {
+    std::unordered_map<int, PendingFlush>::iterator it = pendingFlushes.find(tableId);
+    if (it == pendingFlushes.end()) return;
+    PendingFlush pendingFlush = std::move(it->second);
+    pendingFlushes.erase(it);
+    try {
+        pendingFlush.flushDone.get();
+    } catch (...) {
+        if (pendingFlush.closedTable) {  // The records are not in the file, the table is open again
+            delete database.swapTable(tableId, pendingFlush.closedTable);
+            evictedTables.erase(tableId);
+            std::vector<MaterializedView*> tableViews = database.tableViews(pendingFlush.closedTable->getTableName());
+            for (unsigned int i = 0; i < tableViews.size(); ++i) tableViews[i]->attachTable(pendingFlush.closedTable);
+        } else {
+            checkpointVersions.erase(tableId);
+        }
+        throw;
+    }
+}
+
+void CommandLine::collectFlushes() {
+    std::vector<int> finishedIds;
+    for (std::unordered_map<int, PendingFlush>::iterator it = pendingFlushes.begin(); it != pendingFlushes.end(); ++it) {
+        if (it->second.flushDone.wait_for(std::chrono::seconds(0)) == std::future_status::ready) finishedIds.push_back(it->first);
+    }
+    for (unsigned int i = 0; i < finishedIds.size(); ++i) {
+        try {
+            waitForFlush(finishedIds[i]);
+        } catch (const std::exception& e) {
+            std::cout << e.what() << std::endl;
+        }
+    }
+}
+
+void CommandLine::finishFlushes() {
+    while (!pendingFlushes.empty()) {
+        try {
+            waitForFlush(pendingFlushes.begin()->first);
+        } catch (const std::exception& e) {
+            std::cout << e.what() << std::endl;
+        }
+    }
+}
+
+void CommandLine::checkpointChangedTables() {
+    for (int tableId = 0; tableId < database.countTableIds(); ++tableId) {
+        Table* currentTable = database.getTable(tableId);
+        if (!currentTable || currentTable->getSaved() || currentTable->getLogging() || pendingFlushes.count(tableId) > 0) continue;  // Changes of a transaction are not written
+        std::unordered_map<int, unsigned long long>::iterator checkpoint = checkpointVersions.find(tableId);
+        if (checkpoint != checkpointVersions.end() && checkpoint->second == currentTable->getTableVersion()) continue;
+        checkpointTable(tableId);
+    }
+}
+
+void CommandLine::checkpointTables() {
+    std::string tableName;
+    for (unsigned int i = 0; !isEmptySpace(commandLineInput[i]) && i < commandLineInput.size(); ++i)
+        tableName.push_back(commandLineInput[i]);
+
+    if (tableName.empty()) {
+        checkpointChangedTables();
+        std::cout << "(V) Checkpoint started!" << std::endl;
+        return;
+    }
+    Table* selectedTable = getTableByName(tableName);
+    if (!selectedTable) throw std::invalid_argument("[!] Unable to find selected table!");
+    if (selectedTable->getSaved()) throw std::invalid_argument("[!] The table is closed! Its file is already written!");
+    checkpointTable(getTableId(tableName));
+    std::cout << "(V) Checkpoint started!" << std::endl;
+}
+
+Table* CommandLine::openTable(int tableId) {
+    std::string tableName = database.getTable(tableId)->getTableName();
+    std::vector<Table*> loadedTables = loadSnapshot(tableName + ".sdp");
+    if (loadedTables.size() != 1 || loadedTables[0]->getTableName() != tableName) {
+        for (unsigned int i = 0; i < loadedTables.size(); ++i) delete loadedTables[i];
+        throw std::invalid_argument("[!] Invalid table file! The file holds another table!");
+    }
+    database.replaceTable(tableId, loadedTables[0]);  // The loaded table keeps the id of the closed one
+    std::vector<MaterializedView*> tableViews = database.tableViews(tableName);
+    for (unsigned int i = 0; i < tableViews.size(); ++i) tableViews[i]->attachTable(loadedTables[0]);  // The row ids of the loaded records are new
+    return loadedTables[0];
+}
+
+void CommandLine::enforceMemoryLimit() {
+    size_t usedMemory = 0;
+    for (int tableId = 0; tableId < database.countTableIds(); ++tableId) {
+        Table* currentTable = database.getTable(tableId);
+        if (currentTable && !currentTable->getSaved()) usedMemory += currentTable->memoryBytes();
+    }
+    while (usedMemory > memoryLimit) {
+        int coldestId = -1;
+        for (int tableId = 0; tableId < database.countTableIds(); ++tableId) {  // The tables of the last command stay open
+            Table* currentTable = database.getTable(tableId);
+            if (!currentTable || currentTable->getSaved() || currentTable->getLogging() || tableLastUse[tableId] == commandCounter) continue;
+            if (coldestId < 0 || tableLastUse[tableId] < tableLastUse[coldestId]) coldestId = tableId;
+        }
+        if (coldestId < 0) break;
+
+        Table* coldestTable = database.getTable(coldestId);
+        std::string coldestName = coldestTable->getTableName();
+        usedMemory -= coldestTable->memoryBytes();
+        closeTable(coldestId);
+        evictedTables.insert(coldestId);
+        std::cout << "(V) Table " << coldestName << " evicted to its file, the memory limit is reached!" << std::endl;
+    }
+}
+
+std::string CommandLine::snapshotFileName() {
+    std::string datum;
+    std::vector<std::string> snapshotParameters;
+    for (unsigned int i = 0; i < commandLineInput.size(); ++i) {
+        if (isEmptySpace(commandLineInput[i])) {
+            if (!datum.empty()) snapshotParameters.push_back(datum);
+            datum.clear();
+            continue;
+        }
+        datum.push_back(commandLineInput[i]);
+    }
+    if (!datum.empty()) snapshotParameters.push_back(datum);
+
+    if (snapshotParameters.size() != 2 || toUpperString(snapshotParameters[0]) != "DATABASE") {
+        throw std::invalid_argument("[!] Invalid snapshot command! Use SAVE DATABASE '<file>' or LOAD DATABASE '<file>'!");
+    }
+    std::string fileName = snapshotParameters[1];
+    if (fileName.size() >= 2 && (fileName.front() == '\'' || fileName.front() == '\"') && fileName.back() == fileName.front()) {
+        fileName = fileName.substr(1, fileName.size() - 2);
+    }
+    if (fileName.empty()) throw std::invalid_argument("[!] Invalid snapshot command! The file name is empty!");
+    return fileName;
+}
+
+void CommandLine::saveDatabase() {
+    std::string fileName = snapshotFileName();
+    for (int tableId = 0; tableId < database.countTableIds(); ++tableId) getTableById(tableId);  // Evicted tables are loaded again
+    std::vector<Table*> savedTables = database.allTables();
+    for (std::vector<Table*>::iterator it = savedTables.begin(); it != savedTables.end(); ++it) {
+        if ((*it)->getSaved()) throw std::invalid_argument("[!] The table " + (*it)->getTableName() + " is closed! OPEN it before saving the database!");
+    }
+    saveSnapshot(fileName, savedTables);
+    std::cout << "(V) Database saved!" << std::endl;
+}
+
+void CommandLine::loadDatabase() {
+    std::vector<Table*> loadedTables = loadSnapshot(snapshotFileName());
+    std::unordered_set<std::string> loadedNames;
+    for (unsigned int i = 0; i < loadedTables.size(); ++i) {  // Either all tables are loaded or none
+        if (getTableId(loadedTables[i]->getTableName()) >= 0 || !loadedNames.insert(loadedTables[i]->getTableName()).second) {
+            std::string tableName = loadedTables[i]->getTableName();
+            for (unsigned int j = 0; j < loadedTables.size(); ++j) delete loadedTables[j];
+            throw std::invalid_argument("[!] The table " + tableName + " already exists!");
+        }
+    }
+    for (unsigned int i = 0; i < loadedTables.size(); ++i) database.addTable(loadedTables[i]);
+    std::cout << "(V) Database loaded!" << std::endl;
+}
+
 void CommandLine::removeRecords() {
     std::string datum;
     std::vector<std::string> selectParameters;
@@ -525,4 +1250,192 @@ void CommandLine::removeRecords() {
     selectedTable->removeRecords(whereParameters);
 
     std::cout << "(V) Records removed!" << std::endl;
+}
+void CommandLine::updateRecords() {
+    std::string datum;
+    std::vector<std::string> updateParameters;
+    std::vector<std::string> setParameters;
+    std::vector<std::string> whereParameters;
+
+    for (unsigned int i = 0; i < commandLineInput.size(); ++i) {
+        if (commandLineInput[i] == ',' || commandLineInput[i] == ' ' || commandLineInput[i] == '\n') {
+            if (!datum.empty()) updateParameters.push_back(datum);
+            datum.clear();
+            continue;
+        }
+        if (!isEmptySpace(commandLineInput[i])) datum.push_back(commandLineInput[i]);
+    }
+    if (updateParameters.empty()) throw std::invalid_argument("[!] Unable to find selected table!");
+    std::string tableName = updateParameters[0];
+
+    int flagParameters = 0;
+    for (unsigned int i = 1; i < updateParameters.size(); ++i) {
+        if (toUpperString(updateParameters[i]) == "SET" && flagParameters == 0) {
+            flagParameters = 1;
+            continue;
+        }
+        if (toUpperString(updateParameters[i]) == "WHERE") {
+            flagParameters = 2;
+            continue;
+        }
+        if (flagParameters == 1) setParameters.push_back(updateParameters[i]);
+        if (flagParameters == 2) whereParameters.push_back(updateParameters[i]);
+    }
+
+    std::vector<std::string> setColumns;
+    std::vector<std::string> setValues;
+    if (setParameters.empty() || setParameters.size() % 3 != 0) throw std::invalid_argument("[!] Invalid update! Use SET <field> = <value>!");
+    for (unsigned int i = 0; i < setParameters.size(); i += 3) {
+        if (setParameters[i + 1] != "=") throw std::invalid_argument("[!] Invalid update! Use SET <field> = <value>!");
+        setColumns.push_back(setParameters[i]);
+        setValues.push_back(setParameters[i + 2]);
+    }
+
+    Table* selectedTable = getTableByName(tableName);
+    if (!selectedTable) throw std::invalid_argument("[!] Unable to find selected table!");
+
+    int updatedRecords = selectedTable->updateRecords(setColumns, setValues, whereParameters);
+
+    std::cout << "(V) Updated " << updatedRecords << " records!" << std::endl;
+}
+
+void CommandLine::analyzeTable() {
+    std::string tableName;
+    for (unsigned int i = 0; !isEmptySpace(commandLineInput[i]) && i < commandLineInput.size(); ++i)
+        tableName.push_back(commandLineInput[i]);
+
+    Table* selectedTable = getTableByName(tableName);
+    if (!selectedTable) throw std::invalid_argument("[!] Unable to find selected table!");
+
+    selectedTable->analyzeTable();
+    std::cout << selectedTable->statisticsInfo();
+    std::cout << "(V) Table analyzed!" << std::endl;
+}
+
+void CommandLine::vacuumTable() {
+    std::string tableName;
+    for (unsigned int i = 0; !isEmptySpace(commandLineInput[i]) && i < commandLineInput.size(); ++i)
+        tableName.push_back(commandLineInput[i]);
+
+    Table* selectedTable = getTableByName(tableName);
+    if (!selectedTable) throw std::invalid_argument("[!] Unable to find selected table!");
+
+    int removedRecords = selectedTable->getTableRemovedRecords();
+    if (selectedTable->getLogging()) selectedTable->commitLog();  // The transaction was committed before, the row ids change
+    selectedTable->vacuumTable();
+
+    std::cout << "(V) Table vacuumed! Reclaimed " << removedRecords << " records!" << std::endl;
+}
+
+void CommandLine::setOption() {
+    std::string datum;
+    std::vector<std::string> setParameters;
+    for (unsigned int i = 0; i < commandLineInput.size(); ++i) {
+        if (commandLineInput[i] == ' ' || commandLineInput[i] == '\n') {
+            if (!datum.empty()) setParameters.push_back(toUpperString(datum));
+            datum.clear();
+            continue;
+        }
+        if (!isEmptySpace(commandLineInput[i])) datum.push_back(commandLineInput[i]);
+    }
+    if (!datum.empty()) setParameters.push_back(toUpperString(datum));
+
+    if (setParameters.size() >= 2 && setParameters[0] == "CACHE") {
+        if (setParameters[1] == "OFF" && setParameters.size() == 2) {
+            queryCache.setEnabled(false);
+            std::cout << "(V) Query cache disabled!" << std::endl;
+            return;
+        }
+        if (setParameters[1] == "ON" && setParameters.size() <= 3) {
+            if (setParameters.size() == 3) {
+                if (setParameters[2].size() > 18 || !isNumber(setParameters[2])) throw std::invalid_argument("[!] Invalid setting! The cache size should be a number of bytes!");
+                queryCache.setCapacity(std::stoull(setParameters[2]));
+            }
+            queryCache.setEnabled(true);
+            std::cout << "(V) Query cache enabled!" << std::endl;
+            return;
+        }
+    }
+    if (setParameters.size() >= 2 && setParameters[0] == "PROFILING") {
+        if (setParameters[1] == "OFF" && setParameters.size() == 2) {
+            profilingEnabled = false;
+            std::cout << "(V) Profiling disabled!" << std::endl;
+            return;
+        }
+        if (setParameters[1] == "ON" && setParameters.size() <= 3) {
+            if (setParameters.size() == 3) {
+                if (setParameters[2].size() > 9 || !isNumber(setParameters[2])) throw std::invalid_argument("[!] Invalid setting! The threshold should be a number of milliseconds!");
+                slowQueryMilliseconds = std::stoi(setParameters[2]);
+            }
+            profilingEnabled = true;
+            std::cout << "(V) Profiling enabled! Commands slower than " << slowQueryMilliseconds << "ms are logged in " << SLOW_QUERY_LOG << std::endl;
+            return;
+        }
+    }
+    if (setParameters.size() == 2 && setParameters[0] == "MEMORYLIMIT") {
+        if (setParameters[1] == "OFF") {
+            memoryLimit = 0;
+            std::cout << "(V) Memory limit disabled!" << std::endl;
+            return;
+        }
+        if (setParameters[1].size() > 18 || !isNumber(setParameters[1]) || std::stoull(setParameters[1]) == 0) {
+            throw std::invalid_argument("[!] Invalid setting! The memory limit should be a number of bytes!");
+        }
+        memoryLimit = std::stoull(setParameters[1]);
+        std::cout << "(V) Memory limit set! The least recently used tables are evicted to their files above " << memoryLimit << "bytes" << std::endl;
+        return;
+    }
+    if (setParameters.size() == 2 && setParameters[0] == "CHECKPOINT") {
+        if (setParameters[1] == "OFF") {
+            checkpointInterval = 0;
+            std::cout << "(V) Checkpoints disabled!" << std::endl;
+            return;
+        }
+        if (setParameters[1].size() > 18 || !isNumber(setParameters[1]) || std::stoull(setParameters[1]) == 0) {
+            throw std::invalid_argument("[!] Invalid setting! The checkpoint interval should be a number of commands!");
+        }
+        checkpointInterval = std::stoull(setParameters[1]);
+        std::cout << "(V) Checkpoints enabled! The changed tables are written after every " << checkpointInterval << " commands" << std::endl;
+        return;
+    }
+    throw std::invalid_argument("[!] Invalid setting! Use SET CACHE ON [<bytes>] | OFF, SET PROFILING ON [<milliseconds>] | OFF, SET MEMORYLIMIT <bytes> | OFF or SET CHECKPOINT <commands> | OFF!");
+}
+
+void CommandLine::cacheStats() {
+    std::cout << queryCache.cacheInfo();
+}
+
+void CommandLine::explainQuery() {
+    std::string explainMode, operationName;
+    unsigned int position = 0;
+    for (; position < commandLineInput.size() && !isEmptySpace(commandLineInput[position]); ++position) explainMode.push_back(commandLineInput[position]);
+    for (++position; position < commandLineInput.size() && !isEmptySpace(commandLineInput[position]); ++position) operationName.push_back(commandLineInput[position]);
+    if (toUpperString(explainMode) != "ANALYZE" || toUpperString(operationName) != "SELECT") {
+        throw std::invalid_argument("[!] Invalid explain! Use EXPLAIN ANALYZE SELECT ...!");
+    }
+    commandLineInput.erase(0, std::min((size_t)position + 1, commandLineInput.size()));
+
+    queryProfiler.startQuery();
+    activeProfiler = &queryProfiler;
+    selectRecords();
+    activeProfiler = nullptr;
+
+    printRows(queryProfiler.profileRows());
+    std::cout << "(V) Query executed in " << queryProfiler.totalMilliseconds() << "ms!" << std::endl;
+}
+
+void CommandLine::logSlowQuery(std::string commandText) {
+    double totalMilliseconds = queryProfiler.totalMilliseconds();
+    if (totalMilliseconds < slowQueryMilliseconds) return;
+    while (!commandText.empty() && isEmptySpace(commandText.back())) commandText.pop_back();
+
+    std::ofstream slowQueryLog(SLOW_QUERY_LOG, std::ios::app);
+    if (!slowQueryLog.is_open()) return;
+    slowQueryLog << totalMilliseconds << "ms " << commandText << "\n";
+    std::vector<std::vector<std::string>> stageRows = queryProfiler.profileRows();
+    for (unsigned int row = 1; row < stageRows.size(); ++row) {
+        slowQueryLog << "   ";
+        for (unsigned int i = 0; i < stageRows[row].size(); ++i) slowQueryLog << " " << stageRows[0][i] << ": " << stageRows[row][i] << ";";
+        slowQueryLog << "\n";
+    }
 }
\ No newline at end of file
@@ -0,0 +1,224 @@
+#include "../Headers/compression.hpp"
+
+unsigned int CompressedBlock::bitsNeeded(unsigned long long value) {
+    unsigned int bits = 0;
+    while (value > 0) {
+        ++bits;
+        value >>= 1;
+    }
+    return bits;
+}
+
+unsigned int CompressedBlock::wordsNeeded(unsigned int packedCount, unsigned int width) {
+    return ((unsigned long long)packedCount * width + 63) / 64;
+}
+
+void CompressedBlock::packValues(const std::vector<unsigned long long>& values, unsigned int width) {
+    bitWidth = width;
+    packedWords.assign(wordsNeeded(values.size(), width), 0);
+    if (width == 0) return;
+    for (unsigned int i = 0; i < values.size(); ++i) {
+        unsigned long long bitPosition = (unsigned long long)i * width;
+        unsigned int word = bitPosition / 64, shift = bitPosition % 64;
+        packedWords[word] |= values[i] << shift;
+        if (shift + width > 64) packedWords[word + 1] |= values[i] >> (64 - shift);
+    }
+}
+
+void CompressedBlock::encode(const std::vector<int>& values) {
+    valuesCount = values.size();
+    plainValues.clear();
+    runEnds.clear();
+    packedWords.clear();
+    baseValue = 0;
+    deltaBase = 0;
+    bitWidth = 0;
+    maxOffset = 0;
+    if (values.empty()) {
+        compressionType = CompressionType::RAW;
+        return;
+    }
+
+    // Sizes of all encodings from a single pass, the smallest one is built
+    unsigned int runsCount = 1;
+    int minValue = values[0], maxValue = values[0];
+    long long minDelta = 0, maxDelta = 0;
+    for (unsigned int i = 1; i < values.size(); ++i) {
+        if (values[i] != values[i - 1]) ++runsCount;
+        minValue = std::min(minValue, values[i]);
+        maxValue = std::max(maxValue, values[i]);
+        long long delta = (long long)values[i] - values[i - 1];
+        if (i == 1 || delta < minDelta) minDelta = delta;
+        if (i == 1 || delta > maxDelta) maxDelta = delta;
+    }
+    unsigned int forWidth = bitsNeeded((unsigned long long)((long long)maxValue - minValue));
+    unsigned int deltaWidth = bitsNeeded((unsigned long long)(maxDelta - minDelta));
+
+    CompressionType bestType = CompressionType::RAW;
+    unsigned long long bestBytes = 4ULL * values.size();
+    if (8ULL * runsCount < bestBytes) {
+        bestType = CompressionType::RLE;
+        bestBytes = 8ULL * runsCount;
+    }
+    if (8ULL * wordsNeeded(values.size(), forWidth) < bestBytes) {
+        bestType = CompressionType::FOR;
+        bestBytes = 8ULL * wordsNeeded(values.size(), forWidth);
+    }
+    if (deltaWidth <= 32 && 8ULL * wordsNeeded(values.size() - 1, deltaWidth) < bestBytes) {
+        bestType = CompressionType::DELTA;
+        bestBytes = 8ULL * wordsNeeded(values.size() - 1, deltaWidth);
+    }
+
+    compressionType = bestType;
+    std::vector<unsigned long long> packed;
+    switch (compressionType) {
+        case CompressionType::RAW:
+            plainValues = values;
+            break;
+        case CompressionType::RLE:
+            for (unsigned int i = 0; i < values.size(); ++i) {
+                if (i > 0 && values[i] == values[i - 1]) {
+                    ++runEnds.back();
+                    continue;
+                }
+                plainValues.push_back(values[i]);
+                runEnds.push_back(i + 1);
+            }
+            break;
+        case CompressionType::FOR:
+            baseValue = minValue;
+            maxOffset = (unsigned int)((long long)maxValue - minValue);
+            packed.resize(values.size());
+            for (unsigned int i = 0; i < values.size(); ++i) packed[i] = (unsigned long long)((long long)values[i] - minValue);
+            packValues(packed, forWidth);
+            break;
+        case CompressionType::DELTA:
+            baseValue = values[0];
+            deltaBase = minDelta;
+            packed.resize(values.size() - 1);
+            for (unsigned int i = 1; i < values.size(); ++i) packed[i - 1] = (unsigned long long)((long long)values[i] - values[i - 1] - minDelta);
+            packValues(packed, deltaWidth);
+            break;
+        default:
+            break;
+    }
+}
+
+void CompressedBlock::decode(std::vector<int>& values) const {
+    values.resize(valuesCount);
+    switch (compressionType) {
+        case CompressionType::RAW:
+            values = plainValues;
+            break;
+        case CompressionType::RLE:
+            for (unsigned int run = 0, i = 0; run < runEnds.size(); ++run) {
+                for (; i < runEnds[run]; ++i) values[i] = plainValues[run];
+            }
+            break;
+        case CompressionType::FOR:
+            for (unsigned int i = 0; i < valuesCount; ++i) values[i] = (int)(baseValue + (long long)packedValue(i));
+            break;
+        case CompressionType::DELTA: {
+            long long value = baseValue;
+            for (unsigned int i = 0; i < valuesCount; ++i) {
+                if (i > 0) value += deltaBase + (long long)packedValue(i - 1);
+                values[i] = (int)value;
+            }
+            break;
+        }
+        default:
+            break;
+    }
+}
+
+unsigned int CompressedBlock::encodedBytes() const {
+    return plainValues.size() * sizeof(int) + runEnds.size() * sizeof(unsigned int) + packedWords.size() * sizeof(unsigned long long);
+}
+
+void CompressedBlock::writeBlock(std::string& buffer) const {
+    writeBinary(buffer, (unsigned int)compressionType, 1);
+    writeBinary(buffer, valuesCount, 4);
+    switch (compressionType) {
+        case CompressionType::RAW:
+            for (unsigned int i = 0; i < plainValues.size(); ++i) writeBinary(buffer, (unsigned int)plainValues[i], 4);
+            break;
+        case CompressionType::RLE:
+            writeBinary(buffer, runEnds.size(), 4);
+            for (unsigned int run = 0; run < runEnds.size(); ++run) {
+                writeBinary(buffer, (unsigned int)plainValues[run], 4);
+                writeBinary(buffer, runEnds[run], 4);
+            }
+            break;
+        case CompressionType::FOR:
+        case CompressionType::DELTA:
+            writeBinary(buffer, (unsigned int)baseValue, 4);
+            writeBinary(buffer, (unsigned long long)deltaBase, 8);
+            writeBinary(buffer, bitWidth, 1);
+            for (unsigned int i = 0; i < packedWords.size(); ++i) writeBinary(buffer, packedWords[i], 8);
+            break;
+        default:
+            break;
+    }
+}
+
+bool CompressedBlock::readBlock(const char*& position, const char* end) {
+    unsigned long long readType = 0, readCount = 0, value = 0, runsCount = 0;
+    if (!readBinary(position, end, readType, 1) || readType >= (int)(CompressionType::COUNTCOMPRESSIONTYPE) ||
+        !readBinary(position, end, readCount, 4)) {
+        return false;
+    }
+    compressionType = (CompressionType)readType;
+    valuesCount = readCount;
+    plainValues.clear();
+    runEnds.clear();
+    packedWords.clear();
+    baseValue = 0;
+    deltaBase = 0;
+    bitWidth = 0;
+    maxOffset = 0;
+
+    switch (compressionType) {
+        case CompressionType::RAW:
+            if (4ULL * valuesCount > (unsigned long long)(end - position)) return false;
+            plainValues.resize(valuesCount);
+            for (unsigned int i = 0; i < valuesCount; ++i) {
+                readBinary(position, end, value, 4);
+                plainValues[i] = (int)(unsigned int)value;
+            }
+            return true;
+        case CompressionType::RLE:  // The runs must cover all values in order
+            if (!readBinary(position, end, runsCount, 4) || 8ULL * runsCount > (unsigned long long)(end - position)) return false;
+            for (unsigned int run = 0; run < runsCount; ++run) {
+                readBinary(position, end, value, 4);
+                plainValues.push_back((int)(unsigned int)value);
+                readBinary(position, end, value, 4);
+                if (value <= (runEnds.empty() ? 0 : runEnds.back()) || value > valuesCount) return false;
+                runEnds.push_back(value);
+            }
+            return (runEnds.empty() ? 0 : runEnds.back()) == valuesCount;
+        case CompressionType::FOR:
+        case CompressionType::DELTA: {
+            if (!readBinary(position, end, value, 4)) return false;
+            baseValue = (int)(unsigned int)value;
+            if (!readBinary(position, end, value, 8)) return false;
+            deltaBase = (long long)value;
+            if (!readBinary(position, end, value, 1) || value > 32) return false;
+            bitWidth = value;
+            unsigned int packedCount = (compressionType == CompressionType::DELTA && valuesCount > 0) ? valuesCount - 1 : valuesCount;
+            unsigned int wordsCount = wordsNeeded(packedCount, bitWidth);
+            if (8ULL * wordsCount > (unsigned long long)(end - position)) return false;
+            packedWords.resize(wordsCount);
+            for (unsigned int i = 0; i < wordsCount; ++i) {
+                readBinary(position, end, value, 8);
+                packedWords[i] = value;
+            }
+            if (compressionType == CompressionType::FOR) {  // The offsets must keep the values in the INT range
+                for (unsigned int i = 0; i < valuesCount; ++i) maxOffset = std::max(maxOffset, (unsigned int)packedValue(i));
+                if ((long long)baseValue + maxOffset > INT_MAX) return false;
+            }
+            return true;
+        }
+        default:
+            return false;
+    }
+}
@@ -0,0 +1,572 @@
+/**
+ * SDP database engine differential fuzzing
+ * Random tables receive the same random INSERT, REMOVE, UPDATE, VACUUM, BEGIN, COMMIT and ROLLBACK
+ * as a simple reference model, a vector of rows filtered by a direct evaluation of the conditions.
+ * Every WHERE is answered by the planned selection of an indexed and an unindexed table,
+ * by the compiled conditions and by isInSelection, and compared with the reference.
+ * DISTINCT, ORDERBY, LIMIT and OFFSET are compared by their keys, equal keys may come in any order.
+ * Mismatches are reported with the seed, the times as CSV lines:
+ * Query class, Queries, Reference time in nanoseconds, Engine time in nanoseconds, Reference / Engine
+ * Usage: SDPFuzz [seed] [rounds]
+ */
+
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include <random>
+#include <set>
+#include <string>
+#include <vector>
+
+#include "../Headers/table.hpp"
+
+const unsigned int FUZZ_SEED = 2022;  //!< Default seed, a reported mismatch is repeated with the same seed
+const int FUZZ_ROUNDS = 30;           //!< Default number of generated tables
+const int ROUND_STEPS = 100;          //!< Number of commands applied to each table
+
+//! Classes of the compared queries
+enum class QueryClass {
+    EQUALITY = 0,      // A single = comparison
+    RANGE = 1,         // Comparisons of a single column joined by AND
+    BOOLEAN = 2,       // Comparisons of several columns joined by AND and OR
+    NEGATION = 3,      // Conditions with NOT
+    PATTERN = 4,       // Conditions with LIKE
+    DISTINCT = 5,      // SELECT DISTINCT
+    ORDERBY = 6,       // SELECT ORDERBY
+    LIMIT = 7,         // SELECT LIMIT OFFSET without ORDERBY
+    COUNTQUERYCLASSES  // Number of query classes
+};
+
+const char QueryClassList[(int)(QueryClass::COUNTQUERYCLASSES)][10] = {
+    "equality",
+    "range",
+    "boolean",
+    "not",
+    "like",
+    "distinct",
+    "orderby",
+    "limit"};
+
+//! A comparison <field> <operator> <literal>, or <literal> <operator> <field> evaluated as written
+struct Comparison {
+    int columnIndex = 0;
+    OperatorType operatorType = OperatorType::EQ;
+    std::string literal;
+    int negations = 0;          // Number of NOT before the comparison
+    bool literalFirst = false;  // The literal is written before the field, never for LIKE
+};
+
+//! WHERE conditions as OR of AND of comparisons, the precedence of the engine without parentheses
+typedef std::vector<std::vector<Comparison>> Condition;
+
+//! Reference model of a table, the removed rows are erased
+struct ReferenceTable {
+    std::vector<std::string> columnNames;
+    std::vector<FieldType> columnTypes;
+    std::vector<std::vector<std::string>> rows;  // Values as given by getValueUniform
+};
+
+//! Mismatches and times of all rounds
+struct FuzzReport {
+    int mismatches = 0;
+    long long queries[(int)(QueryClass::COUNTQUERYCLASSES)] = {};
+    long long referenceTime[(int)(QueryClass::COUNTQUERYCLASSES)] = {};
+    long long engineTime[(int)(QueryClass::COUNTQUERYCLASSES)] = {};
+};
+
+//! Nanoseconds since a time point
+long long elapsedTime(std::chrono::steady_clock::time_point start) {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start).count();
+}
+
+//! Generate a value of a column, small domains give duplicates and equal keys, INT values are not negative
+std::string randomValue(std::mt19937& generator, FieldType fieldType, int valueDomain) {
+    int value = std::uniform_int_distribution<int>(0, valueDomain - 1)(generator);
+    if (fieldType == FieldType::STRING) return "\"S" + std::to_string(value) + "\"";
+    if (fieldType == FieldType::DATE) return formatDate(value * 3 % 20000);
+    return std::to_string(value);
+}
+
+//! Generate a literal compared with a column, some literals are outside of the values
+std::string randomLiteral(std::mt19937& generator, FieldType fieldType, int valueDomain) {
+    return randomValue(generator, fieldType, valueDomain + 2 + valueDomain / 10);
+}
+
+//! Generate a LIKE pattern of the STRING values
+std::string randomPattern(std::mt19937& generator) {
+    std::string digit = std::to_string(std::uniform_int_distribution<int>(0, 9)(generator));
+    switch (std::uniform_int_distribution<int>(0, 3)(generator)) {
+        case 0:
+            return "\"S" + digit + "%\"";
+        case 1:
+            return "\"%" + digit + "\"";
+        case 2:
+            return "\"S_" + digit + "%\"";
+        default:
+            return "\"%\"";
+    }
+}
+
+//! Generate WHERE conditions of up to 3 conjunctions of up to 3 comparisons
+Condition randomCondition(std::mt19937& generator, const ReferenceTable& reference, int valueDomain) {
+    std::uniform_int_distribution<int> count(1, 3), percent(0, 99);
+    std::uniform_int_distribution<int> column(0, reference.columnNames.size() - 1), comparison((int)OperatorType::EQ, (int)OperatorType::LE);
+    Condition condition(percent(generator) < 60 ? 1 : count(generator));
+    for (unsigned int i = 0; i < condition.size(); ++i) {
+        condition[i].resize(percent(generator) < 50 ? 1 : count(generator));
+        int rangeColumn = column(generator);  // Most conjunctions compare a single column, as a range
+        for (unsigned int j = 0; j < condition[i].size(); ++j) {
+            Comparison& current = condition[i][j];
+            current.columnIndex = percent(generator) < 70 ? rangeColumn : column(generator);
+            FieldType fieldType = reference.columnTypes[current.columnIndex];
+            current.operatorType = (OperatorType)comparison(generator);
+            current.literal = randomLiteral(generator, fieldType, valueDomain);
+            if (fieldType == FieldType::STRING && percent(generator) < 20) {
+                current.operatorType = OperatorType::LIKE;
+                current.literal = randomPattern(generator);
+            }
+            current.negations = percent(generator) < 15 ? count(generator) % 3 : 0;
+            current.literalFirst = percent(generator) < 10 && current.operatorType != OperatorType::LIKE;
+        }
+    }
+    return condition;
+}
+
+//! Write WHERE conditions as the tokens of a command
+std::vector<std::string> conditionTokens(const Condition& condition, const ReferenceTable& reference) {
+    std::vector<std::string> tokens;
+    for (unsigned int i = 0; i < condition.size(); ++i) {
+        if (i > 0) tokens.push_back("OR");
+        for (unsigned int j = 0; j < condition[i].size(); ++j) {
+            const Comparison& current = condition[i][j];
+            if (j > 0) tokens.push_back("AND");
+            for (int k = 0; k < current.negations; ++k) tokens.push_back("NOT");
+            const std::string& fieldName = reference.columnNames[current.columnIndex];
+            tokens.push_back(current.literalFirst ? current.literal : fieldName);
+            tokens.push_back(OperatorTypeList[(int)current.operatorType]);
+            tokens.push_back(current.literalFirst ? fieldName : current.literal);
+        }
+    }
+    return tokens;
+}
+
+//! Join tokens into the text of a command
+std::string joinTokens(const std::vector<std::string>& tokens) {
+    std::string text;
+    for (unsigned int i = 0; i < tokens.size(); ++i) text += (i > 0 ? " " : "") + tokens[i];
+    return text;
+}
+
+//! Classify a query by its WHERE conditions
+QueryClass conditionClass(const Condition& condition) {
+    bool flagNegation = false, flagPattern = false, flagColumns = false;
+    for (unsigned int i = 0; i < condition.size(); ++i) {
+        for (unsigned int j = 0; j < condition[i].size(); ++j) {
+            flagNegation = flagNegation || condition[i][j].negations > 0;
+            flagPattern = flagPattern || condition[i][j].operatorType == OperatorType::LIKE;
+            flagColumns = flagColumns || condition[i][j].columnIndex != condition[0][0].columnIndex;
+        }
+    }
+    if (flagPattern) return QueryClass::PATTERN;
+    if (flagNegation) return QueryClass::NEGATION;
+    if (condition.size() > 1 || flagColumns) return QueryClass::BOOLEAN;
+    if (condition[0].size() == 1 && condition[0][0].operatorType == OperatorType::EQ) return QueryClass::EQUALITY;
+    return QueryClass::RANGE;
+}
+
+//! Match a LIKE pattern directly, % is any text and _ is any character
+bool referenceLike(const std::string& value, unsigned int valuePosition, const std::string& pattern, unsigned int patternPosition) {
+    if (patternPosition == pattern.size()) return valuePosition == value.size();
+    if (pattern[patternPosition] == '%') {
+        for (unsigned int i = valuePosition; i <= value.size(); ++i) {
+            if (referenceLike(value, i, pattern, patternPosition + 1)) return true;
+        }
+        return false;
+    }
+    if (valuePosition == value.size()) return false;
+    if (pattern[patternPosition] != '_' && pattern[patternPosition] != value[valuePosition]) return false;
+    return referenceLike(value, valuePosition + 1, pattern, patternPosition + 1);
+}
+
+//! Compare two ordered values
+template <typename T>
+bool referenceOrder(const T& value1, const T& value2, OperatorType operatorType) {
+    switch (operatorType) {
+        case OperatorType::EQ:
+            return value1 == value2;
+        case OperatorType::NE:
+            return value1 != value2;
+        case OperatorType::GT:
+            return value1 > value2;
+        case OperatorType::LT:
+            return value1 < value2;
+        case OperatorType::GE:
+            return value1 >= value2;
+        default:
+            return value1 <= value2;
+    }
+}
+
+//! Integer key of an INT or DATE value
+int referenceKey(FieldType fieldType, const std::string& value) {
+    int key = 0;
+    if (fieldType == FieldType::DATE) {
+        parseDate(value, key);
+    } else {
+        key = std::atoi(value.c_str());
+    }
+    return key;
+}
+
+//! Evaluate a comparison of a value directly
+bool referenceCompare(FieldType fieldType, const std::string& value, const Comparison& comparison) {
+    bool result;
+    if (comparison.operatorType == OperatorType::LIKE) {
+        result = referenceLike(value, 0, comparison.literal, 0);
+    } else if (fieldType == FieldType::STRING) {
+        result = comparison.literalFirst ? referenceOrder(comparison.literal, value, comparison.operatorType)
+                                         : referenceOrder(value, comparison.literal, comparison.operatorType);
+    } else {
+        int key = referenceKey(fieldType, value), literalKey = referenceKey(fieldType, comparison.literal);
+        result = comparison.literalFirst ? referenceOrder(literalKey, key, comparison.operatorType) : referenceOrder(key, literalKey, comparison.operatorType);
+    }
+    return (comparison.negations % 2 == 1) ? !result : result;
+}
+
+//! Evaluate WHERE conditions of a row directly, empty conditions select all rows
+bool referenceMatches(const ReferenceTable& reference, const std::vector<std::string>& row, const Condition& condition) {
+    if (condition.empty()) return true;
+    for (unsigned int i = 0; i < condition.size(); ++i) {
+        bool flagConjunction = true;
+        for (unsigned int j = 0; j < condition[i].size() && flagConjunction; ++j) {
+            int columnIndex = condition[i][j].columnIndex;
+            flagConjunction = referenceCompare(reference.columnTypes[columnIndex], row[columnIndex], condition[i][j]);
+        }
+        if (flagConjunction) return true;
+    }
+    return false;
+}
+
+//! Select the rows of the reference satisfying WHERE conditions
+std::vector<std::vector<std::string>> referenceRows(const ReferenceTable& reference, const Condition& condition) {
+    std::vector<std::vector<std::string>> rows;
+    for (unsigned int i = 0; i < reference.rows.size(); ++i) {
+        if (referenceMatches(reference, reference.rows[i], condition)) rows.push_back(reference.rows[i]);
+    }
+    return rows;
+}
+
+//! Get the values of selected records of the engine
+std::vector<std::vector<std::string>> engineRows(Table& table, const std::vector<unsigned int>& rowIds) {
+    std::vector<std::vector<std::string>> rows;
+    rows.reserve(rowIds.size());
+    for (unsigned int i = 0; i < rowIds.size(); ++i) {
+        Record* currentRecord = table.getRecord(rowIds[i]);
+        rows.push_back(std::vector<std::string>());
+        for (int j = 0; j < table.getTableColumnsSize(); ++j) rows.back().push_back(currentRecord->getData(j)->getValueUniform());
+    }
+    return rows;
+}
+
+//! Get the values of some columns of rows
+std::vector<std::vector<std::string>> projectRows(const std::vector<std::vector<std::string>>& rows, const std::vector<int>& columnsIndex) {
+    std::vector<std::vector<std::string>> projectedRows;
+    for (unsigned int i = 0; i < rows.size(); ++i) {
+        projectedRows.push_back(std::vector<std::string>());
+        for (unsigned int j = 0; j < columnsIndex.size(); ++j) projectedRows.back().push_back(rows[i][columnsIndex[j]]);
+    }
+    return projectedRows;
+}
+
+//! Compare the rows of a path with the reference in any order
+bool sameRows(std::vector<std::vector<std::string>> rows, std::vector<std::vector<std::string>> expectedRows) {
+    std::sort(rows.begin(), rows.end());
+    std::sort(expectedRows.begin(), expectedRows.end());
+    return rows == expectedRows;
+}
+
+//! Print a mismatch with everything needed to repeat it
+void reportMismatch(FuzzReport& report, unsigned int seed, int round, const std::string& path, const std::string& command, size_t rows, size_t expectedRows) {
+    ++report.mismatches;
+    std::cerr << "[!] Mismatch of " << path << " with seed " << seed << " in round " << round << ": " << command
+              << " gives " << rows << " rows instead of " << expectedRows << '\n';
+}
+
+//! Answer a WHERE by all paths of the engine and compare them with the reference
+void checkWhere(FuzzReport& report, unsigned int seed, int round, Table& indexedTable, Table& plainTable, const ReferenceTable& reference, const Condition& condition) {
+    std::vector<std::string> whereParameters = conditionTokens(condition, reference);
+    std::string command = "SELECT * FROM FuzzTable WHERE " + joinTokens(whereParameters);
+    QueryClass queryClass = conditionClass(condition);
+
+    auto start = std::chrono::steady_clock::now();
+    std::vector<std::vector<std::string>> expectedRows = referenceRows(reference, condition);
+    report.referenceTime[(int)queryClass] += elapsedTime(start);
+    ++report.queries[(int)queryClass];
+
+    try {
+        start = std::chrono::steady_clock::now();
+        std::vector<unsigned int> rowIds = indexedTable.selectRowIdsWhere(whereParameters);
+        report.engineTime[(int)queryClass] += elapsedTime(start);
+        std::vector<std::vector<std::string>> rows = engineRows(indexedTable, rowIds);
+        if (!sameRows(rows, expectedRows)) reportMismatch(report, seed, round, "indexed selection", command, rows.size(), expectedRows.size());
+
+        rows = engineRows(plainTable, plainTable.selectRowIdsWhere(whereParameters));
+        if (!sameRows(rows, expectedRows)) reportMismatch(report, seed, round, "unindexed selection", command, rows.size(), expectedRows.size());
+
+        std::vector<unsigned int> allRowIds = plainTable.selectRowIdsWhere(std::vector<std::string>());
+        std::queue<std::string> operands = plainTable.transformConditions(whereParameters);
+        std::vector<Table::CompiledCondition> compiledConditions;
+        std::vector<unsigned char> results;
+        if (plainTable.compileConditions(operands, compiledConditions)) {
+            std::vector<unsigned int> compiledRowIds;
+            for (unsigned int i = 0; i < allRowIds.size(); ++i) {
+                if (plainTable.matchesConditions(plainTable.getRecord(allRowIds[i]), compiledConditions, results)) compiledRowIds.push_back(allRowIds[i]);
+            }
+            rows = engineRows(plainTable, compiledRowIds);
+            if (!sameRows(rows, expectedRows)) reportMismatch(report, seed, round, "compiled conditions", command, rows.size(), expectedRows.size());
+        } else {
+            reportMismatch(report, seed, round, "compiled conditions (not compiled)", command, 0, expectedRows.size());
+        }
+
+        std::vector<unsigned int> interpretedRowIds;
+        for (unsigned int i = 0; i < allRowIds.size(); ++i) {
+            if (plainTable.isInSelection(plainTable.getRecord(allRowIds[i]), operands)) interpretedRowIds.push_back(allRowIds[i]);
+        }
+        rows = engineRows(plainTable, interpretedRowIds);
+        if (!sameRows(rows, expectedRows)) reportMismatch(report, seed, round, "isInSelection", command, rows.size(), expectedRows.size());
+    } catch (std::exception& e) {
+        ++report.mismatches;
+        std::cerr << "[!] Exception with seed " << seed << " in round " << round << ": " << command << " " << e.what() << '\n';
+    }
+}
+
+//! Order rows by columns, the last column is the primary one as in the engine
+void referenceSort(std::vector<std::vector<std::string>>& rows, const ReferenceTable& reference, const std::vector<int>& columnsIndex) {
+    std::stable_sort(rows.begin(), rows.end(), [&reference, &columnsIndex](const std::vector<std::string>& row1, const std::vector<std::string>& row2) {
+        for (int i = (int)columnsIndex.size() - 1; i >= 0; --i) {
+            int columnIndex = columnsIndex[i];
+            FieldType fieldType = reference.columnTypes[columnIndex];
+            bool flagLess, flagGreater;
+            if (fieldType == FieldType::STRING) {
+                flagLess = row1[columnIndex] < row2[columnIndex];
+                flagGreater = row2[columnIndex] < row1[columnIndex];
+            } else {
+                flagLess = referenceKey(fieldType, row1[columnIndex]) < referenceKey(fieldType, row2[columnIndex]);
+                flagGreater = referenceKey(fieldType, row2[columnIndex]) < referenceKey(fieldType, row1[columnIndex]);
+            }
+            if (flagLess) return true;
+            if (flagGreater) return false;
+        }
+        return false;
+    });
+}
+
+//! Answer a SELECT with DISTINCT, ORDERBY or LIMIT OFFSET and compare its keys with the reference
+void checkSelect(FuzzReport& report, unsigned int seed, int round, std::mt19937& generator, Table& indexedTable, const ReferenceTable& reference, const Condition& condition) {
+    std::uniform_int_distribution<int> percent(0, 99), column(0, reference.columnNames.size() - 1);
+    std::vector<std::string> whereParameters = conditionTokens(condition, reference);
+    std::vector<std::string> distinctColumns, orderByColumns;
+    std::vector<int> columnsIndex;
+    int columnsCount = 1 + percent(generator) % 2;
+    for (int i = 0; i < columnsCount; ++i) {
+        int columnIndex = column(generator);
+        if (std::find(columnsIndex.begin(), columnsIndex.end(), columnIndex) == columnsIndex.end()) columnsIndex.push_back(columnIndex);
+    }
+    std::vector<std::string> columnNames;
+    for (unsigned int i = 0; i < columnsIndex.size(); ++i) columnNames.push_back(reference.columnNames[columnsIndex[i]]);
+    int limitRecords = percent(generator) < 50 ? -1 : percent(generator);
+    int offsetRecords = percent(generator) < 50 ? 0 : percent(generator) % 20;
+
+    QueryClass queryClass = QueryClass::LIMIT;
+    std::string command = "SELECT * FROM FuzzTable";
+    int selectKind = percent(generator) % 3;
+    if (selectKind == 0) {
+        queryClass = QueryClass::DISTINCT;
+        distinctColumns = columnNames;
+        command = "SELECT DISTINCT " + joinTokens(columnNames) + " FROM FuzzTable";
+    } else if (selectKind == 1) {
+        queryClass = QueryClass::ORDERBY;
+        orderByColumns = columnNames;
+        command += " ORDERBY " + joinTokens(columnNames);
+    } else if (limitRecords < 0) {
+        limitRecords = percent(generator);
+    }
+    if (!whereParameters.empty()) command += " WHERE " + joinTokens(whereParameters);
+    if (limitRecords >= 0) command += " LIMIT " + std::to_string(limitRecords);
+    if (offsetRecords > 0) command += " OFFSET " + std::to_string(offsetRecords);
+
+    auto start = std::chrono::steady_clock::now();
+    std::vector<std::vector<std::string>> matchingRows = referenceRows(reference, condition);
+    std::vector<std::vector<std::string>> expectedRows(matchingRows);
+    if (queryClass == QueryClass::DISTINCT) {
+        std::set<std::vector<std::string>> distinctKeys;  // The first row of each key, in the order of the rows
+        std::vector<std::vector<std::string>> distinctRows;
+        for (unsigned int i = 0; i < expectedRows.size(); ++i) {
+            if (distinctKeys.insert(projectRows({expectedRows[i]}, columnsIndex)[0]).second) distinctRows.push_back(expectedRows[i]);
+        }
+        expectedRows.swap(distinctRows);
+    } else if (queryClass == QueryClass::ORDERBY) {
+        referenceSort(expectedRows, reference, columnsIndex);
+    }
+    unsigned int firstRow = std::min((unsigned int)offsetRecords, (unsigned int)expectedRows.size());
+    unsigned int lastRow = (limitRecords < 0) ? expectedRows.size() : std::min((unsigned int)expectedRows.size(), firstRow + limitRecords);
+    report.referenceTime[(int)queryClass] += elapsedTime(start);
+    ++report.queries[(int)queryClass];
+
+    try {
+        start = std::chrono::steady_clock::now();
+        std::vector<unsigned int> rowIds = indexedTable.selectRowIds(distinctColumns, orderByColumns, whereParameters, limitRecords, offsetRecords);
+        report.engineTime[(int)queryClass] += elapsedTime(start);
+        std::vector<std::vector<std::string>> rows = engineRows(indexedTable, rowIds);
+
+        // The selected records are any of the matching ones, the ordered keys are the same
+        bool flagSame = (rows.size() == lastRow - firstRow);
+        std::set<std::vector<std::string>> matchingSet(matchingRows.begin(), matchingRows.end());
+        for (unsigned int i = 0; i < rows.size() && flagSame; ++i) flagSame = matchingSet.count(rows[i]) > 0;
+        if (flagSame && queryClass == QueryClass::DISTINCT) {
+            std::vector<std::vector<std::string>> keys = projectRows(rows, columnsIndex);
+            flagSame = std::set<std::vector<std::string>>(keys.begin(), keys.end()).size() == keys.size();
+        }
+        if (flagSame && queryClass == QueryClass::ORDERBY) {
+            std::vector<std::vector<std::string>> expectedSlice(expectedRows.begin() + firstRow, expectedRows.begin() + lastRow);
+            flagSame = projectRows(rows, columnsIndex) == projectRows(expectedSlice, columnsIndex);
+        }
+        if (!flagSame) reportMismatch(report, seed, round, "selection stages", command, rows.size(), lastRow - firstRow);
+    } catch (std::exception& e) {
+        ++report.mismatches;
+        std::cerr << "[!] Exception with seed " << seed << " in round " << round << ": " << command << " " << e.what() << '\n';
+    }
+}
+
+//! Verify that both tables keep as many records as the reference
+void checkCounts(FuzzReport& report, unsigned int seed, int round, Table& indexedTable, Table& plainTable, const ReferenceTable& reference, const std::string& command) {
+    if (indexedTable.getTableNumberOfRecords() != (int)reference.rows.size()) {
+        reportMismatch(report, seed, round, "indexed table", command, indexedTable.getTableNumberOfRecords(), reference.rows.size());
+    }
+    if (plainTable.getTableNumberOfRecords() != (int)reference.rows.size()) {
+        reportMismatch(report, seed, round, "unindexed table", command, plainTable.getTableNumberOfRecords(), reference.rows.size());
+    }
+}
+
+//! Apply a random command or query to the tables and the reference
+void fuzzStep(FuzzReport& report, unsigned int seed, int round, int step, std::mt19937& generator, Table& indexedTable, Table& plainTable,
+              ReferenceTable& reference, std::vector<std::vector<std::string>>& savedRows, bool& inTransaction, int initialRows, int valueDomain) {
+    std::uniform_int_distribution<int> percent(0, 99);
+    int columnsCount = reference.columnNames.size();
+    int command = (step < 0) ? 0 : percent(generator);
+    if (command < 8) {  // INSERT, the first batch may fill several blocks
+        int batchRecords = (step < 0) ? initialRows : 1 + percent(generator) * 3;
+        std::vector<std::vector<std::string>> batch(batchRecords);
+        for (int i = 0; i < batchRecords; ++i) {
+            for (int j = 0; j < columnsCount; ++j) batch[i].push_back(randomValue(generator, reference.columnTypes[j], valueDomain));
+        }
+        indexedTable.addRecords(batch);
+        plainTable.addRecords(batch);
+        reference.rows.insert(reference.rows.end(), batch.begin(), batch.end());
+        checkCounts(report, seed, round, indexedTable, plainTable, reference, "INSERT");
+    } else if (command < 13) {  // REMOVE
+        Condition condition = randomCondition(generator, reference, valueDomain);
+        std::vector<std::string> whereParameters = conditionTokens(condition, reference);
+        indexedTable.removeRecords(whereParameters);
+        plainTable.removeRecords(whereParameters);
+        std::vector<std::vector<std::string>> keptRows;
+        for (unsigned int i = 0; i < reference.rows.size(); ++i) {
+            if (!referenceMatches(reference, reference.rows[i], condition)) keptRows.push_back(reference.rows[i]);
+        }
+        reference.rows.swap(keptRows);
+        checkCounts(report, seed, round, indexedTable, plainTable, reference, "REMOVE FuzzTable WHERE " + joinTokens(whereParameters));
+    } else if (command < 20) {  // UPDATE, the matching records are selected before the change
+        Condition condition = randomCondition(generator, reference, valueDomain);
+        std::vector<std::string> whereParameters = conditionTokens(condition, reference);
+        int columnIndex = percent(generator) % columnsCount;
+        std::string value = randomValue(generator, reference.columnTypes[columnIndex], valueDomain);
+        int updatedRecords = 0;
+        for (unsigned int i = 0; i < reference.rows.size(); ++i) {
+            if (!referenceMatches(reference, reference.rows[i], condition)) continue;
+            if (reference.rows[i][columnIndex] != value) ++updatedRecords;
+            reference.rows[i][columnIndex] = value;
+        }
+        std::string updateCommand = "UPDATE FuzzTable SET " + reference.columnNames[columnIndex] + " = " + value + " WHERE " + joinTokens(whereParameters);
+        int indexedUpdated = indexedTable.updateRecords({reference.columnNames[columnIndex]}, {value}, whereParameters);
+        int plainUpdated = plainTable.updateRecords({reference.columnNames[columnIndex]}, {value}, whereParameters);
+        if (indexedUpdated != updatedRecords) reportMismatch(report, seed, round, "indexed update", updateCommand, indexedUpdated, updatedRecords);
+        if (plainUpdated != updatedRecords) reportMismatch(report, seed, round, "unindexed update", updateCommand, plainUpdated, updatedRecords);
+    } else if (command < 22 && !inTransaction) {  // VACUUM
+        indexedTable.vacuumTable();
+        plainTable.vacuumTable();
+        checkCounts(report, seed, round, indexedTable, plainTable, reference, "VACUUM FuzzTable");
+    } else if (command < 25) {  // BEGIN, then COMMIT or ROLLBACK
+        if (!inTransaction) {
+            indexedTable.beginLogging();
+            plainTable.beginLogging();
+            savedRows = reference.rows;
+        } else if (percent(generator) < 50) {
+            indexedTable.commitLog();
+            plainTable.commitLog();
+        } else {
+            indexedTable.rollbackLog();
+            plainTable.rollbackLog();
+            reference.rows = savedRows;
+            checkCounts(report, seed, round, indexedTable, plainTable, reference, "ROLLBACK");
+        }
+        inTransaction = !inTransaction;
+    } else if (command < 75) {  // SELECT WHERE by all paths
+        checkWhere(report, seed, round, indexedTable, plainTable, reference, randomCondition(generator, reference, valueDomain));
+    } else {  // SELECT DISTINCT, ORDERBY or LIMIT OFFSET
+        Condition condition;
+        if (percent(generator) < 70) condition = randomCondition(generator, reference, valueDomain);
+        checkSelect(report, seed, round, generator, indexedTable, reference, condition);
+    }
+}
+
+//! Fuzz a random table: structure, commands and queries
+void fuzzRound(FuzzReport& report, unsigned int seed, int round) {
+    std::mt19937 generator(seed + round);
+    std::uniform_int_distribution<int> percent(0, 99);
+    const int valueDomains[] = {3, 40, 3000};
+    int valueDomain = valueDomains[percent(generator) % 3];
+
+    // Structure: C0 is an INT column, the other columns have random types, indexes only in the indexed table
+    ReferenceTable reference;
+    Table indexedTable("FuzzTable"), plainTable("FuzzTable");
+    int columnsCount = 2 + percent(generator) % 4;
+    for (int i = 0; i < columnsCount; ++i) {
+        FieldType fieldType = (i == 0) ? FieldType::INT : (FieldType)(1 + percent(generator) % 3);
+        bool fieldIsIndex = percent(generator) < 50;
+        IndexType indexType = (IndexType)(percent(generator) % (int)(IndexType::COUNTINDEXTYPE));
+        reference.columnNames.push_back("C" + std::to_string(i));
+        reference.columnTypes.push_back(fieldType);
+        indexedTable.addField(reference.columnNames[i], fieldType, false, fieldIsIndex, "", indexType);
+        plainTable.addField(reference.columnNames[i], fieldType, false, false, "");
+    }
+
+    std::vector<std::vector<std::string>> savedRows;  // Rows of the reference at BEGIN
+    bool inTransaction = false;
+    int initialRows = (percent(generator) < 30) ? 2 * BLOCK_ROWS + percent(generator) * 10 : percent(generator) * 5;
+    for (int step = -1; step < ROUND_STEPS; ++step) {
+        try {
+            fuzzStep(report, seed, round, step, generator, indexedTable, plainTable, reference, savedRows, inTransaction, initialRows, valueDomain);
+        } catch (std::exception& e) {  // The tables and the reference may differ after a failed command
+            ++report.mismatches;
+            std::cerr << "[!] Exception with seed " << seed << " in round " << round << " at step " << step << ": " << e.what() << '\n';
+            return;
+        }
+    }
+}
+
+int main(int argc, char* argv[]) {
+    unsigned int seed = (argc > 1) ? std::strtoul(argv[1], nullptr, 10) : FUZZ_SEED;
+    int rounds = (argc > 2) ? std::atoi(argv[2]) : FUZZ_ROUNDS;
+
+    FuzzReport report;
+    for (int round = 0; round < rounds; ++round) fuzzRound(report, seed, round);
+
+    std::cout << "Query class, Queries, Reference time, Engine time, Reference / Engine\n";
+    for (int i = 0; i < (int)(QueryClass::COUNTQUERYCLASSES); ++i) {
+        double ratio = report.engineTime[i] > 0 ? (double)report.referenceTime[i] / report.engineTime[i] : 0.0;
+        std::cout << QueryClassList[i] << ", " << report.queries[i] << ", " << report.referenceTime[i] << ", " << report.engineTime[i] << ", " << ratio << '\n';
+    }
+    std::cout << "Mismatches, " << report.mismatches << '\n';
+    return (report.mismatches > 0) ? 1 : 0;
+}
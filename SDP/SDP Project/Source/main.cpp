@@ -5,14 +5,28 @@
  * \date 01.2022 - 02.2022
  */
 
+#include <cstring>
 #include <iostream>
 
 #include "../Headers/command.hpp"
 
 using namespace std;
 
-int main() {
+int main(int argc, char* argv[]) {
     CommandLine CLInterface;
+    if (argc == 3 && strcmp(argv[1], "--script") == 0) {  // Run a script without the console
+        try {
+            CLInterface.runScript(argv[2]);
+        } catch (const std::exception& e) {
+            std::cout << e.what() << std::endl;
+            return 1;
+        }
+        return 0;
+    }
+    if (argc != 1) {
+        std::cout << "Usage: SDPDatabase [--script <file>]" << std::endl;
+        return 1;
+    }
     CLInterface.CommandLineInterface();
 
     std::cout << "Goodbye!" << std::endl;
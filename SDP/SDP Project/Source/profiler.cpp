@@ -0,0 +1,169 @@
+#include "../Headers/profiler.hpp"
+
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <new>
+
+#include "../Headers/recordindex.hpp"
+
+// Allocations are counted only on the thread of a running stage, other allocations pay a single check
+static thread_local bool countingAllocations = false;         //!< Flag if a stage of this thread is running
+static thread_local unsigned long long threadAllocations = 0;  //!< Counter of operator new calls of the running stage
+
+// The complete set of replaceable operators is replaced, so every new and delete
+// of the program uses malloc and free, whatever form the standard library calls
+
+//! Allocate memory, calling the new handler until it succeeds, nullptr if there is no handler
+static void* allocateMemory(std::size_t size, std::size_t alignment) {
+    if (countingAllocations) ++threadAllocations;
+    if (size == 0) size = 1;
+    if (alignment > 0) {  // aligned_alloc takes a multiple of the alignment
+        if (size > SIZE_MAX - (alignment - 1)) return nullptr;
+        size = (size + alignment - 1) / alignment * alignment;
+    }
+    while (true) {
+        void* memory = (alignment > 0) ? std::aligned_alloc(alignment, size) : std::malloc(size);
+        if (memory) return memory;
+        std::new_handler handler = std::get_new_handler();
+        if (!handler) return nullptr;
+        handler();
+    }
+}
+
+//! Allocate memory that does not throw, the new handler may throw
+static void* allocateNothrow(std::size_t size, std::size_t alignment) noexcept {
+    try {
+        return allocateMemory(size, alignment);
+    } catch (...) {
+        return nullptr;
+    }
+}
+
+void* operator new(std::size_t size) {
+    void* memory = allocateMemory(size, 0);
+    if (!memory) throw std::bad_alloc();
+    return memory;
+}
+
+void* operator new[](std::size_t size) {
+    return operator new(size);
+}
+
+void* operator new(std::size_t size, const std::nothrow_t&) noexcept {
+    return allocateNothrow(size, 0);
+}
+
+void* operator new[](std::size_t size, const std::nothrow_t&) noexcept {
+    return allocateNothrow(size, 0);
+}
+
+void* operator new(std::size_t size, std::align_val_t alignment) {
+    void* memory = allocateMemory(size, (std::size_t)alignment);
+    if (!memory) throw std::bad_alloc();
+    return memory;
+}
+
+void* operator new[](std::size_t size, std::align_val_t alignment) {
+    return operator new(size, alignment);
+}
+
+void* operator new(std::size_t size, std::align_val_t alignment, const std::nothrow_t&) noexcept {
+    return allocateNothrow(size, (std::size_t)alignment);
+}
+
+void* operator new[](std::size_t size, std::align_val_t alignment, const std::nothrow_t&) noexcept {
+    return allocateNothrow(size, (std::size_t)alignment);
+}
+
+void operator delete(void* memory) noexcept {
+    std::free(memory);
+}
+
+void operator delete[](void* memory) noexcept {
+    std::free(memory);
+}
+
+void operator delete(void* memory, std::size_t) noexcept {
+    std::free(memory);
+}
+
+void operator delete[](void* memory, std::size_t) noexcept {
+    std::free(memory);
+}
+
+void operator delete(void* memory, const std::nothrow_t&) noexcept {
+    std::free(memory);
+}
+
+void operator delete[](void* memory, const std::nothrow_t&) noexcept {
+    std::free(memory);
+}
+
+void operator delete(void* memory, std::align_val_t) noexcept {
+    std::free(memory);
+}
+
+void operator delete[](void* memory, std::align_val_t) noexcept {
+    std::free(memory);
+}
+
+void operator delete(void* memory, std::size_t, std::align_val_t) noexcept {
+    std::free(memory);
+}
+
+void operator delete[](void* memory, std::size_t, std::align_val_t) noexcept {
+    std::free(memory);
+}
+
+void operator delete(void* memory, std::align_val_t, const std::nothrow_t&) noexcept {
+    std::free(memory);
+}
+
+void operator delete[](void* memory, std::align_val_t, const std::nothrow_t&) noexcept {
+    std::free(memory);
+}
+
+void QueryProfiler::startQuery() {
+    stages.clear();
+    queryStart = std::chrono::steady_clock::now();
+}
+
+void QueryProfiler::startStage(const std::string& name, long long rowsIn) {
+    stageName = name;
+    stageRowsIn = rowsIn;
+    stageNodes = RecordIndex::nodesVisited.load(std::memory_order_relaxed);
+    stageStart = std::chrono::steady_clock::now();
+    threadAllocations = 0;
+    countingAllocations = true;
+}
+
+void QueryProfiler::describeStage(const std::string& detail) {
+    stageName += " (" + detail + ")";
+}
+
+void QueryProfiler::endStage(long long rowsOut) {
+    countingAllocations = false;
+    std::chrono::duration<double, std::milli> elapsed = std::chrono::steady_clock::now() - stageStart;
+    stages.push_back(ProfileStage{stageName, elapsed.count(), stageRowsIn, rowsOut,
+                                  RecordIndex::nodesVisited.load(std::memory_order_relaxed) - stageNodes, threadAllocations});
+}
+
+double QueryProfiler::totalMilliseconds() const {
+    std::chrono::duration<double, std::milli> elapsed = std::chrono::steady_clock::now() - queryStart;
+    return elapsed.count();
+}
+
+std::vector<std::vector<std::string>> QueryProfiler::profileRows() const {
+    std::vector<std::vector<std::string>> rows;
+    rows.push_back({"Stage", "Time ms", "Rows in", "Rows out", "Index nodes", "Allocations"});
+    for (unsigned int i = 0; i < stages.size(); ++i) {
+        char milliseconds[32];
+        std::snprintf(milliseconds, sizeof(milliseconds), "%.3f", stages[i].milliseconds);
+        rows.push_back({stages[i].stageName, milliseconds,
+                        stages[i].rowsIn < 0 ? "-" : std::to_string(stages[i].rowsIn),
+                        stages[i].rowsOut < 0 ? "-" : std::to_string(stages[i].rowsOut),
+                        std::to_string(stages[i].nodesVisited), std::to_string(stages[i].allocations)});
+    }
+    return rows;
+}
@@ -0,0 +1,72 @@
+#include "../Headers/querycache.hpp"
+
+void QueryCache::evict(size_t limitBytes) {
+    while (!entries.empty() && usedBytes > limitBytes) {
+        usedBytes -= entries.back().entryBytes;
+        entryByKey.erase(entries.back().queryKey);
+        entries.pop_back();
+        ++cacheEvictions;
+    }
+}
+
+void QueryCache::setEnabled(bool enabled) {
+    cacheEnabled = enabled;
+    if (!cacheEnabled) clear();
+}
+
+void QueryCache::setCapacity(size_t capacity) {
+    capacityBytes = capacity;
+    evict(capacityBytes);
+}
+
+bool QueryCache::lookup(const std::string& queryKey, std::vector<std::vector<std::string>>& resultRows) {
+    if (!cacheEnabled) return false;
+    std::unordered_map<std::string, std::list<CacheEntry>::iterator>::iterator found = entryByKey.find(queryKey);
+    if (found == entryByKey.end()) {
+        ++cacheMisses;
+        return false;
+    }
+    entries.splice(entries.begin(), entries, found->second);  // Most recently used
+    resultRows = found->second->resultRows;
+    ++cacheHits;
+    return true;
+}
+
+void QueryCache::store(const std::string& queryKey, const std::vector<std::vector<std::string>>& resultRows) {
+    if (!cacheEnabled) return;
+
+    size_t entryBytes = sizeof(CacheEntry) + 2 * queryKey.size();  // The key is kept in the entry and the map
+    for (unsigned int row = 0; row < resultRows.size(); ++row) {
+        entryBytes += sizeof(std::vector<std::string>);
+        for (unsigned int i = 0; i < resultRows[row].size(); ++i) entryBytes += sizeof(std::string) + resultRows[row][i].capacity();
+    }
+    if (entryBytes > capacityBytes) return;
+
+    std::unordered_map<std::string, std::list<CacheEntry>::iterator>::iterator found = entryByKey.find(queryKey);
+    if (found != entryByKey.end()) {
+        usedBytes -= found->second->entryBytes;
+        entries.erase(found->second);
+        entryByKey.erase(found);
+    }
+    evict(capacityBytes - entryBytes);
+    entries.push_front(CacheEntry{queryKey, resultRows, entryBytes});
+    entryByKey[queryKey] = entries.begin();
+    usedBytes += entryBytes;
+}
+
+void QueryCache::clear() {
+    entries.clear();
+    entryByKey.clear();
+    usedBytes = 0;
+}
+
+std::string QueryCache::cacheInfo() const {
+    std::string info;
+    info += "Cache: " + std::string(cacheEnabled ? "ON" : "OFF") + "\n";
+    info += "Entries: " + std::to_string(entries.size()) + "\n";
+    info += "Memory: " + std::to_string(usedBytes) + " / " + std::to_string(capacityBytes) + " bytes\n";
+    info += "Hits: " + std::to_string(cacheHits) + "\n";
+    info += "Misses: " + std::to_string(cacheMisses) + "\n";
+    info += "Evictions: " + std::to_string(cacheEvictions) + "\n";
+    return info;
+}
@@ -0,0 +1,14 @@
+#include "../Headers/recordindex.hpp"
+
+#include "../Headers/avltree.hpp"
+#include "../Headers/bplustree.hpp"
+
+std::atomic<unsigned long long> RecordIndex::nodesVisited(0);
+
+RecordIndex* createRecordIndex(int columnIndex, FieldType type, IndexType indexType) {
+    if (indexType == IndexType::BPTREE) {
+        if (type == FieldType::STRING) return new BPlusTree<std::string>(columnIndex, type);
+        return new BPlusTree<int>(columnIndex, type);
+    }
+    return new AVLTree(columnIndex, type);
+}
@@ -0,0 +1,132 @@
+#include "../Headers/snapshot.hpp"
+
+//! Run a task for each item on a few threads, the first exception is thrown after all threads finish
+static void runParallel(unsigned int itemsCount, const std::function<void(unsigned int)>& task) {
+    unsigned int threadsCount = std::min(itemsCount, std::max(1u, std::thread::hardware_concurrency()));
+    std::atomic<unsigned int> nextItem(0);
+    std::vector<std::exception_ptr> errors(itemsCount);
+    std::vector<std::thread> threads;
+    for (unsigned int i = 0; i < threadsCount; ++i) {
+        threads.push_back(std::thread([&]() {
+            for (unsigned int item = nextItem++; item < itemsCount; item = nextItem++) {
+                try {
+                    task(item);
+                } catch (...) {
+                    errors[item] = std::current_exception();
+                }
+            }
+        }));
+    }
+    for (unsigned int i = 0; i < threads.size(); ++i) threads[i].join();
+    for (unsigned int i = 0; i < errors.size(); ++i) {
+        if (errors[i]) std::rethrow_exception(errors[i]);
+    }
+}
+
+void saveSnapshot(const std::string& fileName, const std::vector<Table*>& tables) {
+    std::vector<std::string> sections(tables.size());
+    if (tables.size() > 1) {  // Several tables are encoded in parallel, a single table is streamed to the file
+        runParallel(tables.size(), [&](unsigned int i) { tables[i]->writeSnapshot(sections[i]); });
+    }
+
+    std::string header(SNAPSHOT_MAGIC, sizeof(SNAPSHOT_MAGIC));
+    writeBinary(header, SNAPSHOT_VERSION, 4);
+    writeBinary(header, tables.size(), 4);
+
+    // Large sequential writes to a temporary file, renamed over the old snapshot when complete
+    std::string temporaryName = fileName + ".tmp";
+    std::vector<char> fileBuffer(SNAPSHOT_BUFFER_BYTES);
+    std::ofstream fileOutput;
+    fileOutput.rdbuf()->pubsetbuf(fileBuffer.data(), fileBuffer.size());
+    fileOutput.open(temporaryName, std::ios::out | std::ios::binary | std::ios::trunc);
+    if (!fileOutput.is_open()) {
+        throw std::invalid_argument("[!] Unable to open the file!");
+    }
+    fileOutput.write(header.data(), header.size());
+    for (unsigned int i = 0; i < sections.size(); ++i) {
+        std::string sectionSize;
+        if (tables.size() == 1) {  // Fixed-size buffers, the size of the section is written when it is known
+            std::streampos sizePosition = fileOutput.tellp();
+            unsigned long long sectionBytes = 0;
+            writeBinary(sectionSize, 0, 8);
+            fileOutput.write(sectionSize.data(), sectionSize.size());
+            std::function<void(std::string&)> flushBuffer = [&](std::string& buffer) {
+                fileOutput.write(buffer.data(), buffer.size());
+                sectionBytes += buffer.size();
+                buffer.clear();
+            };
+            tables[i]->writeSnapshot(sections[i], flushBuffer, SNAPSHOT_BUFFER_BYTES);
+            flushBuffer(sections[i]);
+            sectionSize.clear();
+            writeBinary(sectionSize, sectionBytes, 8);
+            fileOutput.seekp(sizePosition);
+            fileOutput.write(sectionSize.data(), sectionSize.size());
+            fileOutput.seekp(0, std::ios::end);
+            continue;
+        }
+        writeBinary(sectionSize, sections[i].size(), 8);
+        fileOutput.write(sectionSize.data(), sectionSize.size());
+        fileOutput.write(sections[i].data(), sections[i].size());
+        std::string().swap(sections[i]);  // Release each section once written
+    }
+    fileOutput.close();
+    if (fileOutput.fail()) {
+        std::remove(temporaryName.c_str());
+        throw std::invalid_argument("[!] Unable to write the file!");
+    }
+
+    std::remove(fileName.c_str());
+    if (std::rename(temporaryName.c_str(), fileName.c_str()) != 0) {
+        throw std::invalid_argument("[!] Unable to write the file!");
+    }
+}
+
+std::vector<Table*> loadSnapshot(const std::string& fileName) {
+    std::ifstream fileInput;
+    fileInput.open(fileName, std::ios::in | std::ios::binary | std::ios::ate);
+    if (!fileInput.is_open()) {
+        throw std::invalid_argument("[!] Unable to open the file!");
+    }
+    std::string fileData(fileInput.tellg(), '\0');  // The whole file in a single read
+    fileInput.seekg(0);
+    fileInput.read(&fileData[0], fileData.size());
+    if (fileInput.fail()) {
+        throw std::invalid_argument("[!] Unable to read the file!");
+    }
+    fileInput.close();
+
+    const char* position = fileData.data();
+    const char* end = fileData.data() + fileData.size();
+    unsigned long long version = 0, tablesCount = 0;
+    if (fileData.size() < sizeof(SNAPSHOT_MAGIC) || std::memcmp(position, SNAPSHOT_MAGIC, sizeof(SNAPSHOT_MAGIC)) != 0) {
+        throw std::invalid_argument("[!] Invalid snapshot file!");
+    }
+    position += sizeof(SNAPSHOT_MAGIC);
+    if (!readBinary(position, end, version, 4) || version != SNAPSHOT_VERSION || !readBinary(position, end, tablesCount, 4)) {
+        throw std::invalid_argument("[!] Invalid snapshot file! Unsupported version!");
+    }
+
+    // Find the sections first, then decode them in parallel
+    std::vector<const char*> sectionStarts, sectionEnds;
+    for (unsigned int i = 0; i < tablesCount; ++i) {
+        unsigned long long sectionSize = 0;
+        if (!readBinary(position, end, sectionSize, 8) || sectionSize > (unsigned long long)(end - position)) {
+            throw std::invalid_argument("[!] Invalid snapshot file! The file is incomplete!");
+        }
+        sectionStarts.push_back(position);
+        sectionEnds.push_back(position + sectionSize);
+        position += sectionSize;
+    }
+
+    std::vector<Table*> loadedTables(sectionStarts.size(), nullptr);
+    try {
+        runParallel(sectionStarts.size(), [&](unsigned int i) {
+            const char* sectionPosition = sectionStarts[i];
+            loadedTables[i] = Table::readSnapshot(sectionPosition, sectionEnds[i]);
+        });
+    } catch (...) {
+        for (unsigned int i = 0; i < loadedTables.size(); ++i) delete loadedTables[i];
+        throw;
+    }
+    return loadedTables;
+}
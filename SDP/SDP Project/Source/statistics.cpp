@@ -0,0 +1,169 @@
+#include "../Headers/statistics.hpp"
+
+void HyperLogLog::add(uint64_t valueHash) {
+    unsigned int registerIndex = valueHash >> (64 - REGISTER_BITS);
+    uint64_t remainingBits = (valueHash << REGISTER_BITS) | (1ull << (REGISTER_BITS - 1));  // Guard bit limits the rank
+    unsigned char rank = 1;
+    while (!(remainingBits & (1ull << 63))) {
+        remainingBits <<= 1;
+        ++rank;
+    }
+    if (registers[registerIndex] < rank) registers[registerIndex] = rank;
+}
+
+double HyperLogLog::estimate() const {
+    double harmonicSum = 0;
+    unsigned int emptyRegisters = 0;
+    for (unsigned int i = 0; i < REGISTERS; ++i) {
+        harmonicSum += std::ldexp(1.0, -registers[i]);
+        if (registers[i] == 0) ++emptyRegisters;
+    }
+    double alpha = 0.7213 / (1.0 + 1.079 / REGISTERS);
+    double rawEstimate = alpha * REGISTERS * REGISTERS / harmonicSum;
+    if (rawEstimate <= 2.5 * REGISTERS && emptyRegisters > 0) {  // Linear counting for small cardinalities
+        return REGISTERS * std::log((double)REGISTERS / emptyRegisters);
+    }
+    return rawEstimate;
+}
+
+void HyperLogLog::clear() {
+    std::fill(registers.begin(), registers.end(), 0);
+}
+
+uint64_t ColumnStatistics::hashValue(DataField* value) const {
+    uint64_t valueHash = (value->getType() == FieldType::STRING) ? std::hash<std::string>()(value->getValueString())
+                                                                 : (uint64_t)(uint32_t)value->getValueInt();
+    valueHash += 0x9E3779B97F4A7C15ull;  // SplitMix64 finalizer spreads the bits over the whole hash
+    valueHash = (valueHash ^ (valueHash >> 30)) * 0xBF58476D1CE4E5B9ull;
+    valueHash = (valueHash ^ (valueHash >> 27)) * 0x94D049BB133111EBull;
+    return valueHash ^ (valueHash >> 31);
+}
+
+void ColumnStatistics::add(DataField* value) {
+    ++rowCount;
+    ++modifiedRows;
+    distinctValues.add(hashValue(value));
+
+    if (columnType == FieldType::STRING) {  // Only a STRING can be empty, INT and DATE fields always hold a value
+        std::string stringValue = value->getValueString();
+        if (stringValue.empty() || stringValue == "\"\"") ++nullCount;
+        if (!hasBounds || stringValue < minString) minString = stringValue;
+        if (!hasBounds || stringValue > maxString) maxString = stringValue;
+    } else {
+        int intValue = value->getValueInt();
+        if (!hasBounds || intValue < minInt) minInt = intValue;
+        if (!hasBounds || intValue > maxInt) maxInt = intValue;
+    }
+    hasBounds = true;
+}
+
+void ColumnStatistics::remove(DataField* value) {  // The bounds and the sketch stay until the next ANALYZE
+    --rowCount;
+    ++modifiedRows;
+    if (columnType != FieldType::STRING) return;
+    std::string stringValue = value->getValueString();
+    if (stringValue.empty() || stringValue == "\"\"") --nullCount;
+}
+
+void ColumnStatistics::analyze(const std::vector<DataField*>& values) {
+    clear();
+    for (unsigned int i = 0; i < values.size(); ++i) add(values[i]);
+    modifiedRows = 0;
+    if (columnType == FieldType::STRING || values.empty()) return;
+
+    std::vector<int> keys;
+    keys.reserve(values.size());
+    for (unsigned int i = 0; i < values.size(); ++i) keys.push_back(values[i]->getValueInt());
+    std::sort(keys.begin(), keys.end());
+
+    for (unsigned int bucket = 1; bucket <= HISTOGRAM_BUCKETS; ++bucket) {  // Each bucket holds the same number of values
+        size_t lastInBucket = std::max((size_t)1, (keys.size() * bucket) / HISTOGRAM_BUCKETS) - 1;
+        histogramBounds.push_back(keys[lastInBucket]);
+    }
+    histogramRows = keys.size();
+}
+
+void ColumnStatistics::clear() {
+    rowCount = 0;
+    nullCount = 0;
+    distinctValues.clear();
+    hasBounds = false;
+    minString.clear();
+    maxString.clear();
+    histogramBounds.clear();
+    histogramRows = 0;
+    modifiedRows = 0;
+}
+
+int ColumnStatistics::getDistinctCount() const {
+    if (rowCount <= 0) return 0;
+    int distinctCount = (int)(distinctValues.estimate() + 0.5);
+    return std::max(1, std::min(distinctCount, rowCount));
+}
+
+double ColumnStatistics::fractionAtMost(double key) const {
+    if (!histogramBounds.empty()) {
+        double lowerBound = minInt;
+        for (unsigned int bucket = 0; bucket < histogramBounds.size(); ++bucket) {
+            if (key < histogramBounds[bucket]) {  // Linear interpolation inside the bucket
+                double bucketWidth = histogramBounds[bucket] - lowerBound;
+                double insideBucket = (bucketWidth > 0) ? std::max(0.0, (key - lowerBound) / bucketWidth) : 0.0;
+                return (bucket + insideBucket) / histogramBounds.size();
+            }
+            lowerBound = histogramBounds[bucket];
+        }
+        return 1.0;
+    }
+    if (!hasBounds || key < minInt) return 0.0;  // Uniform values between the bounds
+    if (key >= maxInt) return 1.0;
+    return (key - minInt + 1.0) / (maxInt - minInt + 1.0);
+}
+
+double ColumnStatistics::selectivity(OperatorType operatorCompare, int key) const {
+    if (rowCount <= 0) return 0.0;
+    double equalFraction = 1.0 / getDistinctCount();
+    if (hasBounds && (key < minInt || key > maxInt)) equalFraction = 0.0;
+
+    double result = 1.0;
+    switch (operatorCompare) {
+        case OperatorType::EQ:
+            result = equalFraction;
+            break;
+        case OperatorType::NE:
+            result = 1.0 - equalFraction;
+            break;
+        case OperatorType::LT:
+            result = fractionAtMost(key - 1.0);
+            break;
+        case OperatorType::LE:
+            result = fractionAtMost(key);
+            break;
+        case OperatorType::GT:
+            result = 1.0 - fractionAtMost(key);
+            break;
+        case OperatorType::GE:
+            result = 1.0 - fractionAtMost(key - 1.0);
+            break;
+        default:
+            break;
+    }
+    return std::max(0.0, std::min(1.0, result));
+}
+
+std::string ColumnStatistics::statisticsInfo() const {
+    std::string information = "rows=" + std::to_string(rowCount) +
+                              " nulls=" + std::to_string(nullCount) +
+                              " distinct~" + std::to_string(getDistinctCount());
+    if (hasBounds && rowCount > 0) {
+        if (columnType == FieldType::STRING) {
+            information += " min=" + minString + " max=" + maxString;
+        } else if (columnType == FieldType::DATE) {
+            information += " min=" + formatDate(minInt) + " max=" + formatDate(maxInt);
+        } else {
+            information += " min=" + std::to_string(minInt) + " max=" + std::to_string(maxInt);
+        }
+    }
+    if (!histogramBounds.empty()) information += " histogram=" + std::to_string(histogramBounds.size()) + " buckets";
+    if (modifiedRows > 0) information += " changed=" + std::to_string(modifiedRows);
+    return information;
+}
@@ -1,12 +1,19 @@
 #include "../Headers/table.hpp"
 
+std::atomic<unsigned long long> Table::versionCounter(0);
+
 std::string Table::fieldName(int indexField) {
     return tableFields[indexField]->fieldName;
 }
 
+FieldType Table::getFieldType(int indexField) const {
+    return tableFields[indexField]->fieldType;
+}
+
 int Table::tableSizeBytes() const {
     int sizeBytes = 0;
-    for (std::list<Record*>::const_iterator it = records.begin(); it != records.end(); ++it) {
+    for (std::vector<Record*>::const_iterator it = records.begin(); it != records.end(); ++it) {
+        if (!recordValid[(*it)->rowId]) continue;
         for (unsigned int i = 0; i < (*it)->fields.size(); ++i) {
             if ((*it)->fields[i]->getType() == FieldType::INT) sizeBytes += 4;
             if ((*it)->fields[i]->getType() == FieldType::STRING) sizeBytes += (*it)->fields[i]->getValueUniform().size();
@@ -16,15 +23,112 @@ int Table::tableSizeBytes() const {
     return sizeBytes;
 }
 
+int Table::compressedSizeBytes() const {
+    int sizeBytes = 0;
+    for (unsigned int i = 0; i < tableFields.size(); ++i) {
+        if (tableFields[i]->fieldType == FieldType::STRING) continue;
+        encodeColumn(i, [&sizeBytes](const CompressedBlock& encodedValues) { sizeBytes += encodedValues.encodedBytes(); });
+    }
+    return sizeBytes;
+}
+
+void Table::encodeColumn(unsigned int columnIndex, const std::function<void(const CompressedBlock&)>& blockSink) const {
+    std::vector<int> values;
+    values.reserve(BLOCK_ROWS);
+    CompressedBlock encodedValues;
+    for (unsigned int rowId = 0; rowId <= records.size(); ++rowId) {  // Removed records are skipped, a block holds the next valid values
+        if (rowId < records.size()) {
+            if (recordValid[rowId]) values.push_back(records[rowId]->fields[columnIndex]->getValueInt());
+            if (values.size() < BLOCK_ROWS) continue;
+        }
+        if (values.empty()) continue;
+        encodedValues.encode(values);
+        blockSink(encodedValues);
+        values.clear();
+    }
+}
+
+size_t Table::recordsMemoryBytes() const {
+    size_t sizeBytes = allocationBytes(records.capacity() * sizeof(Record*)) + recordValid.capacity() / 8;
+    for (std::vector<Record*>::const_iterator it = records.begin(); it != records.end(); ++it) {  // Removed records stay until VACUUM
+        sizeBytes += allocationBytes(sizeof(Record)) + allocationBytes((*it)->fields.capacity() * sizeof(DataField*));
+        for (unsigned int i = 0; i < (*it)->fields.size(); ++i) {
+            DataField* field = (*it)->fields[i];
+            if (field->getType() == FieldType::INT) sizeBytes += allocationBytes(sizeof(DataFieldInt));
+            if (field->getType() == FieldType::DATE) sizeBytes += allocationBytes(sizeof(DataFieldDate));
+            if (field->getType() == FieldType::STRING) sizeBytes += allocationBytes(sizeof(DataFieldString)) + textHeapBytes(field->getValueString().size());
+        }
+    }
+    return sizeBytes;
+}
+
+size_t Table::blocksMemoryBytes() const {
+    size_t sizeBytes = allocationBytes(blockSummaries.capacity() * sizeof(std::vector<BlockSummary>));
+    for (unsigned int block = 0; block < blockSummaries.size(); ++block) {
+        sizeBytes += allocationBytes(blockSummaries[block].capacity() * sizeof(BlockSummary));
+    }
+    return sizeBytes;
+}
+
+size_t Table::memoryBytes() const {
+    if (memoryVersion == tableVersion) return measuredMemory;
+    size_t sizeBytes = sizeof(Table) + recordsMemoryBytes() + blocksMemoryBytes();
+    for (unsigned int i = 0; i < tableFields.size(); ++i) {
+        sizeBytes += allocationBytes(sizeof(TableFieldData)) + sizeof(ColumnStatistics);
+        if (tableFields[i]->fieldIsIndex) sizeBytes += allocationBytes(sizeof(IndexedColumn)) + indexedColumns[i]->indexedStructure->memoryBytes();
+    }
+    memoryVersion = tableVersion;
+    measuredMemory = sizeBytes;
+    return sizeBytes;
+}
+
+std::string Table::memoryInfo() const {
+    std::string information = "Memory: " + std::to_string(memoryBytes()) + "bytes \n";
+    information += "  Records: " + std::to_string(recordsMemoryBytes()) + "bytes \n";
+    for (unsigned int i = 0; i < tableFields.size(); ++i) {
+        if (!tableFields[i]->fieldIsIndex) continue;
+        information += "  Index " + tableFields[i]->fieldName + ": " + std::to_string(indexedColumns[i]->indexedStructure->memoryBytes()) + "bytes \n";
+    }
+    information += "  Blocks: " + std::to_string(blocksMemoryBytes()) + "bytes \n";
+    return information;
+}
+
 void Table::clearTable() {
-    while (!records.empty()) records.pop_back();
+    clearUndoLog();
+    flagLogging = false;
+    while (!records.empty()) {
+        delete records.back();
+        records.pop_back();
+    }
+    recordValid.clear();
+    removedRecords = 0;
+    blockSummaries.clear();
     while (!tableFields.empty()) tableFields.pop_back();
+    fieldIndexes.clear();
+    columnStatistics.clear();
+    for (unsigned int i = 0; i < indexedColumns.size(); ++i) delete indexedColumns[i];
     indexedColumns.clear();
+    changeVersion();
 }
 
 void Table::cleanTable() {
-    while (!records.empty()) records.pop_back();
-    indexedColumns.clear();
+    while (!records.empty()) {  // The records are in the file, their memory is released
+        delete records.back();
+        records.pop_back();
+    }
+    records.shrink_to_fit();
+    recordValid.clear();
+    recordValid.shrink_to_fit();
+    removedRecords = 0;
+    blockSummaries.clear();
+    blockSummaries.shrink_to_fit();
+    for (unsigned int i = 0; i < columnStatistics.size(); ++i) columnStatistics[i].clear();
+    for (unsigned int i = 0; i < indexedColumns.size(); ++i) {  // Empty indexes, filled again when the table is opened
+        if (!indexedColumns[i]) continue;
+        delete indexedColumns[i]->indexedStructure;
+        indexedColumns[i]->indexedStructure = createRecordIndex(i, tableFields[i]->fieldType, tableFields[i]->fieldIndexType);
+    }
+    changeVersion();
 }
 
 std::string Table::getTableName() const {
@@ -36,7 +140,15 @@ int Table::getTableColumnsSize() const {
 }
 
 int Table::getTableNumberOfRecords() const {
-    return records.size();
+    return records.size() - removedRecords;
+}
+
+int Table::getTableRemovedRecords() const {
+    return removedRecords;
+}
+
+unsigned long long Table::getTableVersion() const {
+    return tableVersion;
 }
 
 void Table::setSaved() {
@@ -47,6 +159,14 @@ void Table::setLoaded() {
     savedAsFile = false;
 }
 
+void Table::addObserver(TableObserver* observer) {
+    if (std::find(observers.begin(), observers.end(), observer) == observers.end()) observers.push_back(observer);
+}
+
+void Table::removeObserver(TableObserver* observer) {
+    observers.erase(std::remove(observers.begin(), observers.end(), observer), observers.end());
+}
+
 bool Table::getSaved() const {
     return savedAsFile;
 }
@@ -58,13 +178,59 @@ std::string Table::tableInfo() const {
         information += tableFields[i]->fieldName + ":" + FieldTypeList[(int)tableFields[i]->fieldType] +
                        (tableFields[i]->fieldNotNull ? ", NOTNULL" : "") +
                        (tableFields[i]->fieldIsIndex ? ", INDEX" : "") +
+                       (tableFields[i]->fieldIsIndex && tableFields[i]->fieldIndexType != IndexType::AVL ? (std::string(" ") + IndexTypeList[(int)tableFields[i]->fieldIndexType]) : "") +
                        (!tableFields[i]->fieldDefault.empty() ? (", DEFAULT " + tableFields[i]->fieldDefault) : "") + "\n";
     }
-    information += "Records: " + std::to_string(records.size()) + " \n";
+    information += "Records: " + std::to_string(getTableNumberOfRecords()) + " \n";
+    if (removedRecords > 0) information += "Removed: " + std::to_string(removedRecords) + " (VACUUM to reclaim) \n";
     information += "Data: " + std::to_string(tableSizeBytes()) + "bytes \n";
+    int compressedBytes = compressedSizeBytes();
+    if (compressedBytes > 0) information += "Compressed: " + std::to_string(compressedBytes) + "bytes of INT and DATE values in the file \n";
+    information += memoryInfo();
+    information += statisticsInfo();
+    return information;
+}
+
+std::string Table::statisticsInfo() const {
+    std::string information = "Statistics: \n";
+    for (unsigned int i = 0; i < tableFields.size(); ++i) {
+        information += "  " + tableFields[i]->fieldName + ": " + columnStatistics[i].statisticsInfo() + "\n";
+    }
     return information;
 }
 
+void Table::analyzeTable() {
+    std::vector<DataField*> values;
+    values.reserve(getTableNumberOfRecords());
+    for (unsigned int i = 0; i < tableFields.size(); ++i) {
+        values.clear();
+        for (unsigned int rowId = 0; rowId < records.size(); ++rowId) {
+            if (recordValid[rowId]) values.push_back(records[rowId]->fields[i]);
+        }
+        columnStatistics[i].analyze(values);
+    }
+}
+
+bool Table::useIndex(int columnIndex, OperatorType operatorCompare, const std::string& value) const {
+    if (tableFields[columnIndex]->fieldType == FieldType::STRING) {  // Strings have no statistics, the index is used for a narrower range of keys
+        if (value.empty() || !isString(value) || operatorCompare == OperatorType::NE) return false;
+        return operatorCompare != OperatorType::LIKE || likePrefix(value).size() > 1;
+    }
+    int key = 0;
+    if (operatorCompare == OperatorType::LIKE) return false;
+    if (operatorCompare == OperatorType::EQ || !parseKey(columnIndex, value, key)) return true;
+    return columnStatistics[columnIndex].selectivity(operatorCompare, key) <= INDEX_SELECTIVITY_LIMIT;
+}
+
+Table* Table::emptyCopy() const {
+    Table* copiedTable = new Table(tableName);
+    for (unsigned int i = 0; i < tableFields.size(); ++i) {
+        copiedTable->addField(tableFields[i]->fieldName, tableFields[i]->fieldType, tableFields[i]->fieldNotNull,
+                              tableFields[i]->fieldIsIndex, tableFields[i]->fieldDefault, tableFields[i]->fieldIndexType);
+    }
+    return copiedTable;
+}
+
 std::string Table::tableDefinition() const {
     std::string information;
     information += "CREATETABLE " + tableName + " (";
@@ -72,6 +238,7 @@ std::string Table::tableDefinition() const {
         information += tableFields[i]->fieldName + ":" + FieldTypeList[(int)tableFields[i]->fieldType] +
                        (tableFields[i]->fieldNotNull ? " NOTNULL" : "") +
                        (tableFields[i]->fieldIsIndex ? " INDEX" : "") +
+                       (tableFields[i]->fieldIsIndex && tableFields[i]->fieldIndexType != IndexType::AVL ? (std::string(" ") + IndexTypeList[(int)tableFields[i]->fieldIndexType]) : "") +
                        (!tableFields[i]->fieldDefault.empty() ? (" DEFAULT " + tableFields[i]->fieldDefault) : "");
         if (i + 1 < tableFields.size()) information += ", ";
     }
@@ -81,7 +248,8 @@ std::string Table::tableDefinition() const {
 
 std::string Table::recordDefinition() const {
     std::string information;
-    for (std::list<Record*>::const_iterator it = records.begin(); it != records.end(); ++it) {
+    for (std::vector<Record*>::const_iterator it = records.begin(); it != records.end(); ++it) {
+        if (!recordValid[(*it)->rowId]) continue;
         information += "INSERT " + tableName + " (";
         for (unsigned int i = 0; i < (*it)->fields.size(); ++i) {
             information += (*it)->fields[i]->getValueUniform();
@@ -92,70 +260,277 @@ std::string Table::recordDefinition() const {
     return information;
 }
 
+void Table::writeSnapshot(std::string& buffer, const std::function<void(std::string&)>& flushBuffer, size_t flushBytes) const {
+    auto flushIfFull = [&]() {  // Checked per value, the sink is called once per full buffer
+        if (flushBuffer && buffer.size() >= flushBytes) flushBuffer(buffer);
+    };
+    writeBinaryText(buffer, tableName);
+    writeBinary(buffer, tableFields.size(), 4);
+    for (unsigned int i = 0; i < tableFields.size(); ++i) {
+        writeBinaryText(buffer, tableFields[i]->fieldName);
+        writeBinary(buffer, (unsigned int)tableFields[i]->fieldType, 1);
+        writeBinary(buffer, tableFields[i]->fieldNotNull, 1);
+        writeBinary(buffer, tableFields[i]->fieldIsIndex, 1);
+        writeBinary(buffer, (unsigned int)tableFields[i]->fieldIndexType, 1);
+        writeBinaryText(buffer, tableFields[i]->fieldDefault);
+    }
+
+    writeBinary(buffer, getTableNumberOfRecords(), 4);
+    for (unsigned int i = 0; i < tableFields.size(); ++i) {  // Values of a column are written together, INT and DATE as compressed blocks
+        if (tableFields[i]->fieldType == FieldType::STRING) {
+            for (std::vector<Record*>::const_iterator it = records.begin(); it != records.end(); ++it) {
+                if (!recordValid[(*it)->rowId]) continue;
+                writeBinaryText(buffer, (*it)->fields[i]->getValueString());
+                flushIfFull();
+            }
+            continue;
+        }
+        encodeColumn(i, [&](const CompressedBlock& encodedValues) {
+            encodedValues.writeBlock(buffer);
+            flushIfFull();
+        });
+    }
+
+    // The key order of each index as positions of the written records, so loading does not sort again
+    std::vector<unsigned int> writtenPosition(records.size());
+    unsigned int validRecords = 0;
+    for (unsigned int rowId = 0; rowId < records.size(); ++rowId) {
+        if (recordValid[rowId]) writtenPosition[rowId] = validRecords++;
+    }
+    for (unsigned int i = 0; i < tableFields.size(); ++i) {
+        if (!tableFields[i]->fieldIsIndex) continue;
+        std::vector<Record*> indexedRecords = indexedColumns[i]->indexedStructure->orderedRecords();
+        for (unsigned int j = 0; j < indexedRecords.size(); ++j) {
+            writeBinary(buffer, writtenPosition[indexedRecords[j]->rowId], 4);
+            if (j % BLOCK_ROWS == 0) flushIfFull();
+        }
+    }
+}
+
+Table* Table::readSnapshot(const char*& position, const char* end) {
+    std::string readName;
+    unsigned long long fieldsCount = 0, recordsCount = 0;
+    if (!readBinaryText(position, end, readName) || !readBinary(position, end, fieldsCount, 4)) {
+        throw std::invalid_argument("[!] Invalid snapshot file! The table structure is damaged!");
+    }
+
+    Table* newTable = new Table(readName);
+    std::vector<Record*> newRecords;
+    try {
+        for (unsigned int i = 0; i < fieldsCount; ++i) {
+            std::string readFieldName, readDefault;
+            unsigned long long readType = 0, readNotNull = 0, readIsIndex = 0, readIndexType = 0;
+            if (!readBinaryText(position, end, readFieldName) || !readBinary(position, end, readType, 1) ||
+                !readBinary(position, end, readNotNull, 1) || !readBinary(position, end, readIsIndex, 1) ||
+                !readBinary(position, end, readIndexType, 1) || !readBinaryText(position, end, readDefault) ||
+                readType == 0 || readType >= (int)(FieldType::COUNTFIELDTYPE) || readIndexType >= (int)(IndexType::COUNTINDEXTYPE)) {
+                throw std::invalid_argument("[!] Invalid snapshot file! The table structure is damaged!");
+            }
+            newTable->addField(readFieldName, (FieldType)readType, readNotNull, readIsIndex, readDefault, (IndexType)readIndexType);
+        }
+
+        // Each STRING value takes at least its length, each block of INT or DATE values at least its type and count
+        unsigned long long stringColumns = 0;
+        for (unsigned int i = 0; i < fieldsCount; ++i) stringColumns += (newTable->tableFields[i]->fieldType == FieldType::STRING);
+        if (!readBinary(position, end, recordsCount, 4) || (fieldsCount == 0 && recordsCount > 0) ||
+            recordsCount * 4 * stringColumns + (recordsCount + BLOCK_ROWS - 1) / BLOCK_ROWS * 5 * (fieldsCount - stringColumns) > (unsigned long long)(end - position)) {
+            throw std::invalid_argument("[!] Invalid snapshot file! The records are damaged!");
+        }
+        std::vector<int> values;
+        CompressedBlock encodedValues;
+        for (unsigned int i = 0; i < fieldsCount; ++i) {
+            FieldType readType = newTable->tableFields[i]->fieldType;
+            std::string stringValue;
+            for (unsigned int row = 0; row < recordsCount; ++row) {
+                if (i == 0) {  // The records are created with the values of the first column
+                    newRecords.push_back(new Record);
+                    newRecords[row]->fields.reserve(fieldsCount);
+                }
+                if (readType == FieldType::STRING) {
+                    if (!readBinaryText(position, end, stringValue)) throw std::invalid_argument("[!] Invalid snapshot file! The records are damaged!");
+                    newRecords[row]->fields.push_back(new DataFieldString(stringValue));
+                    continue;
+                }
+                if (row % BLOCK_ROWS == 0) {  // Each block must hold the values of the next rows
+                    unsigned int blockRows = std::min((unsigned int)recordsCount - row, BLOCK_ROWS);
+                    if (!encodedValues.readBlock(position, end) || encodedValues.getValuesCount() != blockRows) {
+                        throw std::invalid_argument("[!] Invalid snapshot file! The records are damaged!");
+                    }
+                    encodedValues.decode(values);
+                }
+                if (readType == FieldType::INT) {
+                    newRecords[row]->fields.push_back(new DataFieldInt(values[row % BLOCK_ROWS]));
+                } else {
+                    newRecords[row]->fields.push_back(new DataFieldDate(values[row % BLOCK_ROWS]));
+                }
+            }
+        }
+    } catch (...) {
+        for (unsigned int row = 0; row < newRecords.size(); ++row) delete newRecords[row];
+        delete newTable;
+        throw;
+    }
+    newTable->records.reserve(newRecords.size());
+    newTable->recordValid.reserve(newRecords.size());
+    for (unsigned int row = 0; row < newRecords.size(); ++row) newTable->appendRecord(newRecords[row]);
+
+    for (unsigned int i = 0; i < fieldsCount; ++i) {  // The stored key order is checked, a damaged order is sorted again
+        if (!newTable->tableFields[i]->fieldIsIndex) continue;
+        std::vector<Record*> sortedRecords(newRecords.size(), nullptr);
+        std::vector<bool> flagUsed(newRecords.size(), false);
+        bool flagSorted = (unsigned long long)(end - position) >= 4 * newRecords.size();
+        const char* orderEnd = flagSorted ? position + 4 * newRecords.size() : end;
+        unsigned long long row = 0;
+        for (unsigned int j = 0; j < sortedRecords.size() && flagSorted; ++j) {
+            flagSorted = readBinary(position, orderEnd, row, 4) && row < newRecords.size() && !flagUsed[row];
+            if (!flagSorted) break;
+            flagUsed[row] = true;
+            sortedRecords[j] = newRecords[row];
+            flagSorted = (j == 0 || !newTable->compareRecords(sortedRecords[j], sortedRecords[j - 1], i));
+        }
+        position = orderEnd;
+        if (!flagSorted) {
+            sortedRecords = newRecords;
+            std::stable_sort(sortedRecords.begin(), sortedRecords.end(), [newTable, i](Record* record1, Record* record2) {
+                return newTable->compareRecords(record1, record2, i);
+            });
+        }
+        newTable->indexedColumns[i]->indexedStructure->insertSorted(sortedRecords);
+    }
+    return newTable;
+}
+
 void Table::addRecord(std::vector<std::string> recordValuesInput) {
-    int recordValuesSize = recordValuesInput.size();
+    size_t recordValuesSize = recordValuesInput.size();
     if (tableFields.size() != recordValuesSize) {
         throw std::invalid_argument("[!] Invalid number of input arguments for the record!");
     } else {
         Record* newRecord = new Record;
+        try {
+            for (unsigned int i = 0; i < recordValuesSize; ++i) {
+                newRecord->fields.push_back(createField(i, recordValuesInput[i]));
+            }
+        } catch (...) {
+            delete newRecord;
+            throw;
+        }
+
         for (unsigned int i = 0; i < recordValuesSize; ++i) {
-            if (!(tableFields[i]->fieldNotNull && recordValuesInput[i] == "")) {
-                switch (tableFields[i]->fieldType) {
-                    case FieldType::INT:
-                        if (isNumber(recordValuesInput[i])) {
-                            if (tableFields[i]->fieldDefault != "" && recordValuesInput[i] == "") {
-                                newRecord->fields.push_back(new DataFieldInt(stoi(tableFields[i]->fieldDefault)));  // Use default value
-                            } else {
-                                newRecord->fields.push_back(new DataFieldInt(stoi(recordValuesInput[i])));  // Use input value
-                            }
-                        } else {
-                            throw std::invalid_argument("[!] Invalid input parameter for the record! INT is required for the field!");
-                        }
-                        break;
-                    case FieldType::STRING:
-                        if (isString(recordValuesInput[i])) {
-                            if (tableFields[i]->fieldDefault != "" && recordValuesInput[i] == "") {
-                                newRecord->fields.push_back(new DataFieldString(tableFields[i]->fieldDefault));  // Use default value
-                            } else {
-                                newRecord->fields.push_back(new DataFieldString(recordValuesInput[i]));  // Use input value
-                            }
-                        } else {
-                            throw std::invalid_argument("[!] Invalid input parameter for the record! STRING is required for the field!");
-                        }
-                        break;
-
-                    case FieldType::DATE:
-                        if (isDate(recordValuesInput[i])) {
-                            if (tableFields[i]->fieldDefault != "" && recordValuesInput[i] == "") {
-                                newRecord->fields.push_back(new DataFieldDate(tableFields[i]->fieldDefault));  // Use default value
-                            } else {
-                                newRecord->fields.push_back(new DataFieldDate(recordValuesInput[i]));  // Use input value
-                            }
-                        } else {
-                            throw std::invalid_argument("[!] Invalid input parameter for the record! DATE is required for the field!");
-                        }
-                        break;
-                    default:
-                        throw std::runtime_error("[!] Invalid field type!");
-                }
+            if (tableFields[i]->fieldIsIndex) {  // Add to the index
+                indexedColumns[i]->indexedStructure->insert(newRecord);
+            }
+        }
+        appendRecord(newRecord);
+    }
+}
+
+void Table::addRecords(const std::vector<std::vector<std::string>>& recordsValuesInput) {
+    for (unsigned int row = 0; row < recordsValuesInput.size(); ++row) {
+        if (tableFields.size() != recordsValuesInput[row].size()) {
+            throw std::invalid_argument("[!] Invalid number of input arguments for the record!");
+        }
+    }
+
+    std::vector<Record*> newRecords(recordsValuesInput.size());
+    for (unsigned int row = 0; row < newRecords.size(); ++row) {
+        newRecords[row] = new Record;
+        newRecords[row]->fields.reserve(tableFields.size());
+    }
+    try {  // Column by column, the same field checks run over the whole batch
+        for (unsigned int i = 0; i < tableFields.size(); ++i) {
+            for (unsigned int row = 0; row < newRecords.size(); ++row) {
+                newRecords[row]->fields.push_back(createField(i, recordsValuesInput[row][i]));
+            }
+        }
+    } catch (...) {
+        for (unsigned int row = 0; row < newRecords.size(); ++row) delete newRecords[row];
+        throw;
+    }
+    appendRecords(newRecords);
+}
+
+void Table::appendRecords(const std::vector<Record*>& newRecords) {
+    records.reserve(records.size() + newRecords.size());
+    recordValid.reserve(recordValid.size() + newRecords.size());
+    for (unsigned int row = 0; row < newRecords.size(); ++row) appendRecord(newRecords[row]);
+
+    for (unsigned int i = 0; i < tableFields.size(); ++i) {  // A single sorted insert for each index
+        if (!tableFields[i]->fieldIsIndex) continue;
+        std::vector<Record*> sortedRecords(newRecords);
+        std::stable_sort(sortedRecords.begin(), sortedRecords.end(), [this, i](Record* record1, Record* record2) {
+            return compareRecords(record1, record2, i);
+        });
+        indexedColumns[i]->indexedStructure->insertSorted(sortedRecords);
+    }
+}
 
-                if (tableFields[i]->fieldIsIndex) {  // Add to the index
-                    indexedColumns[i]->indexedStructure->insert(newRecord);
+DataField* Table::createField(int columnIndex, const std::string& valueInput) const {
+    if (tableFields[columnIndex]->fieldNotNull && valueInput == "") {
+        throw std::invalid_argument("[!] Invalid input parameter for the record! The value cannot be empty!");
+    }
+    const std::string& fieldDefault = tableFields[columnIndex]->fieldDefault;
+    switch (tableFields[columnIndex]->fieldType) {
+        case FieldType::INT:
+            if (isNumber(valueInput)) {
+                if (fieldDefault != "" && valueInput == "") {
+                    return new DataFieldInt(stoi(fieldDefault));  // Use default value
+                } else {
+                    return new DataFieldInt(stoi(valueInput));  // Use input value
                 }
-            } else {
-                throw std::invalid_argument("[!] Invalid input parameter for the record! The value cannot be empty!");
             }
+            throw std::invalid_argument("[!] Invalid input parameter for the record! INT is required for the field!");
+        case FieldType::STRING:
+            if (isString(valueInput)) {
+                if (fieldDefault != "" && valueInput == "") {
+                    return new DataFieldString(fieldDefault);  // Use default value
+                } else {
+                    return new DataFieldString(valueInput);  // Use input value
+                }
+            }
+            throw std::invalid_argument("[!] Invalid input parameter for the record! STRING is required for the field!");
+        case FieldType::DATE: {
+            int dayNumber = 0;
+            if (fieldDefault != "" && valueInput == "" && parseDate(fieldDefault, dayNumber)) {
+                return new DataFieldDate(dayNumber);  // Use default value
+            } else if (parseDate(valueInput, dayNumber)) {
+                return new DataFieldDate(dayNumber);  // Use input value
+            }
+            throw std::invalid_argument("[!] Invalid input parameter for the record! DATE is required for the field!");
         }
+        default:
+            throw std::runtime_error("[!] Invalid field type!");
+    }
+}
+
+bool Table::equalFields(DataField* field1, DataField* field2) const {
+    if (field1->getType() == FieldType::STRING) return field1->getValueString() == field2->getValueString();
+    return field1->getValueInt() == field2->getValueInt();
+}
+
+void Table::appendRecord(Record* newRecord) {
+    for (unsigned int i = 0; i < newRecord->fields.size(); ++i) columnStatistics[i].add(newRecord->fields[i]);
+    newRecord->rowId = records.size();
+    records.push_back(newRecord);
+    recordValid.push_back(true);
+    changeVersion();
 
-        records.push_back(newRecord);
+    if (newRecord->rowId % BLOCK_ROWS == 0) blockSummaries.push_back(std::vector<BlockSummary>(tableFields.size()));
+    for (unsigned int i = 0; i < newRecord->fields.size(); ++i) blockSummaries.back()[i].add(newRecord->fields[i]);
+    for (unsigned int i = 0; i < observers.size(); ++i) observers[i]->recordAdded(this, newRecord);
+    if (flagLogging) {  // Consecutive appended records share a single entry
+        if (!undoLog.empty() && undoLog.back().undoType == UndoType::INSERTED && undoLog.back().rowId + undoLog.back().rowCount == newRecord->rowId) {
+            ++undoLog.back().rowCount;
+        } else {
+            undoLog.push_back(UndoEntry());
+            undoLog.back().undoType = UndoType::INSERTED;
+            undoLog.back().rowId = newRecord->rowId;
+        }
     }
 }
 
 int Table::getFieldIndexByName(const std::string& selectedColumn) const {
-    for (unsigned int i = 0; i < tableFields.size(); ++i) {
-        if (tableFields[i]->fieldName == selectedColumn) return i;
-    }
-    return -1;
+    std::unordered_map<std::string, int>::const_iterator it = fieldIndexes.find(selectedColumn);
+    return it == fieldIndexes.end() ? -1 : it->second;
 }
 
 std::string Table::calculateWhere(Record* currentRecord, std::string operand1, std::string operand2, std::string operator0) {
@@ -164,6 +539,7 @@ std::string Table::calculateWhere(Record* currentRecord, std::string operand1, s
         std::string swap = operand1;
         operand1 = operand2;
         operand2 = swap;
+        operatorType = mirrorOperator(operatorType);  // 5 < <field> is <field> > 5
     }
     if (!(isTrueOrFalse(operand1) || isTrueOrFalse(operand2))) {
         if (getFieldIndexByName(operand1) >= 0 && getFieldIndexByName(operand2) == -1) {
@@ -174,29 +550,26 @@ std::string Table::calculateWhere(Record* currentRecord, std::string operand1, s
             throw std::invalid_argument("[!] Invalid selection structure! The operands should be field names!");
         }
         if (OperatorTypePriorityList[(int)operatorType] == 1) {
-            operand1 = currentRecord->fields[getFieldIndexByName(operand1)]->getValueUniform();
+            DataField* field = currentRecord->fields[getFieldIndexByName(operand1)];
+            if (operatorType == OperatorType::LIKE) {
+                if (field->getType() != FieldType::STRING || !isString(operand2)) {
+                    throw std::invalid_argument("[!] Invalid selection structure! LIKE requires a STRING field and pattern!");
+                }
+                return matchLike(field->getValueString(), operand2) ? "#TRUE" : "#FALSE";
+            }
+            if (field->getType() == FieldType::DATE) {  // Dates are compared by their day numbers
+                int operand2date = 0;
+                if (!parseDate(operand2, operand2date)) {
+                    throw std::invalid_argument("[!] Invalid selection structure! DATE is required for the operand!");
+                }
+                return compareIntegers(field->getValueInt(), operand2date, operatorType) ? "#TRUE" : "#FALSE";
+            }
+            operand1 = field->getValueUniform();
         }
     }
 
     if (isNumber(operand1)) {
-        int operand1int = stoi(operand1);
-        int operand2int = stoi(operand2);
-        switch (operatorType) {
-            case OperatorType::EQ:
-                return (operand1int == operand2int) ? "#TRUE" : "#FALSE";
-            case OperatorType::NE:
-                return (operand1int != operand2int) ? "#TRUE" : "#FALSE";
-            case OperatorType::GT:
-                return (operand1int > operand2int) ? "#TRUE" : "#FALSE";
-            case OperatorType::LT:
-                return (operand1int < operand2int) ? "#TRUE" : "#FALSE";
-            case OperatorType::GE:
-                return (operand1int >= operand2int) ? "#TRUE" : "#FALSE";
-            case OperatorType::LE:
-                return (operand1int <= operand2int) ? "#TRUE" : "#FALSE";
-            default:
-                return "#FALSE";
-        }
+        return compareIntegers(stoi(operand1), stoi(operand2), operatorType) ? "#TRUE" : "#FALSE";
     } else {
         switch (operatorType) {
             case OperatorType::EQ:
@@ -225,11 +598,8 @@ bool Table::isInSelection(Record* currentRecord, std::queue<std::string> operand
     std::stack<std::string> solution;
     while (!operands.empty()) {
         if (operands.front() == "NOT") {  // Boolean operators directly access the solution
-            if (solution.top() == "#FALSE") {
-                solution.push("#FALSE");
-            } else {
-                solution.push("#TRUE");
-            }
+            if (solution.empty()) throw std::invalid_argument("[!] Invalid expression! Invalid number of arguments!");
+            solution.top() = (solution.top() == "#TRUE") ? "#FALSE" : "#TRUE";
             operands.pop();
         } else {
             std::string operand1, operand2;
@@ -289,106 +659,857 @@ std::queue<std::string> Table::transformConditions(std::vector<std::string> wher
     return operands;
 }
 
-std::list<Record*> Table::selectRecordsWhere(std::vector<std::string> whereConditions) {
-    std::list<Record*> selectedRecords;
-    selectedRecords.clear();
-    if (records.size() == 0) return selectedRecords;
+bool Table::compileConditions(std::queue<std::string> operands, std::vector<CompiledCondition>& compiledConditions) const {
+    compiledConditions.clear();
+    int resultsCount = 0;
+    while (!operands.empty()) {  // The same steps as isInSelection, with the same checks of the operands
+        std::string operand1 = operands.front();
+        operands.pop();
+        CompiledCondition condition;
+        condition.operatorType = (OperatorType)getOperator(operand1);
+        if (condition.operatorType == OperatorType::AND || condition.operatorType == OperatorType::OR) {
+            if (resultsCount < 2) return false;
+            --resultsCount;
+            compiledConditions.push_back(condition);
+            continue;
+        }
+        if (condition.operatorType == OperatorType::NOT) {
+            if (resultsCount < 1) return false;
+            compiledConditions.push_back(condition);
+            continue;
+        }
+        if (condition.operatorType != OperatorType::UNDEF || operands.size() < 2) return false;  // Incomplete conditions
+
+        std::string operand2 = operands.front();
+        operands.pop();
+        condition.operatorType = (OperatorType)getOperator(operands.front());
+        operands.pop();
+        if (OperatorTypePriorityList[(int)condition.operatorType] != 1) return false;
+        if (getFieldIndexByName(operand1) == -1 && getFieldIndexByName(operand2) >= 0) {
+            std::swap(operand1, operand2);
+            condition.operatorType = mirrorOperator(condition.operatorType);
+        }
+        condition.columnIndex = getFieldIndexByName(operand1);
+        if (condition.columnIndex < 0 || getFieldIndexByName(operand2) >= 0 || operand2.empty() || isTrueOrFalse(operand1) || isTrueOrFalse(operand2)) return false;
+        if (!(isNumber(operand2) || isString(operand2) || isDate(operand2))) return false;
+
+        // Literals that make calculateWhere throw are left to it, so the errors stay the same
+        condition.fieldType = tableFields[condition.columnIndex]->fieldType;
+        condition.stringKey = operand2;
+        if (condition.operatorType == OperatorType::LIKE) {
+            if (condition.fieldType != FieldType::STRING || !isString(operand2)) return false;
+        } else if (condition.fieldType == FieldType::DATE) {
+            if (!parseDate(operand2, condition.intKey)) return false;
+        } else if (condition.fieldType == FieldType::INT) {
+            if (!isNumber(operand2) || operand2.size() >= 10) return false;
+            condition.intKey = stoi(operand2);
+        }
+        compiledConditions.push_back(condition);
+        ++resultsCount;
+    }
+    return resultsCount == 1;
+}
+
+bool Table::matchesConditions(Record* currentRecord, const std::vector<CompiledCondition>& compiledConditions, std::vector<unsigned char>& results) const {
+    results.clear();
+    for (std::vector<CompiledCondition>::const_iterator it = compiledConditions.begin(); it != compiledConditions.end(); ++it) {
+        if (it->operatorType == OperatorType::NOT) {
+            results.back() = !results.back();
+            continue;
+        }
+        if (it->operatorType == OperatorType::AND || it->operatorType == OperatorType::OR) {
+            unsigned char lastResult = results.back();
+            results.pop_back();
+            results.back() = (it->operatorType == OperatorType::AND) ? (results.back() && lastResult) : (results.back() || lastResult);
+            continue;
+        }
+        DataField* field = currentRecord->fields[it->columnIndex];
+        if (it->operatorType == OperatorType::LIKE) {
+            results.push_back(matchLike(field->getValueString(), it->stringKey));
+        } else if (it->fieldType == FieldType::DATE) {
+            results.push_back(compareIntegers(field->getValueInt(), it->intKey, it->operatorType));
+        } else if (it->fieldType == FieldType::INT) {  // Negative values are compared as text, as in calculateWhere
+            int value = field->getValueInt();
+            results.push_back(value >= 0 ? compareIntegers(value, it->intKey, it->operatorType) : compareStrings(std::to_string(value), it->stringKey, it->operatorType));
+        } else {
+            results.push_back(compareStrings(field->getValueString(), it->stringKey, it->operatorType));
+        }
+    }
+    return results.back();
+}
+
+std::vector<unsigned int> Table::selectRowIdsWhere(const std::vector<std::string>& whereConditions, int maxRecords, QueryProfiler* profiler) {
+    std::vector<unsigned int> rowIds;
+    if (getTableNumberOfRecords() == 0 || maxRecords == 0) return rowIds;
+    size_t recordsLimit = (maxRecords >= 0) ? (size_t)maxRecords : SIZE_MAX;  // Number of records for the LIMIT
     if (whereConditions.empty()) {
-        return records;
+        if (profiler) profiler->describeStage("all records");
+        rowIds.reserve(maxRecords >= 0 ? std::min(maxRecords, getTableNumberOfRecords()) : getTableNumberOfRecords());
+        for (unsigned int rowId = 0; rowId < records.size(); ++rowId) {
+            if (!recordValid[rowId]) continue;
+            rowIds.push_back(rowId);
+            if (rowIds.size() == recordsLimit) break;  // Enough records for the LIMIT
+        }
+        return rowIds;
     } else {
         if (whereConditions.size() == 3) {
             OperatorType smartOperator = (OperatorType)getOperator(whereConditions[1]);
             int selectedColumn = getFieldIndexByName(whereConditions[0]);
-            if (selectedColumn >= 0 && tableFields[selectedColumn]->fieldIsIndex) {
-                return indexedColumns[selectedColumn]->indexedStructure->searchNode(whereConditions[2], smartOperator);
+            if (selectedColumn >= 0 && tableFields[selectedColumn]->fieldIsIndex && useIndex(selectedColumn, smartOperator, whereConditions[2])) {
+                if (profiler) profiler->describeStage("index on " + tableFields[selectedColumn]->fieldName);
+                std::list<Record*> indexRecords = indexedColumns[selectedColumn]->indexedStructure->searchNode(whereConditions[2], smartOperator, maxRecords);
+                rowIds.reserve(indexRecords.size());
+                for (std::list<Record*>::iterator it = indexRecords.begin(); it != indexRecords.end(); ++it) rowIds.push_back((*it)->rowId);
+                return rowIds;
             }
         }
 
+        int rangeColumn = -1, rangeLow = 0, rangeHigh = 0;
+        if (rangeCondition(whereConditions, rangeColumn, rangeLow, rangeHigh)) {
+            if (profiler) profiler->describeStage("range scan on " + tableFields[rangeColumn]->fieldName);
+            return selectRowIdsRange(rangeColumn, rangeLow, rangeHigh, maxRecords);
+        }
+
+        // The conditions are resolved once, only conditions that cannot be compiled are interpreted for each record
         std::queue<std::string> operands = transformConditions(whereConditions);
-        for (std::list<Record*>::iterator it = records.begin(); it != records.end(); ++it) {
-            if (isInSelection((*it), operands)) {
-                selectedRecords.push_back(*it);
+        std::vector<CompiledCondition> compiledConditions;
+        std::vector<unsigned char> results;
+        bool flagCompiled = compileConditions(operands, compiledConditions);
+        std::vector<bool> scannedBlocks = candidateBlocks(whereConditions);
+        if (profiler) {
+            int countBlocks = std::count(scannedBlocks.begin(), scannedBlocks.end(), true);
+            profiler->describeStage("scan of " + std::to_string(countBlocks) + "/" + std::to_string(scannedBlocks.size()) + " blocks");
+        }
+        for (unsigned int block = 0; block < scannedBlocks.size(); ++block) {
+            if (!scannedBlocks[block]) continue;  // No record in the block can satisfy the conditions
+            unsigned int blockEnd = std::min((unsigned int)records.size(), (block + 1) * BLOCK_ROWS);
+            for (unsigned int rowId = block * BLOCK_ROWS; rowId < blockEnd; ++rowId) {
+                if (!recordValid[rowId]) continue;
+                if (flagCompiled ? matchesConditions(records[rowId], compiledConditions, results) : isInSelection(records[rowId], operands)) {
+                    rowIds.push_back(rowId);
+                    if (rowIds.size() == recordsLimit) return rowIds;  // Enough records for the LIMIT
+                }
             }
         }
     }
+    return rowIds;
+}
+
+std::list<Record*> Table::selectRecordsWhere(std::vector<std::string> whereConditions, int maxRecords, QueryProfiler* profiler) {
+    std::vector<unsigned int> rowIds = selectRowIdsWhere(whereConditions, maxRecords, profiler);
+    std::list<Record*> selectedRecords;
+    for (unsigned int i = 0; i < rowIds.size(); ++i) selectedRecords.push_back(records[rowIds[i]]);
     return selectedRecords;
 }
 
-bool Table::isDistinctSelection(Record* currentRecord, std::list<Record*> alreadySelected, std::vector<int> columnsIndex) {
-    for (std::list<Record*>::iterator it = alreadySelected.begin(); it != alreadySelected.end(); ++it) {
-        bool flagUnique = false;
-        for (unsigned int i = 0; i < columnsIndex.size(); ++i) {
-            if (currentRecord->fields[columnsIndex[i]]->getValueUniform() != (*it)->fields[columnsIndex[i]]->getValueUniform()) {
-                flagUnique = true;
-                break;
+std::vector<bool> Table::candidateBlocks(const std::vector<std::string>& whereConditions) const {
+    std::vector<bool> scannedBlocks(blockSummaries.size(), true);
+
+    // Only conjunctions of simple comparisons <field> <operator> <literal> can skip blocks
+    if (whereConditions.size() % 4 != 3) return scannedBlocks;
+    for (unsigned int i = 0; i < whereConditions.size(); i += 4) {
+        if (i > 0 && (OperatorType)getOperator(whereConditions[i - 1]) != OperatorType::AND) return scannedBlocks;
+        if (getFieldIndexByName(whereConditions[i]) < 0) return scannedBlocks;
+        if (OperatorTypePriorityList[getOperator(whereConditions[i + 1])] != 1) return scannedBlocks;
+    }
+
+    for (unsigned int i = 0; i < whereConditions.size(); i += 4) {
+        int columnIndex = getFieldIndexByName(whereConditions[i]);
+        OperatorType operatorCompare = (OperatorType)getOperator(whereConditions[i + 1]);
+        int key = 0;
+        bool isStringKey = (tableFields[columnIndex]->fieldType == FieldType::STRING);
+        if (isStringKey ? !isString(whereConditions[i + 2]) : !parseKey(columnIndex, whereConditions[i + 2], key)) continue;
+        for (unsigned int block = 0; block < blockSummaries.size(); ++block) {
+            const BlockSummary& summary = blockSummaries[block][columnIndex];
+            if (isStringKey ? !summary.maySatisfy(operatorCompare, whereConditions[i + 2]) : !summary.maySatisfy(operatorCompare, key)) {
+                scannedBlocks[block] = false;
             }
         }
-        if (!flagUnique) return false;
     }
+    return scannedBlocks;
+}
+
+void Table::rebuildBlockSummaries() {
+    blockSummaries.clear();
+    for (unsigned int rowId = 0; rowId < records.size(); ++rowId) {
+        if (rowId % BLOCK_ROWS == 0) blockSummaries.push_back(std::vector<BlockSummary>(tableFields.size()));
+        if (!recordValid[rowId]) continue;
+        for (unsigned int i = 0; i < tableFields.size(); ++i) blockSummaries.back()[i].add(records[rowId]->fields[i]);
+    }
+}
+
+bool Table::parseKey(int columnIndex, const std::string& value, int& key) const {
+    if (tableFields[columnIndex]->fieldType == FieldType::DATE) return parseDate(value, key);
+    if (tableFields[columnIndex]->fieldType == FieldType::INT && !value.empty() && value.size() < 10 && isNumber(value)) {
+        key = stoi(value);
+        return true;
+    }
+    return false;
+}
+
+bool Table::rangeCondition(const std::vector<std::string>& whereConditions, int& columnIndex, int& lowValue, int& highValue) const {
+    if (whereConditions.size() != 3 && !(whereConditions.size() == 7 && toUpperString(whereConditions[3]) == "AND")) return false;
+
+    long long low = INT_MIN, high = INT_MAX;
+    columnIndex = -1;
+    for (unsigned int i = 0; i < whereConditions.size(); i += 4) {  // Each comparison narrows the range
+        int currentColumn = getFieldIndexByName(whereConditions[i]);
+        if (currentColumn < 0 || (columnIndex >= 0 && currentColumn != columnIndex)) return false;
+        columnIndex = currentColumn;
+
+        int key = 0;
+        if (!parseKey(columnIndex, whereConditions[i + 2], key)) return false;
+        switch ((OperatorType)getOperator(whereConditions[i + 1])) {
+            case OperatorType::EQ:
+                low = std::max(low, (long long)key);
+                high = std::min(high, (long long)key);
+                break;
+            case OperatorType::GT:
+                low = std::max(low, (long long)key + 1);
+                break;
+            case OperatorType::GE:
+                low = std::max(low, (long long)key);
+                break;
+            case OperatorType::LT:
+                high = std::min(high, (long long)key - 1);
+                break;
+            case OperatorType::LE:
+                high = std::min(high, (long long)key);
+                break;
+            default:
+                return false;
+        }
+    }
+    if (low > high) {  // Empty range
+        low = 1;
+        high = 0;
+    }
+    lowValue = (int)low;
+    highValue = (int)high;
     return true;
 }
 
-std::list<Record*> Table::selectRecordsDistinct(std::list<Record*> selectedRecords, std::vector<std::string> distinctColumns) {
-    std::list<Record*> selected;
+std::vector<unsigned int> Table::selectRowIdsRange(int columnIndex, int lowValue, int highValue, int maxRecords) {
+    std::vector<unsigned int> rowIds;
+    if (lowValue > highValue) return rowIds;
+    size_t recordsLimit = (maxRecords >= 0) ? (size_t)maxRecords : SIZE_MAX;  // Number of records for the LIMIT
+
+    // Keys are checked block by block, so a LIMIT can stop the scan early
+    std::vector<unsigned int> chunkRowIds;
+    std::vector<int> keys;
+    std::vector<unsigned char> inRange(BLOCK_ROWS);
+    chunkRowIds.reserve(BLOCK_ROWS);
+    keys.reserve(BLOCK_ROWS);
+
+    // A single unsigned comparison checks both bounds, so the loop vectorizes
+    unsigned int rangeSpan = (unsigned int)highValue - (unsigned int)lowValue;
+    for (unsigned int block = 0; block < blockSummaries.size(); ++block) {
+        const BlockSummary& summary = blockSummaries[block][columnIndex];
+        if (!summary.maySatisfy(OperatorType::GE, lowValue) || !summary.maySatisfy(OperatorType::LE, highValue)) continue;
+
+        chunkRowIds.clear();
+        keys.clear();
+        unsigned int blockEnd = std::min((unsigned int)records.size(), (block + 1) * BLOCK_ROWS);
+        for (unsigned int rowId = block * BLOCK_ROWS; rowId < blockEnd; ++rowId) {
+            if (!recordValid[rowId]) continue;
+            chunkRowIds.push_back(rowId);
+            keys.push_back(records[rowId]->fields[columnIndex]->getValueInt());
+        }
+        for (unsigned int i = 0; i < keys.size(); ++i) {
+            inRange[i] = ((unsigned int)keys[i] - (unsigned int)lowValue) <= rangeSpan;
+        }
+        for (unsigned int i = 0; i < chunkRowIds.size(); ++i) {
+            if (!inRange[i]) continue;
+            rowIds.push_back(chunkRowIds[i]);
+            if (rowIds.size() == recordsLimit) return rowIds;  // Enough records for the LIMIT
+        }
+    }
+    return rowIds;
+}
+
+void Table::distinctRowIds(std::vector<unsigned int>& rowIds, const std::vector<std::string>& distinctColumns, int maxRecords) const {
     std::vector<int> columnsIndex;
     for (unsigned int i = 0; i < distinctColumns.size(); ++i) {
         int columnIndex = getFieldIndexByName(distinctColumns[i]);
         if (columnIndex >= 0) columnsIndex.push_back(columnIndex);
     }
 
-    for (std::list<Record*>::iterator it = selectedRecords.begin(); it != selectedRecords.end(); ++it) {
-        if (isDistinctSelection(*it, selected, columnsIndex)) {
-            selected.push_back(*it);
+    std::unordered_set<std::string> selectedKeys;  // Keys of the distinct records selected so far
+    size_t recordsLimit = (maxRecords >= 0) ? (size_t)maxRecords : SIZE_MAX;  // Number of records for the LIMIT
+    unsigned int keptRows = 0;
+    for (unsigned int i = 0; i < rowIds.size(); ++i) {
+        if (selectedKeys.insert(recordKey(records[rowIds[i]], columnsIndex)).second) {
+            rowIds[keptRows++] = rowIds[i];  // The kept row ids are compacted in place
+            if (keptRows == recordsLimit) break;  // Enough records for the LIMIT
         }
     }
-    return selected;
+    rowIds.resize(keptRows);
+}
+
+void Table::limitSelection(std::vector<unsigned int>& rowIds, int limitRecords, int offsetRecords) const {
+    if ((size_t)offsetRecords >= rowIds.size()) {
+        rowIds.clear();
+        return;
+    }
+    rowIds.erase(rowIds.begin(), rowIds.begin() + offsetRecords);
+    if (limitRecords >= 0 && (size_t)limitRecords < rowIds.size()) rowIds.resize(limitRecords);
+}
+
+std::vector<unsigned int> Table::selectRowIds(const std::vector<std::string>& distinctColumns,
+                                              const std::vector<std::string>& orderByColumns,
+                                              const std::vector<std::string>& whereParameters,
+                                              int limitRecords,
+                                              int offsetRecords,
+                                              QueryProfiler* profiler) {
+    int maxRecords = (limitRecords >= 0) ? limitRecords + offsetRecords : -1;  // Records needed to answer the LIMIT
+    if (profiler) profiler->startStage("Filter", getTableNumberOfRecords());
+    std::vector<unsigned int> rowIds = selectRowIdsWhere(whereParameters, (distinctColumns.empty() && orderByColumns.empty()) ? maxRecords : -1, profiler);
+    if (profiler) profiler->endStage(rowIds.size());
+
+    if (!distinctColumns.empty()) {
+        if (profiler) profiler->startStage("Distinct", rowIds.size());
+        distinctRowIds(rowIds, distinctColumns, maxRecords);
+        if (profiler) profiler->endStage(rowIds.size());
+    } else if (!orderByColumns.empty()) {
+        if (profiler) profiler->startStage(maxRecords >= 0 ? "Top-N sort" : "Sort", rowIds.size());
+        std::vector<int> columnsIndex = orderColumnsIndex(orderByColumns);
+        if (maxRecords >= 0) {
+            topRowIds(rowIds, columnsIndex, maxRecords);
+        } else {
+            sortRowIds(rowIds, columnsIndex);
+        }
+        if (profiler) profiler->endStage(rowIds.size());
+    }
+
+    if (profiler) profiler->startStage("Limit", rowIds.size());
+    limitSelection(rowIds, limitRecords, offsetRecords);
+    if (profiler) profiler->endStage(rowIds.size());
+    return rowIds;
 }
 
 std::list<Record*> Table::selectRecords(std::vector<std::string> distinctColumns,
                                         std::vector<std::string> orderByColumns,
-                                        std::vector<std::string> whereParameters) {
-    std::list<Record*> selectedRecordsWhere = selectRecordsWhere(whereParameters);
-    if (!distinctColumns.empty()) {
-        std::list<Record*> selectedRecordsDistinctWhere = selectRecordsDistinct(selectedRecordsWhere, distinctColumns);
-        return selectedRecordsDistinctWhere;
+                                        std::vector<std::string> whereParameters,
+                                        int limitRecords,
+                                        int offsetRecords,
+                                        QueryProfiler* profiler) {
+    std::vector<unsigned int> rowIds = selectRowIds(distinctColumns, orderByColumns, whereParameters, limitRecords, offsetRecords, profiler);
+    std::list<Record*> selectedRecords;
+    for (unsigned int i = 0; i < rowIds.size(); ++i) selectedRecords.push_back(records[rowIds[i]]);
+    return selectedRecords;
+}
+
+std::string Table::recordKey(Record* currentRecord, const std::vector<int>& columnsIndex) const {
+    std::string key;
+    for (unsigned int i = 0; i < columnsIndex.size(); ++i) {
+        DataField* field = currentRecord->fields[columnsIndex[i]];
+        if (field->getType() == FieldType::STRING) {
+            std::string value = field->getValueString();
+            unsigned int valueSize = value.size();
+            key.append((const char*)&valueSize, sizeof(valueSize));  // Length prefix keeps the keys unambiguous
+            key += value;
+        } else {
+            int value = field->getValueInt();
+            key.append((const char*)&value, sizeof(value));
+        }
     }
-    for (unsigned int i = 0; i < orderByColumns.size(); ++i) {
-        selectedRecordsWhere = sortRecordsWhere(selectedRecordsWhere, getFieldIndexByName(orderByColumns[i]));
+    return key;
+}
+
+bool Table::aggregateFromIndex(const std::vector<AggregateColumn>& aggregateColumns, std::vector<std::string>& resultRow) {
+    for (unsigned int i = 0; i < aggregateColumns.size(); ++i) {
+        if (aggregateColumns[i].aggregateType == AggregateType::COUNT && aggregateColumns[i].columnIndex < 0) {
+            resultRow.push_back(std::to_string(getTableNumberOfRecords()));
+            continue;
+        }
+        int columnIndex = aggregateColumns[i].columnIndex;
+        if (columnIndex < 0 || !tableFields[columnIndex]->fieldIsIndex) return false;
+
+        RecordIndex* index = indexedColumns[columnIndex]->indexedStructure;
+        Record* keyRecord = nullptr;
+        switch (aggregateColumns[i].aggregateType) {
+            case AggregateType::COUNT:
+                resultRow.push_back(std::to_string(index->countRecords()));
+                continue;
+            case AggregateType::MIN:
+                keyRecord = index->getMinRecord();  // The leftmost node
+                break;
+            case AggregateType::MAX:
+                keyRecord = index->getMaxRecord();  // The rightmost node
+                break;
+            default:
+                return false;
+        }
+        resultRow.push_back(keyRecord ? keyRecord->fields[columnIndex]->getValueUniform() : "");
+    }
+    return true;
+}
+
+std::vector<std::vector<std::string>> Table::aggregateRecords(std::vector<std::string> selectedColumns,
+                                                              std::vector<std::string> groupByColumns,
+                                                              std::vector<std::string> whereParameters) {
+    std::vector<int> groupColumnsIndex;
+    for (unsigned int i = 0; i < groupByColumns.size(); ++i) {
+        int columnIndex = getFieldIndexByName(groupByColumns[i]);
+        if (columnIndex < 0) throw std::invalid_argument("[!] Invalid aggregation! Unknown GROUPBY column!");
+        groupColumnsIndex.push_back(columnIndex);
+    }
+
+    std::vector<std::vector<std::string>> result(1);
+    std::vector<AggregateColumn> aggregateColumns;
+    for (unsigned int i = 0; i < selectedColumns.size(); ++i) {
+        AggregateType aggregateType = AggregateType::UNDEFINED;
+        std::string columnName;
+        if (parseAggregate(selectedColumns[i], aggregateType, columnName)) {
+            int columnIndex = (columnName == "*") ? -1 : getFieldIndexByName(columnName);
+            if (columnIndex < 0 && !(aggregateType == AggregateType::COUNT && columnName == "*")) {
+                throw std::invalid_argument("[!] Invalid aggregation! Unknown aggregated column!");
+            }
+            if ((aggregateType == AggregateType::SUM || aggregateType == AggregateType::AVG) &&
+                tableFields[columnIndex]->fieldType != FieldType::INT) {
+                throw std::invalid_argument("[!] Invalid aggregation! INT is required for SUM and AVG!");
+            }
+            aggregateColumns.push_back(AggregateColumn(aggregateType, columnIndex, -1));
+        } else {
+            int groupPosition = -1;
+            for (unsigned int j = 0; j < groupByColumns.size(); ++j) {
+                if (groupByColumns[j] == selectedColumns[i]) groupPosition = j;
+            }
+            if (groupPosition < 0) throw std::invalid_argument("[!] Invalid aggregation! The column should be in GROUPBY!");
+            aggregateColumns.push_back(AggregateColumn(AggregateType::UNDEFINED, groupColumnsIndex[groupPosition], groupPosition));
+        }
+        result[0].push_back(selectedColumns[i]);
+    }
+
+    std::vector<std::string> resultRow;
+    if (whereParameters.empty() && groupColumnsIndex.empty() && aggregateFromIndex(aggregateColumns, resultRow)) {
+        result.push_back(resultRow);
+        return result;
+    }
+
+    // Streaming hash aggregation, the groups keep the order of their first record
+    std::unordered_map<std::string, unsigned int> groupsByKey;
+    std::vector<Record*> groupRecords;
+    std::vector<std::vector<AggregateState>> groupStates;
+
+    std::list<Record*> sourceRecords = selectRecordsWhere(whereParameters);
+
+    for (std::list<Record*>::const_iterator it = sourceRecords.begin(); it != sourceRecords.end(); ++it) {
+        std::pair<std::unordered_map<std::string, unsigned int>::iterator, bool> group =
+            groupsByKey.insert(std::make_pair(recordKey(*it, groupColumnsIndex), (unsigned int)groupRecords.size()));
+        if (group.second) {  // New group
+            groupRecords.push_back(*it);
+            groupStates.push_back(std::vector<AggregateState>(aggregateColumns.size()));
+        }
+
+        std::vector<AggregateState>& states = groupStates[group.first->second];
+        for (unsigned int i = 0; i < aggregateColumns.size(); ++i) {
+            if (aggregateColumns[i].aggregateType == AggregateType::UNDEFINED) continue;
+            states[i].add(aggregateColumns[i].columnIndex >= 0 ? (*it)->fields[aggregateColumns[i].columnIndex] : nullptr);
+        }
+    }
+
+    if (groupRecords.empty() && groupColumnsIndex.empty()) {  // Aggregates over no records still give a single row
+        groupRecords.push_back(nullptr);
+        groupStates.push_back(std::vector<AggregateState>(aggregateColumns.size()));
+    }
+
+    for (unsigned int group = 0; group < groupRecords.size(); ++group) {
+        resultRow.clear();
+        for (unsigned int i = 0; i < aggregateColumns.size(); ++i) {
+            if (aggregateColumns[i].aggregateType == AggregateType::UNDEFINED) {
+                resultRow.push_back(groupRecords[group]->fields[aggregateColumns[i].columnIndex]->getValueUniform());
+            } else {
+                resultRow.push_back(groupStates[group][i].result(aggregateColumns[i].aggregateType));
+            }
+        }
+        result.push_back(resultRow);
+    }
+    return result;
+}
+
+Table* Table::joinTables(Table* otherTable, int columnIndex, int otherColumnIndex) {
+    if (tableFields[columnIndex]->fieldType != otherTable->tableFields[otherColumnIndex]->fieldType) {
+        throw std::invalid_argument("[!] Invalid join! The joined fields should have the same type!");
+    }
+
+    Table* joinedTable = new Table(tableName + "." + otherTable->tableName);
+    for (unsigned int i = 0; i < tableFields.size(); ++i) {
+        joinedTable->addField(tableName + "." + tableFields[i]->fieldName, tableFields[i]->fieldType);
+    }
+    for (unsigned int i = 0; i < otherTable->tableFields.size(); ++i) {
+        joinedTable->addField(otherTable->tableName + "." + otherTable->tableFields[i]->fieldName, otherTable->tableFields[i]->fieldType);
+    }
+
+    // Index nested loop join, the outer records look up the indexed column of the other table
+    bool otherIsIndexed = otherTable->tableFields[otherColumnIndex]->fieldIsIndex;
+    bool thisIsIndexed = tableFields[columnIndex]->fieldIsIndex;
+    if (otherIsIndexed || thisIsIndexed) {
+        bool outerIsThis = otherIsIndexed && (!thisIsIndexed || getTableNumberOfRecords() <= otherTable->getTableNumberOfRecords());
+        Table* outerTable = outerIsThis ? this : otherTable;
+        Table* innerTable = outerIsThis ? otherTable : this;
+        int outerColumn = outerIsThis ? columnIndex : otherColumnIndex;
+        int innerColumn = outerIsThis ? otherColumnIndex : columnIndex;
+
+        // Compare the estimated costs, both joins produce the same matches
+        double outerRows = outerTable->columnStatistics[outerColumn].getRowCount();
+        double innerRows = innerTable->columnStatistics[innerColumn].getRowCount();
+        double innerMatches = innerRows / std::max(1, innerTable->columnStatistics[innerColumn].getDistinctCount());
+        double indexJoinCost = outerRows * (std::log2(innerRows + 2) + innerMatches);
+        double hashJoinCost = HASH_JOIN_COST * (outerRows + innerRows) + outerRows * innerMatches;
+
+        if (indexJoinCost <= hashJoinCost) {
+            RecordIndex* innerIndex = innerTable->indexedColumns[innerColumn]->indexedStructure;
+            for (std::vector<Record*>::iterator it = outerTable->records.begin(); it != outerTable->records.end(); ++it) {
+                if (!outerTable->recordValid[(*it)->rowId]) continue;
+                std::list<Record*> matches = innerIndex->searchNode((*it)->fields[outerColumn]->getValueUniform(), OperatorType::EQ);
+                for (std::list<Record*>::iterator match = matches.begin(); match != matches.end(); ++match) {
+                    if (outerIsThis) {
+                        joinedTable->addJoinedRecord(*it, *match);
+                    } else {
+                        joinedTable->addJoinedRecord(*match, *it);
+                    }
+                }
+            }
+            return joinedTable;
+        }
+    }
+
+    // Hash join, building on the smaller table and probing with the larger one
+    std::list<Record*> allRecords = selectRecordsWhere(std::vector<std::string>());
+    std::list<Record*> otherAllRecords = otherTable->selectRecordsWhere(std::vector<std::string>());
+    if (allRecords.size() <= otherAllRecords.size()) {
+        hashJoin(allRecords, columnIndex, otherAllRecords, otherColumnIndex, true, joinedTable);
+    } else {
+        hashJoin(otherAllRecords, otherColumnIndex, allRecords, columnIndex, false, joinedTable);
+    }
+    return joinedTable;
+}
+
+void Table::hashJoin(const std::list<Record*>& buildRecords, int buildColumn,
+                     const std::list<Record*>& probeRecords, int probeColumn,
+                     bool buildIsLeft, Table* joinedTable) const {
+    // Radix partitioning keeps each partition hash table small enough for the cache
+    unsigned int partitionBits = 0;
+    while ((buildRecords.size() >> partitionBits) > JOIN_PARTITION_ROWS && partitionBits < 12) ++partitionBits;
+    unsigned int partitionsCount = 1u << partitionBits;
+    unsigned int partitionShift = sizeof(size_t) * 8 - partitionBits;
+
+    std::hash<std::string> keyHash;
+    std::vector<int> buildColumns(1, buildColumn), probeColumns(1, probeColumn);
+    std::vector<std::vector<std::pair<std::string, Record*>>> buildPartitions(partitionsCount), probePartitions(partitionsCount);
+    for (std::list<Record*>::const_iterator it = buildRecords.begin(); it != buildRecords.end(); ++it) {
+        std::string key = recordKey(*it, buildColumns);
+        unsigned int partition = partitionBits ? (unsigned int)(keyHash(key) >> partitionShift) : 0;
+        buildPartitions[partition].push_back(std::make_pair(key, *it));
+    }
+    for (std::list<Record*>::const_iterator it = probeRecords.begin(); it != probeRecords.end(); ++it) {
+        std::string key = recordKey(*it, probeColumns);
+        unsigned int partition = partitionBits ? (unsigned int)(keyHash(key) >> partitionShift) : 0;
+        probePartitions[partition].push_back(std::make_pair(key, *it));
+    }
+
+    for (unsigned int partition = 0; partition < partitionsCount; ++partition) {
+        std::unordered_map<std::string, std::vector<Record*>> buildTable;
+        buildTable.reserve(buildPartitions[partition].size());
+        for (unsigned int i = 0; i < buildPartitions[partition].size(); ++i) {
+            buildTable[buildPartitions[partition][i].first].push_back(buildPartitions[partition][i].second);
+        }
+
+        for (unsigned int i = 0; i < probePartitions[partition].size(); ++i) {
+            std::unordered_map<std::string, std::vector<Record*>>::iterator match = buildTable.find(probePartitions[partition][i].first);
+            if (match == buildTable.end()) continue;
+            Record* probeRecord = probePartitions[partition][i].second;
+            for (unsigned int j = 0; j < match->second.size(); ++j) {
+                if (buildIsLeft) {
+                    joinedTable->addJoinedRecord(match->second[j], probeRecord);
+                } else {
+                    joinedTable->addJoinedRecord(probeRecord, match->second[j]);
+                }
+            }
+        }
+    }
+}
+
+void Table::addJoinedRecord(Record* leftRecord, Record* rightRecord) {
+    Record* newRecord = new Record;
+    newRecord->fields.reserve(leftRecord->fields.size() + rightRecord->fields.size());
+    for (unsigned int i = 0; i < leftRecord->fields.size(); ++i) newRecord->fields.push_back(leftRecord->fields[i]->clone());
+    for (unsigned int i = 0; i < rightRecord->fields.size(); ++i) newRecord->fields.push_back(rightRecord->fields[i]->clone());
+    appendRecord(newRecord);
+}
+
+void Table::removeRecord(Record* removedRecord) {
+    for (unsigned int i = 0; i < observers.size(); ++i) observers[i]->recordRemoved(this, removedRecord);
+    for (unsigned int i = 0; i < tableFields.size(); ++i) {
+        if (tableFields[i]->fieldIsIndex) {
+            indexedColumns[i]->indexedStructure->removeData(removedRecord);
+        }
     }
-    return selectedRecordsWhere;
+    for (unsigned int i = 0; i < tableFields.size(); ++i) columnStatistics[i].remove(removedRecord->fields[i]);
+    recordValid[removedRecord->rowId] = false;  // Tombstone, the record is freed by VACUUM
+    ++removedRecords;
 }
 
 void Table::removeRecords(std::vector<std::string> whereParameters) {
     std::list<Record*> selectedRecordsWhere = selectRecordsWhere(whereParameters);
     for (std::list<Record*>::iterator it = selectedRecordsWhere.begin(); it != selectedRecordsWhere.end(); ++it) {
-        for (unsigned int i = 0; i < tableFields.size(); ++i) {
-            if (tableFields[i]->fieldIsIndex) {
-                indexedColumns[i]->indexedStructure->removeData(*it);
+        removeRecord(*it);
+        if (flagLogging) {
+            undoLog.push_back(UndoEntry());
+            undoLog.back().undoType = UndoType::REMOVED;
+            undoLog.back().rowId = (*it)->rowId;
+        }
+    }
+    if (!selectedRecordsWhere.empty()) changeVersion();
+
+    // Mostly tombstones, compact now, the row ids of a transaction are kept until it is committed
+    if (!flagLogging && removedRecords > 0 && removedRecords * 2 > records.size()) vacuumTable();
+}
+
+int Table::updateRecords(std::vector<std::string> setColumns, std::vector<std::string> setValues, std::vector<std::string> whereParameters) {
+    std::vector<int> columnsIndex;
+    std::vector<DataField*> newValues;  // Typed values, parsed once for all records
+    try {
+        for (unsigned int i = 0; i < setColumns.size(); ++i) {
+            int columnIndex = getFieldIndexByName(setColumns[i]);
+            if (columnIndex < 0) throw std::invalid_argument("[!] Invalid update! Unable to find the updated field!");
+            columnsIndex.push_back(columnIndex);
+            newValues.push_back(createField(columnIndex, setValues[i]));
+        }
+    } catch (...) {
+        for (unsigned int i = 0; i < newValues.size(); ++i) delete newValues[i];
+        throw;
+    }
+
+    int updatedRecords = 0;
+    std::list<Record*> selectedRecordsWhere = selectRecordsWhere(whereParameters);
+    for (std::list<Record*>::iterator it = selectedRecordsWhere.begin(); it != selectedRecordsWhere.end(); ++it) {
+        bool flagUpdated = false;
+        for (unsigned int i = 0; i < columnsIndex.size(); ++i) {
+            DataField* field = (*it)->fields[columnsIndex[i]];
+            if (equalFields(field, newValues[i])) continue;  // The key is not changed, the indexes stay
+            if (!flagUpdated) {  // The observers remove the old values before the first change
+                for (unsigned int j = 0; j < observers.size(); ++j) observers[j]->recordRemoved(this, *it);
+                if (flagLogging) {
+                    undoLog.push_back(UndoEntry());
+                    undoLog.back().undoType = UndoType::UPDATED;
+                    undoLog.back().rowId = (*it)->rowId;
+                }
             }
+            if (flagLogging) undoLog.back().oldValues.push_back(std::make_pair(columnsIndex[i], field->clone()));  // Only the changed fields are copied
+
+            bool fieldIsIndex = tableFields[columnsIndex[i]]->fieldIsIndex;
+            if (fieldIsIndex) indexedColumns[columnsIndex[i]]->indexedStructure->removeData(*it);
+            columnStatistics[columnsIndex[i]].remove(field);
+            if (field->getType() == FieldType::STRING) {
+                field->setValueString(newValues[i]->getValueString());
+            } else {
+                field->setValueInt(newValues[i]->getValueInt());
+            }
+            columnStatistics[columnsIndex[i]].add(field);
+            blockSummaries[(*it)->rowId / BLOCK_ROWS][columnsIndex[i]].add(field);
+            if (fieldIsIndex) indexedColumns[columnsIndex[i]]->indexedStructure->insert(*it);
+            flagUpdated = true;
+        }
+        if (flagUpdated) {
+            ++updatedRecords;
+            for (unsigned int j = 0; j < observers.size(); ++j) observers[j]->recordAdded(this, *it);
+        }
+    }
+
+    for (unsigned int i = 0; i < newValues.size(); ++i) delete newValues[i];
+    if (updatedRecords > 0) changeVersion();
+    return updatedRecords;
+}
+
+void Table::vacuumTable() {
+    if (flagLogging) throw std::invalid_argument("[!] The table cannot be vacuumed during a transaction!");
+    unsigned int validRecords = 0;
+    for (unsigned int rowId = 0; rowId < records.size(); ++rowId) {
+        if (recordValid[rowId]) {
+            records[validRecords] = records[rowId];
+            records[validRecords]->rowId = validRecords;
+            ++validRecords;
+        } else {
+            delete records[rowId];
+        }
+    }
+    records.resize(validRecords);
+    records.shrink_to_fit();
+    recordValid.assign(validRecords, true);
+    removedRecords = 0;
+    rebuildBlockSummaries();
+    changeVersion();
+
+    for (unsigned int i = 0; i < tableFields.size(); ++i) {  // Rebuild the indexes over the compacted storage
+        if (!tableFields[i]->fieldIsIndex) continue;
+        delete indexedColumns[i]->indexedStructure;
+        indexedColumns[i]->indexedStructure = createRecordIndex(i, tableFields[i]->fieldType, tableFields[i]->fieldIndexType);
+        for (unsigned int rowId = 0; rowId < records.size(); ++rowId) {
+            indexedColumns[i]->indexedStructure->insert(records[rowId]);
+        }
+    }
+    for (unsigned int i = 0; i < observers.size(); ++i) observers[i]->recordsRenumbered(this);
+}
+
+void Table::beginLogging() {
+    flagLogging = true;
+}
+
+bool Table::getLogging() const {
+    return flagLogging;
+}
+
+void Table::clearUndoLog() {
+    for (unsigned int entry = 0; entry < undoLog.size(); ++entry) {
+        for (unsigned int i = 0; i < undoLog[entry].oldValues.size(); ++i) delete undoLog[entry].oldValues[i].second;
+    }
+    undoLog.clear();
+}
+
+void Table::commitLog() {
+    clearUndoLog();  // The changes are already in place, nothing is copied
+    flagLogging = false;
+    if (removedRecords > 0 && removedRecords * 2 > records.size()) vacuumTable();  // The compaction skipped during the transaction
+}
+
+void Table::rollbackLog() {
+    flagLogging = false;
+    for (int entry = (int)undoLog.size() - 1; entry >= 0; --entry) undoChange(undoLog[entry]);
+    clearUndoLog();
+    changeVersion();
+}
+
+void Table::undoChange(UndoEntry& undoEntry) {
+    switch (undoEntry.undoType) {
+        case UndoType::INSERTED:
+            for (unsigned int rowId = undoEntry.rowId + undoEntry.rowCount; rowId-- > undoEntry.rowId;) {
+                if (recordValid[rowId]) {
+                    removeRecord(records[rowId]);
+                }
+                if (rowId + 1 != records.size()) continue;  // Only the last records leave the storage, others stay as tombstones
+                delete records.back();
+                records.pop_back();
+                recordValid.pop_back();
+                --removedRecords;
+                if (records.size() % BLOCK_ROWS == 0) blockSummaries.pop_back();  // The block of the record is empty
+            }
+            break;
+        case UndoType::REMOVED: {
+            Record* restoredRecord = records[undoEntry.rowId];
+            recordValid[undoEntry.rowId] = true;  // The block summaries kept the values of the tombstone
+            --removedRecords;
+            for (unsigned int i = 0; i < tableFields.size(); ++i) {
+                columnStatistics[i].add(restoredRecord->fields[i]);
+                if (tableFields[i]->fieldIsIndex) indexedColumns[i]->indexedStructure->insert(restoredRecord);
+            }
+            for (unsigned int i = 0; i < observers.size(); ++i) observers[i]->recordAdded(this, restoredRecord);
+            break;
+        }
+        case UndoType::UPDATED: {
+            Record* restoredRecord = records[undoEntry.rowId];
+            for (unsigned int i = 0; i < observers.size(); ++i) observers[i]->recordRemoved(this, restoredRecord);
+            for (int i = (int)undoEntry.oldValues.size() - 1; i >= 0; --i) {  // A field changed twice gets its first value last
+                int columnIndex = undoEntry.oldValues[i].first;
+                DataField* field = restoredRecord->fields[columnIndex];
+                bool fieldIsIndex = tableFields[columnIndex]->fieldIsIndex;
+                if (fieldIsIndex) indexedColumns[columnIndex]->indexedStructure->removeData(restoredRecord);
+                columnStatistics[columnIndex].remove(field);
+                if (field->getType() == FieldType::STRING) {
+                    field->setValueString(undoEntry.oldValues[i].second->getValueString());
+                } else {
+                    field->setValueInt(undoEntry.oldValues[i].second->getValueInt());
+                }
+                columnStatistics[columnIndex].add(field);
+                blockSummaries[undoEntry.rowId / BLOCK_ROWS][columnIndex].add(field);
+                if (fieldIsIndex) indexedColumns[columnIndex]->indexedStructure->insert(restoredRecord);
+            }
+            for (unsigned int i = 0; i < observers.size(); ++i) observers[i]->recordAdded(this, restoredRecord);
+            break;
         }
-        records.remove(*it);
     }
 }
 
 bool Table::compareRecords(Record* record1, Record* record2, int columnIndex) {  // True if the second is bigger
-    if (tableFields[columnIndex]->fieldType == FieldType::INT) {
+    if (tableFields[columnIndex]->fieldType == FieldType::INT || tableFields[columnIndex]->fieldType == FieldType::DATE) {
         return (record1->fields[columnIndex]->getValueInt() < record2->fields[columnIndex]->getValueInt());
     }
+    return (record1->fields[columnIndex]->getValueUniform().compare(record2->fields[columnIndex]->getValueUniform()) < 0);
+}
+
+std::vector<int> Table::orderColumnsIndex(const std::vector<std::string>& orderByColumns) const {
+    std::vector<int> columnsIndex;
+    for (unsigned int i = 0; i < orderByColumns.size(); ++i) {
+        int columnIndex = getFieldIndexByName(orderByColumns[i]);
+        if (columnIndex >= 0) columnsIndex.push_back(columnIndex);
+    }
+    return columnsIndex;
+}
+
+void Table::sortRowIds(std::vector<unsigned int>& rowIds, const std::vector<int>& columnsIndex) {
+    if (columnsIndex.empty()) return;
+    if (columnsIndex.size() > 1) {  // The last column is the primary one, as after consecutive sorts
+        std::stable_sort(rowIds.begin(), rowIds.end(), [this, &columnsIndex](unsigned int rowId1, unsigned int rowId2) {
+            return compareRecordsOrder(records[rowId1], records[rowId2], columnsIndex);
+        });
+        return;
+    }
+
+    // The keys are copied next to their row ids, so the comparisons do not visit the records
+    auto sortByKeys = [&rowIds](auto& keys) {
+        std::stable_sort(keys.begin(), keys.end(), [](const auto& key1, const auto& key2) { return key1.first < key2.first; });
+        for (unsigned int i = 0; i < keys.size(); ++i) rowIds[i] = keys[i].second;
+    };
+    int columnIndex = columnsIndex[0];
     if (tableFields[columnIndex]->fieldType == FieldType::STRING) {
-        return (record1->fields[columnIndex]->getValueUniform().compare(record2->fields[columnIndex]->getValueUniform()) > 1);
+        std::vector<std::pair<std::string, unsigned int>> keys;
+        keys.reserve(rowIds.size());
+        for (unsigned int i = 0; i < rowIds.size(); ++i) keys.push_back(std::make_pair(records[rowIds[i]]->fields[columnIndex]->getValueUniform(), rowIds[i]));
+        sortByKeys(keys);
+    } else {
+        std::vector<std::pair<int, unsigned int>> keys;
+        keys.reserve(rowIds.size());
+        for (unsigned int i = 0; i < rowIds.size(); ++i) keys.push_back(std::make_pair(records[rowIds[i]]->fields[columnIndex]->getValueInt(), rowIds[i]));
+        sortByKeys(keys);
     }
 }
 
-std::list<Record*> Table::sortRecordsWhere(std::list<Record*>& selectedRecords, int columnIndex) {
-    std::list<Record*> selected;
-    Record* minElement = selectedRecords.front();
-    while (!selectedRecords.empty()) {
-        minElement = selectedRecords.front();
-        for (std::list<Record*>::iterator it = selectedRecords.begin(); it != selectedRecords.end(); ++it) {
-            if (compareRecords((*it), minElement, columnIndex)) minElement = (*it);
+bool Table::compareRecordsOrder(Record* record1, Record* record2, const std::vector<int>& columnsIndex) {
+    for (int i = (int)columnsIndex.size() - 1; i >= 0; --i) {
+        if (compareRecords(record1, record2, columnsIndex[i])) return true;
+        if (compareRecords(record2, record1, columnsIndex[i])) return false;
+    }
+    return false;
+}
+
+void Table::topRowIds(std::vector<unsigned int>& rowIds, const std::vector<int>& columnsIndex, int countRecords) {
+    // Max-heap of the best records so far, equal records keep their selection order
+    std::vector<std::pair<unsigned int, unsigned int>> heap;
+    heap.reserve(countRecords + 1);
+    struct HeapOrder {
+        Table* table;
+        const std::vector<int>* columnsIndex;
+        bool operator()(const std::pair<unsigned int, unsigned int>& value1, const std::pair<unsigned int, unsigned int>& value2) const {
+            if (table->compareRecordsOrder(table->records[value1.first], table->records[value2.first], *columnsIndex)) return true;
+            if (table->compareRecordsOrder(table->records[value2.first], table->records[value1.first], *columnsIndex)) return false;
+            return value1.second < value2.second;
         }
-        selected.push_back(minElement);
-        selectedRecords.remove(minElement);
+    } heapOrder = {this, &columnsIndex};
+
+    for (unsigned int position = 0; position < rowIds.size(); ++position) {
+        if (countRecords == 0) break;
+        std::pair<unsigned int, unsigned int> candidate(rowIds[position], position);
+        if (heap.size() == (size_t)countRecords) {
+            if (!heapOrder(candidate, heap.front())) continue;  // Not better than the worst kept record
+            std::pop_heap(heap.begin(), heap.end(), heapOrder);
+            heap.pop_back();
+        }
+        heap.push_back(candidate);
+        std::push_heap(heap.begin(), heap.end(), heapOrder);
     }
-    return selected;
+
+    std::sort_heap(heap.begin(), heap.end(), heapOrder);
+    rowIds.resize(heap.size());
+    for (unsigned int i = 0; i < heap.size(); ++i) rowIds[i] = heap[i].first;
 }
\ No newline at end of file
@@ -1,8 +1,12 @@
 #define CATCH_CONFIG_MAIN
 #include "../catch2/catch.hpp"
 #include "../Headers/command.hpp"
+#include "../Headers/compression.hpp"
 #include "../Headers/database.hpp"
 #include "../Headers/field.hpp"
+#include "../Headers/profiler.hpp"
+#include "../Headers/querycache.hpp"
+#include "../Headers/snapshot.hpp"
 #include "../Headers/table.hpp"
 #include "../Headers/utilityhelper.hpp"
 
@@ -64,6 +68,38 @@ TEST_CASE("Utility testing") {
         REQUIRE(isDate("31/04/2022") == false);
     }
 
+    SECTION("Date day numbers") {
+        int dayNumber1 = 0, dayNumber2 = 0;
+        REQUIRE(parseDate("01/01/1970", dayNumber1));
+        REQUIRE(dayNumber1 == 0);
+        REQUIRE(parseDate("31/12/2021", dayNumber1));
+        REQUIRE(parseDate("01/01/2022", dayNumber2));
+        REQUIRE(dayNumber2 - dayNumber1 == 1);
+        REQUIRE(parseDate("29/02/2000", dayNumber1));
+        REQUIRE(formatDate(dayNumber1) == "29/02/2000");
+        REQUIRE(formatDate(dayNumber2) == "01/01/2022");
+
+        REQUIRE(parseDate("29/02/1900", dayNumber1) == false);
+        REQUIRE(parseDate("00/01/2022", dayNumber1) == false);
+    }
+
+    SECTION("Column statistics") {
+        ColumnStatistics statistics(FieldType::INT);
+        std::vector<DataField*> values;
+        for (int i = 0; i < 1000; ++i) values.push_back(new DataFieldInt(i % 100));
+        statistics.analyze(values);
+        REQUIRE(statistics.getRowCount() == 1000);
+        REQUIRE(statistics.getDistinctCount() >= 90);
+        REQUIRE(statistics.getDistinctCount() <= 110);
+        REQUIRE(statistics.selectivity(OperatorType::LT, 50) > 0.4);
+        REQUIRE(statistics.selectivity(OperatorType::LT, 50) < 0.6);
+        REQUIRE(statistics.selectivity(OperatorType::GT, 200) == 0.0);
+        REQUIRE(statistics.selectivity(OperatorType::EQ, 10) < 0.02);
+        statistics.remove(values[0]);
+        REQUIRE(statistics.getRowCount() == 999);
+        for (unsigned int i = 0; i < values.size(); ++i) delete values[i];
+    }
+
     SECTION("Bool string verification") {
         REQUIRE(isTrueOrFalse("#TRUE"));
         REQUIRE(isTrueOrFalse("#FALSE"));
@@ -105,6 +141,68 @@ TEST_CASE("Utility testing") {
         REQUIRE(toUpperString("iNt StRiNg DaTe") == "INT STRING DATE");
         REQUIRE(toUpperString("123") == "123");
     }
+
+    SECTION("Binary values") {
+        std::string buffer;
+        writeBinary(buffer, 4000000000u, 4);
+        writeBinaryText(buffer, "\"Name\"");
+        REQUIRE(buffer.size() == 14);
+
+        const char* position = buffer.data();
+        unsigned long long value = 0;
+        std::string text;
+        REQUIRE(readBinary(position, buffer.data() + buffer.size(), value, 4));
+        REQUIRE(value == 4000000000u);
+        REQUIRE(readBinaryText(position, buffer.data() + buffer.size(), text));
+        REQUIRE(text == "\"Name\"");
+        REQUIRE(readBinary(position, buffer.data() + buffer.size(), value, 1) == false);
+    }
+
+    SECTION("LIKE patterns") {
+        REQUIRE(matchLike("\"Name1\"", "\"Name%\""));
+        REQUIRE(matchLike("\"Name\"", "\"Name%\""));
+        REQUIRE(matchLike("\"Name1\"", "\"N_me_\""));
+        REQUIRE(matchLike("\"abcabd\"", "\"%ab_\""));
+        REQUIRE(likePrefix("\"Name%\"") == "\"Name");
+
+        REQUIRE(matchLike("\"Name1\"", "\"Name\"") == false);
+        REQUIRE(matchLike("\"Nam\"", "\"Name%\"") == false);
+        REQUIRE(matchLike("\"abcabd\"", "\"%abc\"") == false);
+    }
+
+    SECTION("Compressed blocks") {
+        std::vector<std::vector<int>> blocks(5);
+        for (int i = 0; i < 1024; ++i) {
+            blocks[0].push_back(i / 100);                    // Runs
+            blocks[1].push_back(738000 + (i * 7) % 365);     // Dates of one year
+            blocks[2].push_back(1000000 + 3 * i + i % 2);    // Sorted keys
+            blocks[3].push_back((int)(i * 2654435761u));     // Random values
+            blocks[4].push_back(i % 2 ? INT_MIN : INT_MAX);  // Extreme values
+        }
+        CompressionType expectedTypes[] = {CompressionType::RLE, CompressionType::FOR, CompressionType::DELTA, CompressionType::RAW, CompressionType::RAW};
+
+        for (unsigned int block = 0; block < blocks.size(); ++block) {
+            CompressedBlock encodedValues;
+            encodedValues.encode(blocks[block]);
+            REQUIRE(encodedValues.getCompressionType() == expectedTypes[block]);
+            std::vector<int> values;
+            encodedValues.decode(values);
+            REQUIRE(values == blocks[block]);
+
+            std::string buffer;  // The binary form gives the same values
+            encodedValues.writeBlock(buffer);
+            const char* position = buffer.data();
+            CompressedBlock readValues;
+            REQUIRE(readValues.readBlock(position, buffer.data() + buffer.size()));
+            REQUIRE(position == buffer.data() + buffer.size());
+            REQUIRE(readValues.encodedBytes() == encodedValues.encodedBytes());
+            readValues.decode(values);
+            REQUIRE(values == blocks[block]);
+            CompressedBlock damagedValues;
+            position = buffer.data();
+            REQUIRE(damagedValues.readBlock(position, buffer.data() + buffer.size() - 1) == false);
+        }
+    }
 }
 
 TEST_CASE("Table tests") {
@@ -218,6 +316,108 @@ TEST_CASE("Table tests") {
         REQUIRE(selection.size() == 2);
     }
 
+    SECTION("SELECT * FROM MyTable WHERE Date > 01/01/2022 AND Date <= 02/01/2022") {
+        whereParameters.push_back("Date");
+        whereParameters.push_back(">");
+        whereParameters.push_back("01/01/2022");
+        whereParameters.push_back("AND");
+        whereParameters.push_back("Date");
+        whereParameters.push_back("<=");
+        whereParameters.push_back("02/01/2022");
+        std::list<Record*> selection = myTable.selectRecords(distinctColumns, orderByColumns, whereParameters);
+        REQUIRE(selection.size() == 2);
+        REQUIRE(selection.front()->getData(0)->getValueUniform() == "400");
+        REQUIRE(selection.back()->getData(0)->getValueUniform() == "200");
+    }
+
+    SECTION("SELECT ORDERBY Date FROM MyTable") {
+        orderByColumns.push_back("Date");
+        std::list<Record*> selection = myTable.selectRecords(distinctColumns, orderByColumns, whereParameters);
+        REQUIRE(selection.size() == 5);
+        REQUIRE(selection.front()->getData(2)->getValueUniform() == "01/01/2022");
+        REQUIRE(selection.back()->getData(2)->getValueUniform() == "03/01/2022");
+    }
+
+    SECTION("Index test -> SELECT * FROM MyTable WHERE ID = 300") {
+        whereParameters.push_back("ID");
+        whereParameters.push_back("=");
+        whereParameters.push_back("300");
+        std::list<Record*> selection = myTable.selectRecords(distinctColumns, orderByColumns, whereParameters);
+        REQUIRE(selection.size() == 1);
+        REQUIRE(selection.front()->getData(1)->getValueUniform() == "\"Name4\"");
+    }
+
+    SECTION("SELECT * FROM MyTable WHERE ID > 100 LIMIT 2 OFFSET 1") {
+        whereParameters.push_back("ID");
+        whereParameters.push_back(">");
+        whereParameters.push_back("100");
+        std::list<Record*> selection = myTable.selectRecords(distinctColumns, orderByColumns, whereParameters, 2, 1);
+        REQUIRE(selection.size() == 2);
+        REQUIRE(myTable.selectRecords(distinctColumns, orderByColumns, whereParameters, 10, 3).size() == 1);
+    }
+
+    SECTION("SELECT * FROM MyTable ORDERBY ID LIMIT 2 OFFSET 1") {
+        orderByColumns.push_back("ID");
+        std::list<Record*> selection = myTable.selectRecords(distinctColumns, orderByColumns, whereParameters, 2, 1);
+        REQUIRE(selection.size() == 2);
+        REQUIRE(selection.front()->getData(0)->getValueUniform() == "200");
+        REQUIRE(selection.back()->getData(0)->getValueUniform() == "300");
+    }
+
+    SECTION("SELECT COUNT(*), SUM(ID), MIN(ID), MAX(Date), AVG(ID) FROM MyTable") {
+        std::vector<std::string> selectedColumns = {"COUNT(*)", "SUM(ID)", "MIN(ID)", "MAX(Date)", "AVG(ID)"};
+        std::vector<std::string> groupByColumns;
+        std::vector<std::vector<std::string>> aggregation = myTable.aggregateRecords(selectedColumns, groupByColumns, whereParameters);
+        REQUIRE(aggregation.size() == 2);
+        REQUIRE(aggregation[0][1] == "SUM(ID)");
+        REQUIRE(aggregation[1][0] == "5");
+        REQUIRE(aggregation[1][1] == "1500");
+        REQUIRE(aggregation[1][2] == "100");
+        REQUIRE(aggregation[1][3] == "03/01/2022");
+        REQUIRE(aggregation[1][4] == "300");
+    }
+
+    SECTION("SELECT Date, COUNT(*), MAX(ID) FROM MyTable WHERE ID > 100 GROUPBY Date") {
+        std::vector<std::string> selectedColumns = {"Date", "COUNT(*)", "MAX(ID)"};
+        std::vector<std::string> groupByColumns = {"Date"};
+        whereParameters.push_back("ID");
+        whereParameters.push_back(">");
+        whereParameters.push_back("100");
+        std::vector<std::vector<std::string>> aggregation = myTable.aggregateRecords(selectedColumns, groupByColumns, whereParameters);
+        REQUIRE(aggregation.size() == 3);
+        REQUIRE(aggregation[1][0] == "02/01/2022");
+        REQUIRE(aggregation[1][1] == "2");
+        REQUIRE(aggregation[1][2] == "400");
+        REQUIRE(aggregation[2][0] == "03/01/2022");
+        REQUIRE(aggregation[2][1] == "2");
+        REQUIRE(aggregation[2][2] == "500");
+    }
+
+    SECTION("SELECT * FROM MyTable JOIN Events ON MyTable.Date = Events.Day") {
+        Table events("Events");
+        events.addField("Day", FieldType::DATE, false, false, "");
+        events.addField("Owner", FieldType::INT, false, false, "");
+        events.addRecord({"02/01/2022", "100"});
+        events.addRecord({"03/01/2022", "400"});
+        events.addRecord({"03/01/2022", "999"});
+
+        Table* joined = myTable.joinTables(&events, 2, 0);
+        REQUIRE(joined->getTableColumnsSize() == 5);
+        REQUIRE(joined->fieldName(3) == "Events.Day");
+        REQUIRE(joined->getTableNumberOfRecords() == 6);
+        delete joined;
+
+        joined = events.joinTables(&myTable, 1, 0);  // Index nested loop over the indexed ID
+        REQUIRE(joined->getTableNumberOfRecords() == 2);
+        whereParameters.push_back("MyTable.Name");
+        whereParameters.push_back("=");
+        whereParameters.push_back("\"Name1\"");
+        std::list<Record*> selection = joined->selectRecords(distinctColumns, orderByColumns, whereParameters);
+        REQUIRE(selection.size() == 1);
+        REQUIRE(selection.front()->getData(0)->getValueUniform() == "03/01/2022");
+        delete joined;
+    }
+
     SECTION("REMOVE FROM MyTable WHERE Date = 02/01/2022") {
         whereParameters.push_back("Date");
         whereParameters.push_back("=");
@@ -225,4 +425,625 @@ TEST_CASE("Table tests") {
         myTable.removeRecords(whereParameters);
         REQUIRE(myTable.getTableNumberOfRecords() == 3);
     }
+
+    SECTION("UPDATE MyTable SET ID = 600, Name = \"Updated\" WHERE Date = 03/01/2022") {
+        whereParameters.push_back("Date");
+        whereParameters.push_back("=");
+        whereParameters.push_back("03/01/2022");
+        REQUIRE(myTable.updateRecords({"ID"}, {"600"}, whereParameters) == 2);
+        REQUIRE(myTable.updateRecords({"ID", "Name"}, {"600", "\"Updated\""}, whereParameters) == 2);
+        REQUIRE(myTable.updateRecords({"ID"}, {"600"}, whereParameters) == 0);
+        REQUIRE_THROWS(myTable.updateRecords({"Date"}, {"31/02/2022"}, whereParameters));
+
+        std::vector<std::string> indexWhere = {"ID", "=", "600"};
+        std::list<Record*> selection = myTable.selectRecords(distinctColumns, orderByColumns, indexWhere);
+        REQUIRE(selection.size() == 2);
+        REQUIRE(selection.front()->getData(1)->getValueUniform() == "\"Updated\"");
+        indexWhere = {"ID", "<", "600"};
+        REQUIRE(myTable.selectRecords(distinctColumns, orderByColumns, indexWhere).size() == 3);
+    }
+
+    SECTION("REMOVE FROM MyTable WHERE ID = 400 and VACUUM MyTable") {
+        whereParameters.push_back("ID");
+        whereParameters.push_back("=");
+        whereParameters.push_back("400");
+        myTable.removeRecords(whereParameters);
+        REQUIRE(myTable.getTableNumberOfRecords() == 4);
+        REQUIRE(myTable.getTableRemovedRecords() == 1);
+        REQUIRE(myTable.selectRecords(distinctColumns, orderByColumns, whereParameters).empty());
+
+        myTable.vacuumTable();
+        REQUIRE(myTable.getTableNumberOfRecords() == 4);
+        REQUIRE(myTable.getTableRemovedRecords() == 0);
+        whereParameters[1] = ">=";
+        whereParameters[2] = "300";
+        std::list<Record*> selection = myTable.selectRecords(distinctColumns, orderByColumns, whereParameters);
+        REQUIRE(selection.size() == 2);
+        REQUIRE(selection.front()->getRowId() < 4);
+    }
+
+    SECTION("Zone maps -> SELECT * FROM MyTable WHERE Name = \"Block2\" AND Date >= 04/01/2022") {
+        for (int i = 0; i < 3 * (int)BLOCK_ROWS; ++i) {  // Each block has its own names and increasing keys
+            singleRecord.clear();
+            singleRecord.push_back(std::to_string(1000 + i));
+            singleRecord.push_back("\"Block" + std::to_string(i / BLOCK_ROWS) + "\"");
+            singleRecord.push_back("04/01/2022");
+            myTable.addRecord(singleRecord);
+        }
+        whereParameters = {"Name", "=", "\"Block2\"", "AND", "Date", ">=", "04/01/2022"};
+        REQUIRE(myTable.selectRecords(distinctColumns, orderByColumns, whereParameters).size() == BLOCK_ROWS);
+        whereParameters = {"Name", "=", "\"Block2\"", "AND", "Name", "<", "\"Block1\""};
+        REQUIRE(myTable.selectRecords(distinctColumns, orderByColumns, whereParameters).empty());
+        whereParameters = {"Name", "=", "\"Block0\"", "OR", "Name", "=", "\"Name3\""};
+        REQUIRE(myTable.selectRecords(distinctColumns, orderByColumns, whereParameters).size() == BLOCK_ROWS + 1);
+        whereParameters = {"Date", ">=", "03/01/2022", "AND", "Date", "<=", "03/01/2022"};
+        REQUIRE(myTable.selectRecords(distinctColumns, orderByColumns, whereParameters).size() == 2);
+
+        BlockSummary summary;
+        REQUIRE_FALSE(summary.maySatisfy(OperatorType::EQ, 1));
+        summary.add(myTable.selectRecords(distinctColumns, orderByColumns, whereParameters).front()->getData(2));
+        REQUIRE(summary.maySatisfy(OperatorType::LE, 100000));
+        REQUIRE_FALSE(summary.maySatisfy(OperatorType::GT, 100000));
+    }
+
+    SECTION("Query cache with table versions") {
+        unsigned long long version = myTable.getTableVersion();
+        std::vector<std::vector<std::string>> rows = {{"ID"}, {"400"}};
+        std::vector<std::vector<std::string>> cachedRows;
+        QueryCache queryCache;
+        queryCache.store("SELECT ID FROM MyTable #" + std::to_string(version), rows);
+        REQUIRE_FALSE(queryCache.lookup("SELECT ID FROM MyTable #" + std::to_string(version), cachedRows));
+
+        queryCache.setEnabled(true);
+        queryCache.store("SELECT ID FROM MyTable #" + std::to_string(version), rows);
+        REQUIRE(queryCache.lookup("SELECT ID FROM MyTable #" + std::to_string(version), cachedRows));
+        REQUIRE(cachedRows == rows);
+
+        whereParameters = {"ID", "=", "100"};
+        myTable.removeRecords(whereParameters);
+        REQUIRE(myTable.getTableVersion() != version);
+        REQUIRE_FALSE(queryCache.lookup("SELECT ID FROM MyTable #" + std::to_string(myTable.getTableVersion()), cachedRows));
+
+        queryCache.setCapacity(0);  // Everything is evicted
+        REQUIRE_FALSE(queryCache.lookup("SELECT ID FROM MyTable #" + std::to_string(version), cachedRows));
+    }
+
+    SECTION("EXPLAIN ANALYZE SELECT * FROM MyTable WHERE ID >= 300 ORDERBY Date") {
+        whereParameters = {"ID", ">=", "300"};
+        orderByColumns.push_back("Date");
+        QueryProfiler profiler;
+        profiler.startQuery();
+        std::list<Record*> selection = myTable.selectRecords(distinctColumns, orderByColumns, whereParameters, -1, 0, &profiler);
+        REQUIRE(selection.size() == 3);
+
+        std::vector<std::vector<std::string>> stageRows = profiler.profileRows();
+        REQUIRE(stageRows.size() == 4);
+        REQUIRE(stageRows[1][0].find("Filter") == 0);
+        REQUIRE(stageRows[1][2] == "5");
+        REQUIRE(stageRows[1][3] == "3");
+        REQUIRE(std::stoull(stageRows[1][5]) > 0);  // The selected row ids are allocated during the stage
+        REQUIRE(stageRows[2][0] == "Sort");
+        REQUIRE(stageRows[3][0] == "Limit");
+        REQUIRE(profiler.totalMilliseconds() >= 0);
+    }
+
+    SECTION("INSERT MyTable with a batch of records") {
+        std::vector<std::vector<std::string>> recordsBatch;
+        for (int i = 0; i < 100; ++i) recordsBatch.push_back({std::to_string((i * 37) % 100), "\"Batch\"", "05/01/2022"});
+        myTable.addRecords(recordsBatch);
+        REQUIRE(myTable.getTableNumberOfRecords() == 105);
+
+        whereParameters = {"ID", "<", "50"};  // Answered by the merged index
+        REQUIRE(myTable.selectRecords(distinctColumns, orderByColumns, whereParameters).size() == 50);
+        whereParameters = {"ID", "<=", "100"};  // Old and new records with equal keys
+        REQUIRE(myTable.selectRecords(distinctColumns, orderByColumns, whereParameters).size() == 101);
+
+        recordsBatch.back()[2] = "32/01/2022";  // A single invalid record rejects the whole batch
+        REQUIRE_THROWS(myTable.addRecords(recordsBatch));
+        REQUIRE(myTable.getTableNumberOfRecords() == 105);
+        recordsBatch.back().pop_back();
+        REQUIRE_THROWS(myTable.addRecords(recordsBatch));
+        REQUIRE(myTable.getTableNumberOfRecords() == 105);
+    }
+
+    SECTION("STRING and DATE indexes -> SELECT * FROM IndexTable WHERE Name LIKE \"Name1%\"") {
+        Table indexTable("IndexTable");
+        indexTable.addField("Name", FieldType::STRING, false, true, "");
+        indexTable.addField("Date", FieldType::DATE, false, true, "");
+        std::vector<std::vector<std::string>> recordsBatch;
+        for (int i = 0; i < 200; ++i) recordsBatch.push_back({"\"Name" + std::to_string(i) + "\"", formatDate(19000 + i % 20)});
+        indexTable.addRecords(recordsBatch);
+
+        whereParameters = {"Name", "=", "\"Name42\""};
+        REQUIRE(indexTable.selectRecordsWhere(whereParameters).size() == 1);
+        QueryProfiler profiler;
+        profiler.startQuery();
+        profiler.startStage("Filter", 200);
+        whereParameters = {"Name", "LIKE", "\"Name1%\""};  // Name1, Name10 - Name19, Name100 - Name199
+        REQUIRE(indexTable.selectRecordsWhere(whereParameters, -1, &profiler).size() == 111);
+        profiler.endStage(111);
+        REQUIRE(profiler.profileRows()[1][0] == "Filter (index on Name)");
+        whereParameters = {"Name", "LIKE", "\"Name1_\""};
+        REQUIRE(indexTable.selectRecordsWhere(whereParameters).size() == 10);
+        whereParameters = {"Name", "LIKE", "\"%9\""};  // Without a prefix all records are scanned
+        REQUIRE(indexTable.selectRecordsWhere(whereParameters).size() == 20);
+        whereParameters = {"Name", "<", "\"Name2\""};
+        REQUIRE(indexTable.selectRecordsWhere(whereParameters).size() == 112);
+        whereParameters = {"Name", "=", "Name42"};
+        REQUIRE_THROWS(indexTable.selectRecordsWhere(whereParameters));
+        whereParameters = {"Date", "LIKE", "\"0%\""};
+        REQUIRE_THROWS(indexTable.selectRecordsWhere(whereParameters));
+
+        whereParameters = {"Date", "=", formatDate(19005)};
+        REQUIRE(indexTable.selectRecordsWhere(whereParameters).size() == 10);
+        whereParameters = {"Date", ">=", formatDate(19018)};
+        REQUIRE(indexTable.selectRecordsWhere(whereParameters).size() == 20);
+    }
+
+    SECTION("B+ tree index -> CREATETABLE TreeTable (ID:INT INDEX BPTREE, Name:STRING INDEX BPTREE)") {
+        Table treeTable("TreeTable");
+        treeTable.addField("ID", FieldType::INT, false, true, "", IndexType::BPTREE);
+        treeTable.addField("Name", FieldType::STRING, false, true, "", IndexType::BPTREE);
+        REQUIRE(treeTable.tableDefinition() == "CREATETABLE TreeTable (ID:INT INDEX BPTREE, Name:STRING INDEX BPTREE)\n");
+
+        std::vector<std::vector<std::string>> recordsBatch;
+        for (int i = 0; i < 5000; ++i) recordsBatch.push_back({std::to_string((i * 7919) % 5000), "\"Name" + std::to_string(i % 500) + "\""});
+        treeTable.addRecords(recordsBatch);  // Built with full leaves
+        for (int i = 0; i < 1000; ++i) treeTable.addRecord({std::to_string(i), "\"Extra\""});  // Leaves are split
+
+        whereParameters = {"ID", "=", "42"};
+        REQUIRE(treeTable.selectRecordsWhere(whereParameters).size() == 2);
+        whereParameters = {"ID", ">=", "4900"};
+        REQUIRE(treeTable.selectRecordsWhere(whereParameters).size() == 100);
+        whereParameters = {"ID", "<", "10"};
+        REQUIRE(treeTable.selectRecordsWhere(whereParameters, 5).size() == 5);
+        whereParameters = {"Name", "LIKE", "\"Name49%\""};  // Name49, Name490 - Name499
+        REQUIRE(treeTable.selectRecordsWhere(whereParameters).size() == 110);
+        whereParameters = {"Name", "=", "\"Extra\""};
+        REQUIRE(treeTable.selectRecordsWhere(whereParameters).size() == 1000);
+
+        whereParameters = {"ID", "<", "2500"};
+        treeTable.removeRecords(whereParameters);
+        whereParameters = {"ID", "<=", "2500"};
+        REQUIRE(treeTable.selectRecordsWhere(whereParameters).size() == 1);
+        std::vector<std::string> selectedColumns = {"COUNT(ID)", "MIN(ID)", "MAX(Name)"};
+        std::vector<std::string> groupByColumns;
+        whereParameters.clear();
+        std::vector<std::vector<std::string>> aggregation = treeTable.aggregateRecords(selectedColumns, groupByColumns, whereParameters);
+        REQUIRE(aggregation[1][0] == "2500");
+        REQUIRE(aggregation[1][1] == "2500");
+        REQUIRE(aggregation[1][2] == "\"Name99\"");
+    }
+
+    SECTION("Compressed blocks -> SELECT * FROM CompressedTable WHERE Value >= 10 AND Value < 20") {
+        std::ostringstream discardedOutput;
+        std::streambuf* consoleOutput = std::cout.rdbuf();
+        std::cout.rdbuf(discardedOutput.rdbuf());
+        CommandLine commandLine;
+        commandLine.CommandLineDirectInput("CREATETABLE CompressedTable (ID:INT, Value:INT, Day:DATE)");
+        std::string insertCommand = "INSERT CompressedTable";
+        for (int i = 0; i < 2 * (int)BLOCK_ROWS + 100; ++i) {  // Two full blocks and a tail block
+            insertCommand += " (" + std::to_string(i) + ", " + std::to_string(i / 50) + ", 0" + std::to_string(i % 9 + 1) + "/01/2022)";
+        }
+        commandLine.CommandLineDirectInput(insertCommand.c_str());
+        Table* compressedTable = commandLine.getTableByName("CompressedTable");
+        REQUIRE(compressedTable->compressedSizeBytes() * 5 < compressedTable->tableSizeBytes());
+        REQUIRE(compressedTable->tableInfo().find("Compressed: " + std::to_string(compressedTable->compressedSizeBytes()) + "bytes") != std::string::npos);
+
+        whereParameters = {"Value", ">=", "10", "AND", "Value", "<", "20"};
+        REQUIRE(compressedTable->selectRecordsWhere(whereParameters).size() == 500);
+        whereParameters = {"ID", ">=", "2000"};
+        REQUIRE(compressedTable->selectRecordsWhere(whereParameters).size() == 148);
+        whereParameters = {"ID", ">=", "2000"};  // UPDATE and REMOVE change the written blocks
+        compressedTable->updateRecords({"Value"}, {"15"}, whereParameters);
+        whereParameters = {"ID", "<", "500"};
+        compressedTable->removeRecords(whereParameters);
+        whereParameters = {"Value", ">=", "10", "AND", "Value", "<", "20"};
+        REQUIRE(compressedTable->selectRecordsWhere(whereParameters).size() == 648);
+        whereParameters = {"Day", "=", "03/01/2022"};
+        REQUIRE(compressedTable->selectRecordsWhere(whereParameters).size() == 183);
+
+        std::string records = compressedTable->recordDefinition();
+        commandLine.CommandLineDirectInput("CLOSE CompressedTable");
+        commandLine.finishFlushes();  // The file is written in the background
+        std::ifstream fileInput("CompressedTable.sdp", std::ios::in | std::ios::binary | std::ios::ate);
+        REQUIRE(fileInput.is_open());
+        REQUIRE((unsigned long long)fileInput.tellg() * 5 < records.size());  // The file is much smaller than the commands
+        fileInput.close();
+        commandLine.CommandLineDirectInput("OPEN CompressedTable");
+        std::cout.rdbuf(consoleOutput);
+        compressedTable = commandLine.getTableByName("CompressedTable");
+        REQUIRE(compressedTable->recordDefinition() == records);
+        REQUIRE(compressedTable->selectRecordsWhere(whereParameters).size() == 183);
+        std::remove("CompressedTable.sdp");
+
+        std::cout.rdbuf(discardedOutput.rdbuf());
+        commandLine.CommandLineDirectInput("CREATETABLE ReopenedTable (ID:INT)");
+        commandLine.CommandLineDirectInput("INSERT ReopenedTable (1)");
+        commandLine.CommandLineDirectInput("CLOSE ReopenedTable");
+        commandLine.CommandLineDirectInput("OPEN ReopenedTable");
+        commandLine.CommandLineDirectInput("INSERT ReopenedTable (2)");
+        REQUIRE_THROWS(commandLine.CommandLineDirectInput("OPEN ReopenedTable"));  // The file does not replace the newer records
+        std::cout.rdbuf(consoleOutput);
+        whereParameters.clear();
+        REQUIRE(commandLine.getTableByName("ReopenedTable")->selectRecordsWhere(whereParameters).size() == 2);
+        std::remove("ReopenedTable.sdp");
+    }
+
+    SECTION("Memory limit -> SET MEMORYLIMIT <bytes>") {
+        std::ostringstream commandOutput;
+        std::streambuf* consoleOutput = std::cout.rdbuf();
+        std::cout.rdbuf(commandOutput.rdbuf());
+        CommandLine commandLine;
+        std::string insertCommand;
+        for (int i = 0; i < 2000; ++i) insertCommand += " (" + std::to_string(i) + ", \"A long enough name " + std::to_string(i) + "\")";
+        commandLine.CommandLineDirectInput("CREATETABLE FirstTable (ID:INT INDEX, Name:STRING)");
+        commandLine.CommandLineDirectInput(("INSERT FirstTable" + insertCommand).c_str());
+        commandLine.CommandLineDirectInput("CREATETABLE SecondTable (ID:INT INDEX BPTREE, Name:STRING)");
+        commandLine.CommandLineDirectInput(("INSERT SecondTable" + insertCommand).c_str());
+
+        Table* firstTable = commandLine.getTableByName("FirstTable");
+        size_t tableMemory = firstTable->memoryBytes();
+        REQUIRE(tableMemory > 3 * (size_t)firstTable->tableSizeBytes());  // Records, fields and index nodes
+        REQUIRE(tableMemory > firstTable->recordsMemoryBytes() + firstTable->blocksMemoryBytes());  // The index is counted too
+        REQUIRE(firstTable->tableInfo().find("Index ID: ") != std::string::npos);
+
+        commandLine.CommandLineDirectInput("SELECT * FROM SecondTable WHERE ID = 5");
+        commandLine.CommandLineDirectInput(("SET MEMORYLIMIT " + std::to_string(tableMemory * 3 / 2)).c_str());  // Only one table fits
+        REQUIRE(commandOutput.str().find("Table FirstTable evicted") != std::string::npos);
+        REQUIRE(commandOutput.str().find("Table SecondTable evicted") == std::string::npos);
+        commandLine.CommandLineDirectInput("LISTTABLES");
+        REQUIRE(commandOutput.str().find("FirstTable (evicted)") != std::string::npos);
+
+        commandLine.CommandLineDirectInput("SELECT * FROM FirstTable WHERE ID = 5");  // Loaded again, the other table is evicted
+        REQUIRE(commandOutput.str().find("Table SecondTable evicted") != std::string::npos);
+        firstTable = commandLine.getTableByName("FirstTable");
+        REQUIRE(firstTable->getTableNumberOfRecords() == 2000);
+        whereParameters = {"ID", "<", "100"};
+        REQUIRE(firstTable->selectRecordsWhere(whereParameters).size() == 100);
+        commandLine.CommandLineDirectInput("SET MEMORYLIMIT OFF");
+        commandLine.CommandLineDirectInput("DROPTABLE FirstTable");
+        REQUIRE(commandLine.getTableByName("SecondTable")->getTableNumberOfRecords() == 2000);
+        commandLine.finishFlushes();
+        std::cout.rdbuf(consoleOutput);
+        std::remove("FirstTable.sdp");
+        std::remove("SecondTable.sdp");
+    }
+
+    SECTION("Background writes -> CHECKPOINT Orders -> CLOSE Orders") {
+        std::ostringstream commandOutput;
+        std::streambuf* consoleOutput = std::cout.rdbuf();
+        std::cout.rdbuf(commandOutput.rdbuf());
+        CommandLine commandLine;
+        std::string insertCommand = "INSERT Orders";
+        for (int i = 0; i < 3000; ++i) insertCommand += " (" + std::to_string(i) + ", \"Customer" + std::to_string(i % 30) + "\")";
+        commandLine.CommandLineDirectInput("CREATETABLE Orders (ID:INT INDEX, Customer:STRING)");
+        commandLine.CommandLineDirectInput(insertCommand.c_str());
+        commandLine.CommandLineDirectInput("CREATETABLE Notes (ID:INT)");
+
+        commandLine.CommandLineDirectInput("CHECKPOINT Orders");
+        commandLine.CommandLineDirectInput("INSERT Notes (1)");  // Other tables are served during the write
+        commandLine.CommandLineDirectInput("INSERT Orders (3000, \"Customer0\")");  // Waits for the write of the table
+        REQUIRE(commandLine.getTableByName("Orders")->getTableNumberOfRecords() == 3001);
+        std::vector<Table*> loadedTables = loadSnapshot("Orders.sdp");  // The checkpoint has the records before the INSERT
+        REQUIRE(loadedTables.size() == 1);
+        REQUIRE(loadedTables[0]->getTableNumberOfRecords() == 3000);
+        delete loadedTables[0];
+
+        commandLine.CommandLineDirectInput("CLOSE Orders");
+        REQUIRE_THROWS(commandLine.CommandLineDirectInput("CHECKPOINT Orders"));
+        commandLine.CommandLineDirectInput("OPEN Orders");  // Waits for the write of the table
+        REQUIRE(commandLine.getTableByName("Orders")->getTableNumberOfRecords() == 3001);
+        whereParameters = {"Customer", "=", "\"Customer0\""};
+        REQUIRE(commandLine.getTableByName("Orders")->selectRecordsWhere(whereParameters).size() == 101);
+
+        commandLine.CommandLineDirectInput("SET CHECKPOINT 1");
+        commandLine.CommandLineDirectInput("INSERT Notes (2)");
+        commandLine.CommandLineDirectInput("INSERT Notes (3)");  // The changed tables are written after every command
+        commandLine.finishFlushes();
+        loadedTables = loadSnapshot("Notes.sdp");
+        REQUIRE(loadedTables[0]->getTableNumberOfRecords() == 3);
+        delete loadedTables[0];
+        commandLine.CommandLineDirectInput("SET CHECKPOINT OFF");
+        REQUIRE_THROWS(commandLine.CommandLineDirectInput("SET CHECKPOINT NEVER"));
+        std::cout.rdbuf(consoleOutput);
+        std::remove("Orders.sdp");
+        std::remove("Notes.sdp");
+    }
+
+    SECTION("Scripts -> SOURCE 'TestScript.sql'") {
+        std::ostringstream commandOutput;
+        std::streambuf* consoleOutput = std::cout.rdbuf();
+        std::cout.rdbuf(commandOutput.rdbuf());
+        CommandLine commandLine;
+        std::ofstream scriptOutput("TestScript.sql", std::ios::out | std::ios::trunc);
+        scriptOutput << "-- Orders of the customers\n"
+                     << "CREATETABLE Orders (ID:INT INDEX, Customer:STRING)\r\n";
+        for (int i = 0; i < 500; ++i) scriptOutput << "INSERT Orders (" << i << ", \"Customer" << i % 10 << "\");\n";
+        scriptOutput << "\n"
+                     << "SELECT * FROM Orders WHERE ID = 7\n"
+                     << "INSERT Orders (500, \"Customer0\")\n";
+        scriptOutput.close();
+
+        std::ifstream scriptInput("TestScript.sql", std::ios::in);
+        std::vector<ScriptCommand> scriptCommands = commandLine.parseScript(scriptInput);
+        scriptInput.close();
+        REQUIRE(scriptCommands.size() == 4);  // The consecutive INSERT commands are a single batch
+        REQUIRE(scriptCommands[1].lineNumber == 3);
+        REQUIRE(scriptCommands[3].lineNumber == 505);
+
+        commandLine.CommandLineDirectInput("SOURCE 'TestScript.sql'");
+        REQUIRE(commandLine.getTableByName("Orders")->getTableNumberOfRecords() == 501);
+        whereParameters = {"Customer", "=", "\"Customer0\""};
+        REQUIRE(commandLine.getTableByName("Orders")->selectRecordsWhere(whereParameters).size() == 51);
+        REQUIRE(commandOutput.str().find("\"Customer7\"") != std::string::npos);
+        REQUIRE(commandOutput.str().find("(V) Script executed!") != std::string::npos);
+
+        scriptOutput.open("TestScript.sql", std::ios::out | std::ios::trunc);
+        scriptOutput << "INSERT Orders (501, \"Customer1\")\nINSERT Orders (502)\nSOURCE 'TestScript.sql'\n";
+        scriptOutput.close();
+        try {
+            commandLine.CommandLineDirectInput("SOURCE 'TestScript.sql'");
+        } catch (const std::invalid_argument& e) {
+            REQUIRE(std::string(e.what()).find("(TestScript.sql, line 1)") != std::string::npos);
+        }
+        REQUIRE(commandLine.getTableByName("Orders")->getTableNumberOfRecords() == 501);  // The failed batch inserts no records
+
+        scriptOutput.open("TestScript.sql", std::ios::out | std::ios::trunc);
+        scriptOutput << "SOURCE 'TestScript.sql'\n";
+        scriptOutput.close();
+        REQUIRE_THROWS(commandLine.CommandLineDirectInput("SOURCE 'TestScript.sql'"));  // A script cannot run itself
+        REQUIRE_THROWS(commandLine.CommandLineDirectInput("SOURCE 'MissingScript.sql'"));
+        std::cout.rdbuf(consoleOutput);
+        std::remove("TestScript.sql");
+    }
+
+    SECTION("Transactions -> BEGIN, COMMIT and ROLLBACK") {
+        std::ostringstream discardedOutput;
+        std::streambuf* consoleOutput = std::cout.rdbuf();
+        std::cout.rdbuf(discardedOutput.rdbuf());
+        CommandLine commandLine;
+        commandLine.CommandLineDirectInput("CREATETABLE Accounts (ID:INT INDEX, Owner:STRING INDEX BPTREE, Balance:INT)");
+        commandLine.CommandLineDirectInput("INSERT Accounts (1, \"Ann\", 100) (2, \"Bob\", 50) (3, \"Cid\", 75)");
+        commandLine.CommandLineDirectInput("CREATE VIEW Total AS SELECT COUNT(*), SUM(Balance) FROM Accounts");
+        Table* accountsTable = commandLine.getTableByName("Accounts");
+        std::string records = accountsTable->recordDefinition();
+
+        commandLine.CommandLineDirectInput("BEGIN");
+        REQUIRE_THROWS(commandLine.CommandLineDirectInput("BEGIN"));
+        std::string insertCommand = "INSERT Accounts";
+        for (int i = 4; i < 2000; ++i) insertCommand += " (" + std::to_string(i) + ", \"Dan\", 10)";  // Full blocks are dropped too
+        commandLine.CommandLineDirectInput(insertCommand.c_str());
+        commandLine.CommandLineDirectInput("REMOVE FROM Accounts WHERE ID < 1500");
+        commandLine.CommandLineDirectInput("UPDATE Accounts SET Owner = \"Eve\", Balance = 0 WHERE ID = 1600");
+        REQUIRE(accountsTable->getTableNumberOfRecords() == 500);  // The tombstones wait for the end of the transaction
+        commandLine.CommandLineDirectInput("ROLLBACK");
+        REQUIRE(accountsTable->recordDefinition() == records);
+        REQUIRE(accountsTable->getTableRemovedRecords() == 0);
+        whereParameters = {"ID", "=", "2"};
+        REQUIRE(accountsTable->selectRecordsWhere(whereParameters).size() == 1);
+        whereParameters = {"Owner", "=", "\"Eve\""};
+        REQUIRE(accountsTable->selectRecordsWhere(whereParameters).empty());
+        std::vector<std::vector<std::string>> expectedRows = {{"COUNT(*)", "SUM(Balance)"}, {"3", "225"}};
+        REQUIRE(commandLine.getViewByName("Total")->viewRows() == expectedRows);
+
+        commandLine.CommandLineDirectInput("BEGIN");
+        commandLine.CommandLineDirectInput("UPDATE Accounts SET Balance = 60 WHERE ID = 2");
+        commandLine.CommandLineDirectInput("INSERT Accounts (4, \"Dan\", 10)");
+        commandLine.CommandLineDirectInput("COMMIT");
+        REQUIRE_THROWS(commandLine.CommandLineDirectInput("ROLLBACK"));
+        expectedRows = {{"COUNT(*)", "SUM(Balance)"}, {"4", "245"}};
+        REQUIRE(commandLine.getViewByName("Total")->viewRows() == expectedRows);
+
+        commandLine.CommandLineDirectInput("BEGIN");
+        commandLine.CommandLineDirectInput("REMOVE FROM Accounts WHERE ID = 4");
+        commandLine.CommandLineDirectInput("VACUUM Accounts");  // The changes before it are committed
+        commandLine.CommandLineDirectInput("INSERT Accounts (5, \"Fay\", 20)");
+        commandLine.CommandLineDirectInput("ROLLBACK");
+        REQUIRE(accountsTable->getTableNumberOfRecords() == 3);
+
+        std::ofstream scriptOutput("TestTransaction.sql", std::ios::out | std::ios::trunc);
+        scriptOutput << "INSERT Accounts (6, \"Gus\", 30)\nREMOVE FROM Accounts WHERE ID = 1\nINSERT Accounts (7)\n";
+        scriptOutput.close();
+        REQUIRE_THROWS(commandLine.CommandLineDirectInput("SOURCE 'TestTransaction.sql'"));  // The failed script is undone
+        REQUIRE(accountsTable->getTableNumberOfRecords() == 3);
+        whereParameters = {"ID", "=", "1"};
+        REQUIRE(accountsTable->selectRecordsWhere(whereParameters).size() == 1);
+        commandLine.CommandLineDirectInput("DROP VIEW Total");
+        std::cout.rdbuf(consoleOutput);
+        std::remove("TestTransaction.sql");
+    }
+
+    SECTION("Catalog -> CREATETABLE, DROPTABLE and table ids") {
+        std::ostringstream discardedOutput;
+        std::streambuf* consoleOutput = std::cout.rdbuf();
+        std::cout.rdbuf(discardedOutput.rdbuf());
+        CommandLine commandLine;
+        for (int i = 0; i < 1000; ++i) commandLine.CommandLineDirectInput(("CREATETABLE Tenant" + std::to_string(i) + " (ID:INT)").c_str());
+        int tenantId = commandLine.getTableId("Tenant500");
+        REQUIRE(tenantId == 500);
+        REQUIRE(commandLine.getTableById(tenantId)->getTableName() == "Tenant500");
+        REQUIRE(commandLine.getTableId("Tenant1000") == -1);
+
+        commandLine.CommandLineDirectInput("INSERT Tenant500 (1) (2)");
+        commandLine.CommandLineDirectInput("CLOSE Tenant500");
+        commandLine.CommandLineDirectInput("OPEN Tenant500");  // The loaded table keeps its id
+        REQUIRE(commandLine.getTableId("Tenant500") == tenantId);
+        REQUIRE(commandLine.getTableById(tenantId)->getTableNumberOfRecords() == 2);
+
+        commandLine.CommandLineDirectInput("DROPTABLE Tenant500");
+        REQUIRE(commandLine.getTableById(tenantId) == nullptr);  // A saved id of a dropped table is recognised
+        REQUIRE(commandLine.getTableByName("Tenant500") == nullptr);
+        commandLine.CommandLineDirectInput("CREATETABLE Tenant500 (ID:INT)");
+        REQUIRE(commandLine.getTableId("Tenant500") == 1000);  // Ids are not reused
+        REQUIRE(commandLine.getTableById(499)->getTableName() == "Tenant499");
+        REQUIRE_THROWS(commandLine.CommandLineDirectInput("DROPTABLE Tenant1000"));
+        std::cout.rdbuf(consoleOutput);
+        std::remove("Tenant500.sdp");
+    }
+
+    SECTION("Materialized views -> CREATE VIEW RegionTotals AS SELECT Region, COUNT(*), SUM(Amount), MIN(Amount) FROM Sales GROUPBY Region") {
+        std::ostringstream discardedOutput;
+        std::streambuf* consoleOutput = std::cout.rdbuf();
+        std::cout.rdbuf(discardedOutput.rdbuf());
+        CommandLine commandLine;
+        commandLine.CommandLineDirectInput("CREATETABLE Sales (ID:INT INDEX, Region:STRING, Amount:INT)");
+        commandLine.CommandLineDirectInput("INSERT Sales (1, \"North\", 10) (2, \"South\", 20) (3, \"North\", 30)");
+        commandLine.CommandLineDirectInput("CREATE VIEW RegionTotals AS SELECT Region, COUNT(*), SUM(Amount), MIN(Amount) FROM Sales GROUPBY Region");
+        commandLine.CommandLineDirectInput("CREATE VIEW LargeSales AS SELECT ID, Amount FROM Sales WHERE Amount >= 20");
+        MaterializedView* regionTotals = commandLine.getViewByName("RegionTotals");
+        MaterializedView* largeSales = commandLine.getViewByName("LargeSales");
+        std::vector<std::vector<std::string>> expectedRows = {{"Region", "COUNT(*)", "SUM(Amount)", "MIN(Amount)"},
+                                                              {"\"North\"", "2", "40", "10"},
+                                                              {"\"South\"", "1", "20", "20"}};
+        REQUIRE(regionTotals->viewRows() == expectedRows);
+
+        commandLine.CommandLineDirectInput("INSERT Sales (4, \"East\", 5) (5, \"South\", 40)");
+        commandLine.CommandLineDirectInput("REMOVE FROM Sales WHERE ID = 1");  // The removed minimum is replaced
+        commandLine.CommandLineDirectInput("UPDATE Sales SET Region = \"East\" WHERE ID = 2");
+        expectedRows = {{"Region", "COUNT(*)", "SUM(Amount)", "MIN(Amount)"},
+                        {"\"North\"", "1", "30", "30"},
+                        {"\"South\"", "1", "40", "40"},
+                        {"\"East\"", "2", "25", "5"}};
+        REQUIRE(regionTotals->viewRows() == expectedRows);
+        expectedRows = {{"ID", "Amount"}, {"2", "20"}, {"3", "30"}, {"5", "40"}};
+        REQUIRE(largeSales->viewRows() == expectedRows);
+
+        commandLine.CommandLineDirectInput("VACUUM Sales");
+        commandLine.CommandLineDirectInput("CLOSE Sales");
+        commandLine.CommandLineDirectInput("OPEN Sales");  // The view observes the loaded table
+        commandLine.CommandLineDirectInput("INSERT Sales (6, \"North\", 50)");
+        REQUIRE(largeSales->viewRows().size() == 5);
+        REQUIRE(regionTotals->countRows() == 3);
+        REQUIRE_THROWS(commandLine.CommandLineDirectInput("SELECT ID FROM LargeSales"));
+        REQUIRE_THROWS(commandLine.CommandLineDirectInput("DROPTABLE Sales"));
+        REQUIRE_THROWS(commandLine.CommandLineDirectInput("CREATE VIEW Broken AS SELECT Region, SUM(Amount) FROM Sales"));
+
+        commandLine.CommandLineDirectInput("DROP VIEW RegionTotals");
+        commandLine.CommandLineDirectInput("DROP VIEW LargeSales");
+        REQUIRE(commandLine.getViewByName("LargeSales") == nullptr);
+        commandLine.CommandLineDirectInput("DROPTABLE Sales");
+        std::cout.rdbuf(consoleOutput);
+        std::remove("Sales.sdp");
+    }
+
+    SECTION("Field names -> SELECT * FROM WideTable WHERE 5 < C110 AND C119 LIKE \"Text1%\"") {
+        Table wideTable("WideTable");
+        for (int i = 0; i < 119; ++i) wideTable.addField("C" + std::to_string(i), FieldType::INT);
+        wideTable.addField("C119", FieldType::STRING);
+        for (int i = 0; i < 200; ++i) {
+            std::vector<std::string> wideRecord(119, std::to_string(i % 10));
+            wideRecord.push_back("\"Text" + std::to_string(i % 20) + "\"");
+            wideTable.addRecord(wideRecord);
+        }
+        REQUIRE(wideTable.getFieldIndexByName("C0") == 0);
+        REQUIRE(wideTable.getFieldIndexByName("C119") == 119);
+        REQUIRE(wideTable.getFieldIndexByName("C120") == -1);
+
+        whereParameters = {"5", "<", "C110", "AND", "C119", "LIKE", "\"Text1%\""};  // The field is moved first with the mirrored operator, as in isInSelection
+        std::list<Record*> selection = wideTable.selectRecords(distinctColumns, orderByColumns, whereParameters);
+        REQUIRE(selection.size() == 40);
+        REQUIRE(selection.front()->getData(110)->getValueUniform() == "6");
+        whereParameters = {"1000000000", "<", "C110"};  // Long literals are left to isInSelection
+        REQUIRE(wideTable.selectRecords(distinctColumns, orderByColumns, whereParameters).empty());
+
+        whereParameters = {"C3", "=", "2", "OR", "C119", "=", "\"Text7\""};
+        selection = wideTable.selectRecords(distinctColumns, orderByColumns, whereParameters);
+        REQUIRE(selection.size() == 30);
+
+        whereParameters = {"C3", "<", "1000000000", "AND", "C3", ">=", "8"};  // Long literals are left to isInSelection
+        selection = wideTable.selectRecords(distinctColumns, orderByColumns, whereParameters);
+        REQUIRE(selection.size() == 40);
+
+        whereParameters = {"NOT", "C3", "=", "2"};
+        selection = wideTable.selectRecords(distinctColumns, orderByColumns, whereParameters);
+        REQUIRE(selection.size() == 180);
+        whereParameters = {"C3", "<", "5", "AND", "NOT", "C119", "LIKE", "\"Text1%\""};
+        selection = wideTable.selectRecords(distinctColumns, orderByColumns, whereParameters);
+        REQUIRE(selection.size() == 40);
+        whereParameters = {"NOT", "C3", "<", "1000000000", "OR", "C3", "=", "9"};  // NOT is the same in isInSelection
+        selection = wideTable.selectRecords(distinctColumns, orderByColumns, whereParameters);
+        REQUIRE(selection.size() == 20);
+        whereParameters = {"NOT"};
+        REQUIRE_THROWS(wideTable.selectRecords(distinctColumns, orderByColumns, whereParameters));
+    }
+
+    SECTION("Selection vectors -> SELECT ID FROM RowTable WHERE Value < 5 ORDERBY Name LIMIT 3 OFFSET 1") {
+        Table rowTable("RowTable");
+        rowTable.addField("ID", FieldType::INT);
+        rowTable.addField("Name", FieldType::STRING);
+        rowTable.addField("Value", FieldType::INT);
+        for (int i = 0; i < 12; ++i) rowTable.addRecord({std::to_string(i), "\"Name" + std::to_string(i % 3) + "\"", std::to_string(i % 7)});
+        whereParameters = {"ID", "=", "4"};
+        rowTable.removeRecords(whereParameters);
+
+        whereParameters = {"Value", "<", "5"};
+        std::vector<unsigned int> rowIds = rowTable.selectRowIds(distinctColumns, {"Name"}, whereParameters);
+        std::vector<unsigned int> expectedRowIds = {0, 3, 9, 1, 7, 10, 2, 8, 11};  // Equal names keep the row order
+        REQUIRE(rowIds == expectedRowIds);
+        rowIds = rowTable.selectRowIds(distinctColumns, {"Name"}, whereParameters, 3, 1);
+        expectedRowIds = {3, 9, 1};
+        REQUIRE(rowIds == expectedRowIds);
+        rowIds = rowTable.selectRowIds(distinctColumns, {"Value", "Name"}, whereParameters);  // The last column is the primary one
+        expectedRowIds = {0, 9, 3, 7, 1, 10, 8, 2, 11};
+        REQUIRE(rowIds == expectedRowIds);
+        rowIds = rowTable.selectRowIds({"Name"}, orderByColumns, whereParameters, 2);
+        expectedRowIds = {0, 1};
+        REQUIRE(rowIds == expectedRowIds);
+        REQUIRE(rowTable.getRecord(rowIds[1])->getData(1)->getValueString() == "\"Name1\"");
+
+        std::list<Record*> selection = rowTable.selectRecords(distinctColumns, {"Name"}, whereParameters, 3, 1);
+        REQUIRE(selection.size() == 3);
+        REQUIRE(selection.front()->getRowId() == 3);
+    }
+
+    SECTION("SAVE DATABASE 'TestSnapshot.sdp' -> LOAD DATABASE 'TestSnapshot.sdp'") {
+        Table treeTable("TreeTable");
+        treeTable.addField("ID", FieldType::INT, true, true, "", IndexType::BPTREE);
+        treeTable.addField("Name", FieldType::STRING, false, true, "\"None\"");
+        for (int i = 0; i < 3000; ++i) treeTable.addRecord({std::to_string(i), "\"Name" + std::to_string(i % 7) + "\""});
+        whereParameters = {"ID", "<", "1000"};
+        treeTable.removeRecords(whereParameters);  // Removed records are not saved
+
+        saveSnapshot("TestSnapshot.sdp", {&myTable, &treeTable});
+        std::vector<Table*> loadedTables = loadSnapshot("TestSnapshot.sdp");
+        REQUIRE(loadedTables.size() == 2);
+        REQUIRE(loadedTables[0]->tableDefinition() == myTable.tableDefinition());
+        REQUIRE(loadedTables[0]->recordDefinition() == myTable.recordDefinition());
+        REQUIRE(loadedTables[1]->tableDefinition() == "CREATETABLE TreeTable (ID:INT NOTNULL INDEX BPTREE, Name:STRING INDEX DEFAULT \"None\")\n");
+        REQUIRE(loadedTables[1]->getTableNumberOfRecords() == 2000);
+        whereParameters = {"Name", "=", "\"Name3\""};  // The indexes are rebuilt
+        REQUIRE(loadedTables[1]->selectRecordsWhere(whereParameters).size() == treeTable.selectRecordsWhere(whereParameters).size());
+        for (unsigned int i = 0; i < loadedTables.size(); ++i) delete loadedTables[i];
+
+        std::ifstream fileInput("TestSnapshot.sdp", std::ios::in | std::ios::binary);
+        std::string fileData((std::istreambuf_iterator<char>(fileInput)), std::istreambuf_iterator<char>());
+        fileInput.close();
+        std::ofstream fileOutput("TestSnapshot.sdp", std::ios::out | std::ios::binary | std::ios::trunc);
+        fileOutput.write(fileData.data(), fileData.size() - 100);  // An incomplete file is rejected
+        fileOutput.close();
+        REQUIRE_THROWS(loadSnapshot("TestSnapshot.sdp"));
+        std::remove("TestSnapshot.sdp");
+        REQUIRE_THROWS(loadSnapshot("TestSnapshot.sdp"));
+
+        std::string buffer;  // Record counts that the remaining bytes cannot hold are rejected before any record is created
+        writeBinaryText(buffer, "Damaged");
+        writeBinary(buffer, 0, 4);
+        writeBinary(buffer, 4000000000u, 4);
+        const char* position = buffer.data();
+        REQUIRE_THROWS(Table::readSnapshot(position, buffer.data() + buffer.size()));
+        buffer.clear();
+        writeBinaryText(buffer, "Damaged");
+        writeBinary(buffer, 1, 4);
+        writeBinaryText(buffer, "Name");
+        writeBinary(buffer, (unsigned int)FieldType::STRING, 1);
+        writeBinary(buffer, 0, 1);
+        writeBinary(buffer, 0, 1);
+        writeBinary(buffer, 0, 1);
+        writeBinaryText(buffer, "");
+        writeBinary(buffer, 1000000, 4);
+        buffer += std::string(10000, '\0');
+        position = buffer.data();
+        REQUIRE_THROWS(Table::readSnapshot(position, buffer.data() + buffer.size()));
+    }
 }
\ No newline at end of file
@@ -25,43 +25,133 @@ bool isString(const std::string& strStr) {
     return (strStr[0] == '\"' && strStr[strStr.size() - 1] == '\"');
 }
 
-bool isDate(const std::string& datStr) {                                // Date format 31/12/2000
-    if (datStr.size() == 10 && datStr[2] == '/' && datStr[5] == '/') {  // Size and format
-        for (unsigned int i = 0; i < 10; ++i) {                         // Consists of numbers
-            if (i != 2 && i != 5) {
-                if (datStr[i] < '0' || datStr[i] > '9') return false;
-            }
-        }
-        int day = 0, month = 0, year = 0;  // Is a correct date
-        day += ((int)(datStr[0]) - (int)'0') * 10 + ((int)(datStr[1]) - (int)'0');
-        month += ((int)(datStr[3]) - (int)'0') * 10 + ((int)(datStr[4]) - (int)'0');
-        year += ((int)(datStr[6]) - (int)'0') * 1000 + ((int)(datStr[7]) - (int)'0') * 100 + ((int)(datStr[8]) - (int)'0') * 10 + ((int)(datStr[9]) - (int)'0');
-        if (day >= 1 && day <= 31 && month >= 1 && month <= 12 && year >= 0 && year <= 9999) {
-            int maxMonthDays = 30;
-            switch (month) {
-                case 2:
-                    if (year % 4 == 0 && year % 100 != 0 || year % 400 == 0)
-                        maxMonthDays = 29;
-                    else
-                        maxMonthDays = 28;
-                    break;
-                case 1:
-                case 3:
-                case 5:
-                case 7:
-                case 8:
-                case 10:
-                case 12:
-                    maxMonthDays = 31;
-                    break;
-
-                default:
-                    break;
-            }
-            if (day <= maxMonthDays) return true;
+bool isDate(const std::string& datStr) {
+    int dayNumber = 0;
+    return parseDate(datStr, dayNumber);
+}
+
+bool parseDate(const std::string& datStr, int& dayNumber) {  // Date format 31/12/2000
+    if (datStr.size() != 10 || datStr[2] != '/' || datStr[5] != '/') return false;  // Size and format
+    unsigned int digits[8];
+    const unsigned int positions[8] = {0, 1, 3, 4, 6, 7, 8, 9};
+    for (unsigned int i = 0; i < 8; ++i) {  // Consists of numbers
+        digits[i] = (unsigned int)(datStr[positions[i]] - '0');
+        if (digits[i] > 9) return false;
+    }
+    int day = digits[0] * 10 + digits[1];
+    int month = digits[2] * 10 + digits[3];
+    int year = digits[4] * 1000 + digits[5] * 100 + digits[6] * 10 + digits[7];
+
+    if (month < 1 || month > 12 || day < 1) return false;  // Is a correct date
+    static const int monthDays[12] = {31, 28, 31, 30, 31, 30, 31, 31, 30, 31, 30, 31};
+    int maxMonthDays = monthDays[month - 1];
+    if (month == 2 && ((year % 4 == 0 && year % 100 != 0) || year % 400 == 0)) maxMonthDays = 29;
+    if (day > maxMonthDays) return false;
+
+    // Days since 01/01/1970 in the proleptic Gregorian calendar
+    int shiftedYear = year - (month <= 2 ? 1 : 0);
+    int era = (shiftedYear >= 0 ? shiftedYear : shiftedYear - 399) / 400;
+    int yearOfEra = shiftedYear - era * 400;
+    int dayOfYear = (153 * (month + (month > 2 ? -3 : 9)) + 2) / 5 + day - 1;
+    int dayOfEra = yearOfEra * 365 + yearOfEra / 4 - yearOfEra / 100 + dayOfYear;
+    dayNumber = era * 146097 + dayOfEra - 719468;
+    return true;
+}
+
+std::string formatDate(int dayNumber) {
+    int shiftedDays = dayNumber + 719468;
+    int era = (shiftedDays >= 0 ? shiftedDays : shiftedDays - 146096) / 146097;
+    int dayOfEra = shiftedDays - era * 146097;
+    int yearOfEra = (dayOfEra - dayOfEra / 1460 + dayOfEra / 36524 - dayOfEra / 146096) / 365;
+    int dayOfYear = dayOfEra - (365 * yearOfEra + yearOfEra / 4 - yearOfEra / 100);
+    int shiftedMonth = (5 * dayOfYear + 2) / 153;
+    int day = dayOfYear - (153 * shiftedMonth + 2) / 5 + 1;
+    int month = shiftedMonth < 10 ? shiftedMonth + 3 : shiftedMonth - 9;
+    int year = yearOfEra + era * 400 + (month <= 2 ? 1 : 0);
+
+    char dateString[10] = {(char)('0' + day / 10), (char)('0' + day % 10), '/',
+                           (char)('0' + month / 10), (char)('0' + month % 10), '/',
+                           (char)('0' + year / 1000), (char)('0' + year / 100 % 10), (char)('0' + year / 10 % 10), (char)('0' + year % 10)};
+    return std::string(dateString, 10);
+}
+
+bool compareIntegers(int value1, int value2, OperatorType operatorCompare) {
+    switch (operatorCompare) {
+        case OperatorType::EQ:
+            return value1 == value2;
+        case OperatorType::NE:
+            return value1 != value2;
+        case OperatorType::GT:
+            return value1 > value2;
+        case OperatorType::LT:
+            return value1 < value2;
+        case OperatorType::GE:
+            return value1 >= value2;
+        case OperatorType::LE:
+            return value1 <= value2;
+        default:
+            return false;
+    }
+}
+
+OperatorType mirrorOperator(OperatorType operatorCompare) {
+    switch (operatorCompare) {
+        case OperatorType::GT:
+            return OperatorType::LT;
+        case OperatorType::LT:
+            return OperatorType::GT;
+        case OperatorType::GE:
+            return OperatorType::LE;
+        case OperatorType::LE:
+            return OperatorType::GE;
+        default:
+            return operatorCompare;
+    }
+}
+
+bool compareStrings(const std::string& value1, const std::string& value2, OperatorType operatorCompare) {
+    switch (operatorCompare) {
+        case OperatorType::EQ:
+            return value1 == value2;
+        case OperatorType::NE:
+            return value1 != value2;
+        case OperatorType::GT:
+            return value1 > value2;
+        case OperatorType::LT:
+            return value1 < value2;
+        case OperatorType::GE:
+            return value1 >= value2;
+        case OperatorType::LE:
+            return value1 <= value2;
+        default:
+            return false;
+    }
+}
+
+bool matchLike(const std::string& value, const std::string& pattern) {
+    unsigned int valuePosition = 0, patternPosition = 0;
+    int lastPercent = -1;           // Position of the last % in the pattern
+    unsigned int percentValue = 0;  // Position in the value matched by the last %
+    while (valuePosition < value.size()) {
+        if (patternPosition < pattern.size() && (pattern[patternPosition] == '_' || pattern[patternPosition] == value[valuePosition])) {
+            ++valuePosition;
+            ++patternPosition;
+        } else if (patternPosition < pattern.size() && pattern[patternPosition] == '%') {
+            lastPercent = patternPosition++;
+            percentValue = valuePosition;
+        } else if (lastPercent >= 0) {  // The last % matches one more character
+            patternPosition = lastPercent + 1;
+            valuePosition = ++percentValue;
+        } else {
+            return false;
         }
     }
-    return false;
+    while (patternPosition < pattern.size() && pattern[patternPosition] == '%') ++patternPosition;
+    return patternPosition == pattern.size();
+}
+
+std::string likePrefix(const std::string& pattern) {
+    return pattern.substr(0, pattern.find_first_of("%_"));
 }
 
 bool isTrueOrFalse(const std::string& boolStr) {
@@ -88,3 +178,36 @@ std::string toUpperString(std::string lowerCaseString) {
     }
     return lowerCaseString;
 }
+
+void writeBinary(std::string& buffer, unsigned long long value, unsigned int bytes) {
+    for (unsigned int i = 0; i < bytes; ++i) buffer.push_back((char)((value >> (8 * i)) & 0xFF));
+}
+
+void writeBinaryText(std::string& buffer, const std::string& text) {
+    writeBinary(buffer, text.size(), 4);
+    buffer += text;
+}
+
+bool readBinary(const char*& position, const char* end, unsigned long long& value, unsigned int bytes) {
+    if (end - position < bytes) return false;
+    value = 0;
+    for (unsigned int i = 0; i < bytes; ++i) value |= (unsigned long long)(unsigned char)position[i] << (8 * i);
+    position += bytes;
+    return true;
+}
+
+bool readBinaryText(const char*& position, const char* end, std::string& text) {
+    unsigned long long textSize = 0;
+    if (!readBinary(position, end, textSize, 4) || (unsigned long long)(end - position) < textSize) return false;  // The read size keeps the position before the end
+    text.assign(position, textSize);
+    position += textSize;
+    return true;
+}
+
+size_t allocationBytes(size_t size) {
+    return std::max((size_t)32, (size + sizeof(size_t) + 15) / 16 * 16);  // Chunks of 64 bit glibc malloc
+}
+
+size_t textHeapBytes(size_t length) {
+    return length > 15 ? allocationBytes(length + 1) : 0;
+}
@@ -0,0 +1,250 @@
+#include "../Headers/view.hpp"
+
+MaterializedView::MaterializedView(std::string viewName, Table* observedTable, std::vector<std::string> selectedColumns,
+                                   std::vector<std::string> groupByColumns, std::vector<std::string> whereParameters)
+    : viewName(viewName), tableName(observedTable->getTableName()), whereParameters(whereParameters) {
+    flagAggregate = !groupByColumns.empty();
+    for (unsigned int i = 0; i < selectedColumns.size(); ++i) {
+        AggregateType aggregateType = AggregateType::UNDEFINED;
+        std::string columnName;
+        if (parseAggregate(selectedColumns[i], aggregateType, columnName)) flagAggregate = true;
+    }
+    if (selectedColumns.empty()) throw std::invalid_argument("[!] Invalid view! The view should select columns!");
+
+    if (!flagAggregate) {
+        if (selectedColumns.size() == 1 && selectedColumns[0] == "*") {
+            for (int i = 0; i < observedTable->getTableColumnsSize(); ++i) columnsIndex.push_back(i);
+        } else {
+            for (unsigned int i = 0; i < selectedColumns.size(); ++i) {
+                int columnIndex = observedTable->getFieldIndexByName(selectedColumns[i]);
+                if (columnIndex < 0) throw std::invalid_argument("[!] Invalid view! Unknown selected column!");
+                columnsIndex.push_back(columnIndex);
+            }
+        }
+        for (unsigned int i = 0; i < columnsIndex.size(); ++i) headerRow.push_back(observedTable->fieldName(columnsIndex[i]));
+    } else {  // The same columns as accepted by Table::aggregateRecords
+        for (unsigned int i = 0; i < groupByColumns.size(); ++i) {
+            int columnIndex = observedTable->getFieldIndexByName(groupByColumns[i]);
+            if (columnIndex < 0) throw std::invalid_argument("[!] Invalid aggregation! Unknown GROUPBY column!");
+            groupColumnsIndex.push_back(columnIndex);
+        }
+        for (unsigned int i = 0; i < selectedColumns.size(); ++i) {
+            AggregateType aggregateType = AggregateType::UNDEFINED;
+            std::string columnName;
+            if (parseAggregate(selectedColumns[i], aggregateType, columnName)) {
+                int columnIndex = (columnName == "*") ? -1 : observedTable->getFieldIndexByName(columnName);
+                if (columnIndex < 0 && !(aggregateType == AggregateType::COUNT && columnName == "*")) {
+                    throw std::invalid_argument("[!] Invalid aggregation! Unknown aggregated column!");
+                }
+                FieldType columnType = columnIndex >= 0 ? observedTable->getFieldType(columnIndex) : FieldType::UNDEFINED;
+                if ((aggregateType == AggregateType::SUM || aggregateType == AggregateType::AVG) && columnType != FieldType::INT) {
+                    throw std::invalid_argument("[!] Invalid aggregation! INT is required for SUM and AVG!");
+                }
+                aggregateColumns.push_back(AggregateColumn(aggregateType, columnIndex, -1));
+                aggregateTypes.push_back(columnType);
+            } else {
+                int groupPosition = -1;
+                for (unsigned int j = 0; j < groupByColumns.size(); ++j) {
+                    if (groupByColumns[j] == selectedColumns[i]) groupPosition = j;
+                }
+                if (groupPosition < 0) throw std::invalid_argument("[!] Invalid aggregation! The column should be in GROUPBY!");
+                aggregateColumns.push_back(AggregateColumn(AggregateType::UNDEFINED, groupColumnsIndex[groupPosition], groupPosition));
+                aggregateTypes.push_back(observedTable->getFieldType(groupColumnsIndex[groupPosition]));
+            }
+            headerRow.push_back(selectedColumns[i]);
+        }
+    }
+    attachTable(observedTable);
+}
+
+void MaterializedView::attachTable(Table* observedTable) {
+    detachTable();
+    baseTable = observedTable;
+    whereOperands = baseTable->transformConditions(whereParameters);
+    flagCompiled = !whereParameters.empty() && baseTable->compileConditions(whereOperands, compiledConditions);
+    refreshView();  // Invalid conditions throw before the table is observed
+    baseTable->addObserver(this);
+}
+
+void MaterializedView::detachTable() {
+    if (baseTable) baseTable->removeObserver(this);
+    baseTable = nullptr;
+}
+
+bool MaterializedView::isInView(Record* currentRecord) {
+    if (whereParameters.empty()) return true;
+    return flagCompiled ? baseTable->matchesConditions(currentRecord, compiledConditions, conditionResults) : baseTable->isInSelection(currentRecord, whereOperands);
+}
+
+void MaterializedView::addToView(Record* currentRecord) {
+    if (!flagAggregate) {
+        std::vector<std::string>& row = filteredRows[currentRecord->getRowId()];
+        row.clear();
+        for (unsigned int i = 0; i < columnsIndex.size(); ++i) row.push_back(currentRecord->getData(columnsIndex[i])->getValueUniform());
+        return;
+    }
+
+    std::pair<std::unordered_map<std::string, unsigned int>::iterator, bool> group =
+        groupsByKey.insert(std::make_pair(baseTable->recordKey(currentRecord, groupColumnsIndex), (unsigned int)groups.size()));
+    if (group.second) {  // New group
+        groups.push_back(ViewGroup());
+        groups.back().groupKey = group.first->first;
+        groups.back().aggregates.resize(aggregateColumns.size());
+        for (unsigned int i = 0; i < aggregateColumns.size(); ++i) {
+            bool isGroupColumn = aggregateColumns[i].aggregateType == AggregateType::UNDEFINED;
+            groups.back().groupValues.push_back(isGroupColumn ? currentRecord->getData(aggregateColumns[i].columnIndex)->getValueUniform() : "");
+        }
+    }
+
+    ViewGroup& currentGroup = groups[group.first->second];
+    ++currentGroup.recordsCount;
+    for (unsigned int i = 0; i < aggregateColumns.size(); ++i) {
+        if (aggregateColumns[i].aggregateType == AggregateType::UNDEFINED || aggregateColumns[i].columnIndex < 0) continue;
+        DataField* value = currentRecord->getData(aggregateColumns[i].columnIndex);
+        GroupAggregate& aggregate = currentGroup.aggregates[i];
+        switch (aggregateColumns[i].aggregateType) {
+            case AggregateType::SUM:
+            case AggregateType::AVG:
+                aggregate.sum += value->getValueInt();
+                break;
+            case AggregateType::MIN:
+            case AggregateType::MAX:
+                if (aggregateTypes[i] == FieldType::STRING) {
+                    ++aggregate.stringCounts[value->getValueString()];
+                } else {
+                    ++aggregate.intCounts[value->getValueInt()];
+                }
+                break;
+            default:
+                break;
+        }
+    }
+}
+
+void MaterializedView::removeFromView(Record* currentRecord) {
+    if (!flagAggregate) {
+        filteredRows.erase(currentRecord->getRowId());
+        return;
+    }
+
+    std::unordered_map<std::string, unsigned int>::iterator group = groupsByKey.find(baseTable->recordKey(currentRecord, groupColumnsIndex));
+    if (group == groupsByKey.end()) return;
+    ViewGroup& currentGroup = groups[group->second];
+    --currentGroup.recordsCount;
+    for (unsigned int i = 0; i < aggregateColumns.size(); ++i) {
+        if (aggregateColumns[i].aggregateType == AggregateType::UNDEFINED || aggregateColumns[i].columnIndex < 0) continue;
+        DataField* value = currentRecord->getData(aggregateColumns[i].columnIndex);
+        GroupAggregate& aggregate = currentGroup.aggregates[i];
+        switch (aggregateColumns[i].aggregateType) {
+            case AggregateType::SUM:
+            case AggregateType::AVG:
+                aggregate.sum -= value->getValueInt();
+                break;
+            case AggregateType::MIN:
+            case AggregateType::MAX:
+                if (aggregateTypes[i] == FieldType::STRING) {
+                    std::map<std::string, int>::iterator counted = aggregate.stringCounts.find(value->getValueString());
+                    if (counted != aggregate.stringCounts.end() && --counted->second == 0) aggregate.stringCounts.erase(counted);
+                } else {
+                    std::map<int, int>::iterator counted = aggregate.intCounts.find(value->getValueInt());
+                    if (counted != aggregate.intCounts.end() && --counted->second == 0) aggregate.intCounts.erase(counted);
+                }
+                break;
+            default:
+                break;
+        }
+    }
+
+    if (currentGroup.recordsCount == 0 && !groupColumnsIndex.empty()) {  // Aggregates without GROUPBY keep their single row
+        groupsByKey.erase(group);
+        ++removedGroups;
+        if (removedGroups * 2 > groups.size()) compactGroups();
+    }
+}
+
+void MaterializedView::compactGroups() {
+    unsigned int keptGroups = 0;
+    for (unsigned int i = 0; i < groups.size(); ++i) {
+        if (groups[i].recordsCount == 0) continue;
+        if (keptGroups != i) groups[keptGroups] = std::move(groups[i]);
+        groupsByKey[groups[keptGroups].groupKey] = keptGroups;
+        ++keptGroups;
+    }
+    groups.resize(keptGroups);
+    removedGroups = 0;
+}
+
+void MaterializedView::refreshView() {
+    filteredRows.clear();
+    groups.clear();
+    groupsByKey.clear();
+    removedGroups = 0;
+    if (flagAggregate && groupColumnsIndex.empty()) {  // Aggregates over no records still give a single row
+        groups.push_back(ViewGroup());
+        groups.back().groupValues.resize(aggregateColumns.size());
+        groups.back().aggregates.resize(aggregateColumns.size());
+        groupsByKey[""] = 0;
+    }
+
+    std::list<Record*> matchingRecords = baseTable->selectRecordsWhere(whereParameters);  // Indexes and block summaries serve the first fill
+    for (std::list<Record*>::iterator it = matchingRecords.begin(); it != matchingRecords.end(); ++it) addToView(*it);
+}
+
+int MaterializedView::countRows() const {
+    if (!flagAggregate) return filteredRows.size();
+    return groups.size() - removedGroups;
+}
+
+std::vector<std::vector<std::string>> MaterializedView::viewRows() const {
+    std::vector<std::vector<std::string>> rows(1, headerRow);
+    rows.reserve(countRows() + 1);
+    if (!flagAggregate) {
+        for (std::map<unsigned int, std::vector<std::string>>::const_iterator it = filteredRows.begin(); it != filteredRows.end(); ++it) {
+            rows.push_back(it->second);
+        }
+        return rows;
+    }
+
+    for (unsigned int group = 0; group < groups.size(); ++group) {
+        if (groups[group].recordsCount == 0 && !groupColumnsIndex.empty()) continue;
+        std::vector<std::string> row;
+        for (unsigned int i = 0; i < aggregateColumns.size(); ++i) {
+            if (aggregateColumns[i].aggregateType == AggregateType::UNDEFINED) {
+                row.push_back(groups[group].groupValues[i]);
+                continue;
+            }
+            AggregateState state;  // The running aggregate is formatted as by a selection
+            const GroupAggregate& aggregate = groups[group].aggregates[i];
+            state.count = groups[group].recordsCount;
+            state.sum = aggregate.sum;
+            state.valueType = aggregateTypes[i];
+            if (!aggregate.intCounts.empty()) {
+                state.minInt = aggregate.intCounts.begin()->first;
+                state.maxInt = aggregate.intCounts.rbegin()->first;
+            }
+            if (!aggregate.stringCounts.empty()) {
+                state.minString = aggregate.stringCounts.begin()->first;
+                state.maxString = aggregate.stringCounts.rbegin()->first;
+            }
+            row.push_back(state.result(aggregateColumns[i].aggregateType));
+        }
+        rows.push_back(row);
+    }
+    return rows;
+}
+
+void MaterializedView::recordAdded(Table*, Record* addedRecord) {
+    if (isInView(addedRecord)) addToView(addedRecord);
+}
+
+void MaterializedView::recordRemoved(Table*, Record* removedRecord) {
+    if (isInView(removedRecord)) removeFromView(removedRecord);
+}
+
+void MaterializedView::recordsRenumbered(Table*) {
+    refreshView();
+}
+
+void MaterializedView::tableDeleted(Table* observedTable) {
+    if (baseTable == observedTable) baseTable = nullptr;
+}
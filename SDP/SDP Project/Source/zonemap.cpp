@@ -0,0 +1,55 @@
+#include "../Headers/zonemap.hpp"
+
+void BlockSummary::add(DataField* value) {
+    if (value->getType() == FieldType::STRING) {  // Only a STRING can be empty, INT and DATE fields always hold a value
+        std::string stringValue = value->getValueString();
+        if (stringValue.empty() || stringValue == "\"\"") ++nullCount;
+        if (!hasValues || stringValue < minString) minString = stringValue;
+        if (!hasValues || stringValue > maxString) maxString = stringValue;
+    } else {
+        int intValue = value->getValueInt();
+        if (!hasValues || intValue < minInt) minInt = intValue;
+        if (!hasValues || intValue > maxInt) maxInt = intValue;
+    }
+    hasValues = true;
+}
+
+bool BlockSummary::maySatisfy(OperatorType operatorCompare, int key) const {
+    if (!hasValues) return false;
+    switch (operatorCompare) {
+        case OperatorType::EQ:
+            return minInt <= key && key <= maxInt;
+        case OperatorType::NE:
+            return !(minInt == key && maxInt == key);
+        case OperatorType::GT:
+            return maxInt > key;
+        case OperatorType::GE:
+            return maxInt >= key;
+        case OperatorType::LT:
+            return minInt < key;
+        case OperatorType::LE:
+            return minInt <= key;
+        default:
+            return true;
+    }
+}
+
+bool BlockSummary::maySatisfy(OperatorType operatorCompare, const std::string& key) const {
+    if (!hasValues) return false;
+    switch (operatorCompare) {
+        case OperatorType::EQ:
+            return minString <= key && key <= maxString;
+        case OperatorType::NE:
+            return !(minString == key && maxString == key);
+        case OperatorType::GT:
+            return maxString > key;
+        case OperatorType::GE:
+            return maxString >= key;
+        case OperatorType::LT:
+            return minString < key;
+        case OperatorType::LE:
+            return minString <= key;
+        default:
+            return true;
+    }
+}